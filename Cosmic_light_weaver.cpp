@@ -5,20 +5,32 @@
 #include <stdio.h>
 #include <time.h>
 #include <math.h>
+#include "game_world.h"
+#include "map_pool.h"
+#include "particles.h"
+#include "job_system.h"
+#include "replay.h"
+#include "run_history.h"
+#include "frame_clock.h"
+#include "frame_profiler.h"
+#include "render_batch.h"
+#include "fast_trig.h"
+#include "asteroid_field.h"
 
 // Constants
-#define GRID_WIDTH 15
-#define GRID_HEIGHT 15
-#define CELL_SIZE 40.0f
-#define MAX_LIGHT_DURATION 100
-#define LIGHT_DECAY_RATE 0.5f
-#define MAX_TRAIL_LENGTH 1000
+#define DEFAULT_CELL_SIZE 40.0f
+#define MAX_WINDOW_SIZE 800
 #define M_PI 3.142
-#define MAX_COINS 10
-#define MAX_PATH_LENGTH 100
 #define MAX_STARS 200
 #define MAX_NEBULAS 8
 #define MAX_PARTICLES 120
+#define DEFAULT_RENDER_RATE 60  // Frames per second; 0 draws as often as GLUT lets us
+#define REPLAY_PATH "last_game.clwr"
+#define RUN_LOG_PATH "cosmiclightweaver.runs"
+#define RUN_INDEX_PATH "cosmiclightweaver.idx"
+#define LEGACY_SAVE_PATH "cosmiclightweaver.dat"   // Best scores only, from before the run log
+#define PROFILE_CSV_PATH "frame_profile.csv"
+#define PROFILER_OVERLAY_REFRESH 15 // Frames between percentile updates on the overlay
 
 #ifndef GLUT_BITMAP_HELVETICA_10
 #define GLUT_BITMAP_HELVETICA_10 (void*)4
@@ -33,17 +45,13 @@
 #define GLUT_BITMAP_HELVETICA_18 (void*)7
 #endif
 
-// Utility macro
-#define min(a,b) ((a) < (b) ? (a) : (b))
-
-// Direction vectors
-const int dx[4] = { 0, 1, 0, -1 }, dy[4] = { -1, 0, 1, 0 };
-const int dx_path[8] = { 0, 1, 0, -1, 1, 1, -1, -1 }, dy_path[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
-
 // Enums
-typedef enum { GAME_MENU, GAME_PLAYING, GAME_WIN, GAME_LOSE } GameState;
-typedef enum { DIFFICULTY_EASY, DIFFICULTY_MEDIUM, DIFFICULTY_HARD } DifficultyLevel;
 typedef enum { THEME_DARK, THEME_LIGHT } ThemeMode;
+// Profiled passes, in overlay order
+typedef enum {
+    PASS_TICK, PASS_BACKGROUND, PASS_STARS, PASS_PARTICLES, PASS_SPACE, PASS_TRAIL, PASS_COINS, PASS_EXIT,
+    PASS_PLAYER, PASS_HUD, PASS_GAME_STATE, PASS_MENU, PASS_PROFILER, PASS_SWAP, PASS_COUNT
+} RenderPass;
 typedef enum { MENU_EASY, MENU_MEDIUM, MENU_HARD, MENU_THEME, MENU_START, MENU_EXIT, MENU_COUNT } MenuOption;
 
 // Structures
@@ -52,36 +60,52 @@ typedef struct {
     float bgR, bgG, bgB; float gridR, gridG, gridB; float textR, textG, textB;
     float uiR, uiG, uiB; float accentR, accentG, accentB;
 } ThemeColors;
-typedef struct { int x, y; } Point;
-typedef struct { Point pos; int parent; float g, h, f; } Node;
-typedef struct { float x, y; float light; int coinsCollected; } Player;
-typedef struct { float x, y; float intensity; } TrailPoint;
-typedef struct { float x, y; bool active; } Coin;
 typedef struct { float x, y; float brightness; float size; } Star;
 typedef struct { float x, y; float radius; float r, g, b, a; float pulse_speed; } Nebula;
-typedef struct {
-    float x, y; float vx, vy; float size; float alpha; float color[3];
-    float lifespan; float age;
-} Particle;
 
 // Global variables
-int windowWidth = GRID_WIDTH * CELL_SIZE, windowHeight = GRID_HEIGHT * CELL_SIZE, spaceMap[GRID_HEIGHT][GRID_WIDTH];
-int gameTime = 0, timeLimit = 180, bestScores[3] = { -1, -1, -1 }, totalCoins = 0, trailLength = 0;
-float exitX, exitY, lightDecayRate;
-bool pathExists = false;
-
-GameState currentState = GAME_MENU;
+int gridWidth = DEFAULT_GRID_WIDTH, gridHeight = DEFAULT_GRID_HEIGHT;
+float cellSize = DEFAULT_CELL_SIZE;
+int windowWidth, windowHeight;
+int bestScores[3] = { -1, -1, -1 };
+
+GameWorld world;
+MapPool mapPool;
+JobSystem jobs;
+Replay replay;      // Game in progress, saved to REPLAY_PATH when it ends
+RunHistory runHistory;
+bool runHistoryOpened;
+int shortestMoves = -1;    // Fewest moves that win the current map
+FixedTimestep simClock;     // One world tick per step, at SIM_TICKS_PER_SECOND
+int renderRate = DEFAULT_RENDER_RATE;
+int64_t startedNs, nextFrameNs;
+long long framesDrawn;
+float lightBeforeTick;      // Player light when the last tick began, for drawing between ticks
+FrameProfiler profiler;
+bool profilerOverlay;       // F3; F4 records PROFILE_CSV_PATH
+ProfileSummary profileSummary;
+const char* passNames[PASS_COUNT] = { "tick", "background", "stars", "particles", "space", "trail", "coins", "exit",
+    "player", "hud", "game_state", "menu", "profiler", "swap" };
+uint64_t masterSeed;
+RngStream visualRng, renderRng; // Decorations only; maps come from the world's own stream
 DifficultyLevel currentDifficulty = DIFFICULTY_MEDIUM;
 ThemeMode currentTheme = THEME_DARK;
 MenuOption selectedOption = MENU_START;
 
-Player player = { 1.5f, 1.5f, MAX_LIGHT_DURATION, 0 };
 ToggleSwitch themeSwitch = { 0, 0, 60.0f, 30.0f, false };
-TrailPoint trail[MAX_TRAIL_LENGTH];
-Coin coins[MAX_COINS];
 Star stars[MAX_STARS];
 Nebula nebulas[MAX_NEBULAS];
-Particle particles[MAX_PARTICLES];
+ParticleSystem particles;
+RenderBatch batch;
+AsteroidField asteroidField;
+
+// glDrawArrays, counted for the profiler; every draw in this file goes through it
+static void drawCounted(GLenum mode, GLint first, GLsizei count) {
+    profiler.draws++;
+    profiler.vertices += count;
+    glDrawArrays(mode, first, count);
+}
+
 
 // Theme colors
 ThemeColors darkTheme = {
@@ -101,25 +125,8 @@ ThemeColors darkTheme = {
 // Function prototypes
 void init(void); void display(void); void reshape(int w, int h);
 void keyboard(unsigned char key, int x, int y); void specialKeys(int key, int x, int y);
-void update(int value); void updateTimer(int value); void renderGame(void);
-void renderMenu(void); void addTrailPoint(float x, float y); bool isValidMove(float x, float y);
-void checkCoinCollision(void); void checkWinCondition(void);
-void generateEnvironment(bool guaranteePath); bool verifyAllPathsExist(void);
-void startNewGame(void); void updateDifficultySettings(void);
-void saveLoadBestScore(bool save); float heuristic(int x1, int y1, int x2, int y2);
-bool pathfindAStar(int startX, int startY, int goalX, int goalY);
-void generateRandomMap(void); void findValidExit(void); void placeCoins(void);
-void createGuaranteedPath(void);
-
-// Helper functions
-float heuristic(int x1, int y1, int x2, int y2) {
-    return (float)(abs(x1 - x2) + abs(y1 - y2));
-}
-
-int compareNodes(const void* a, const void* b) {
-    Node* nodeA = (Node*)a, * nodeB = (Node*)b;
-    return nodeA->f < nodeB->f ? -1 : (nodeA->f > nodeB->f ? 1 : 0);
-}
+void frame(int value); void renderGame(void); void renderMenu(void);
+void handleGameEvents(int events); void loadBestScores(void); void recordRun(void);
 
 void updateThemeColors(void) {
     currentColors = currentTheme == THEME_DARK ? darkTheme : lightTheme;
@@ -130,52 +137,68 @@ void updateThemeColors(void) {
 void initGameObjects(void) {
     // Initialize stars
     for (int i = 0; i < MAX_STARS; i++) {
-        stars[i].x = (float)(rand() % windowWidth);
-        stars[i].y = (float)(rand() % windowHeight);
-        stars[i].brightness = 0.3f + ((float)rand() / RAND_MAX) * 0.7f;
-        stars[i].size = 1.0f + ((float)rand() / RAND_MAX) * 2.0f;
+        stars[i].x = (float)(rngRange(&visualRng, windowWidth));
+        stars[i].y = (float)(rngRange(&visualRng, windowHeight));
+        stars[i].brightness = 0.3f + rngFloat(&visualRng) * 0.7f;
+        stars[i].size = 1.0f + rngFloat(&visualRng) * 2.0f;
     }
     // Initialize nebulas
     for (int i = 0; i < MAX_NEBULAS; i++) {
-        nebulas[i].x = (float)(rand() % windowWidth);
-        nebulas[i].y = (float)(rand() % windowHeight);
-        nebulas[i].radius = 100.0f + (rand() % 200);
+        nebulas[i].x = (float)(rngRange(&visualRng, windowWidth));
+        nebulas[i].y = (float)(rngRange(&visualRng, windowHeight));
+        nebulas[i].radius = 100.0f + (rngRange(&visualRng, 200));
         // Color palette
-        int colorType = rand() % 4;
+        int colorType = rngRange(&visualRng, 4);
         switch (colorType) {
         case 0: // Purple
-            nebulas[i].r = 0.3f + ((float)rand() / RAND_MAX) * 0.2f;
-            nebulas[i].g = 0.1f + ((float)rand() / RAND_MAX) * 0.1f;
-            nebulas[i].b = 0.4f + ((float)rand() / RAND_MAX) * 0.3f; break;
+            nebulas[i].r = 0.3f + rngFloat(&visualRng) * 0.2f;
+            nebulas[i].g = 0.1f + rngFloat(&visualRng) * 0.1f;
+            nebulas[i].b = 0.4f + rngFloat(&visualRng) * 0.3f; break;
         case 1: // Blue
-            nebulas[i].r = 0.1f + ((float)rand() / RAND_MAX) * 0.1f;
-            nebulas[i].g = 0.2f + ((float)rand() / RAND_MAX) * 0.2f;
-            nebulas[i].b = 0.5f + ((float)rand() / RAND_MAX) * 0.3f; break;
+            nebulas[i].r = 0.1f + rngFloat(&visualRng) * 0.1f;
+            nebulas[i].g = 0.2f + rngFloat(&visualRng) * 0.2f;
+            nebulas[i].b = 0.5f + rngFloat(&visualRng) * 0.3f; break;
         case 2: // Teal
-            nebulas[i].r = 0.1f + ((float)rand() / RAND_MAX) * 0.1f;
-            nebulas[i].g = 0.3f + ((float)rand() / RAND_MAX) * 0.2f;
-            nebulas[i].b = 0.4f + ((float)rand() / RAND_MAX) * 0.2f; break;
+            nebulas[i].r = 0.1f + rngFloat(&visualRng) * 0.1f;
+            nebulas[i].g = 0.3f + rngFloat(&visualRng) * 0.2f;
+            nebulas[i].b = 0.4f + rngFloat(&visualRng) * 0.2f; break;
         case 3: // Pink
-            nebulas[i].r = 0.4f + ((float)rand() / RAND_MAX) * 0.2f;
-            nebulas[i].g = 0.1f + ((float)rand() / RAND_MAX) * 0.1f;
-            nebulas[i].b = 0.3f + ((float)rand() / RAND_MAX) * 0.2f; break;
+            nebulas[i].r = 0.4f + rngFloat(&visualRng) * 0.2f;
+            nebulas[i].g = 0.1f + rngFloat(&visualRng) * 0.1f;
+            nebulas[i].b = 0.3f + rngFloat(&visualRng) * 0.2f; break;
         }
-        nebulas[i].a = 0.05f + ((float)rand() / RAND_MAX) * 0.05f;
-        nebulas[i].pulse_speed = 0.5f + ((float)rand() / RAND_MAX) * 1.5f;
+        nebulas[i].a = 0.05f + rngFloat(&visualRng) * 0.05f;
+        nebulas[i].pulse_speed = 0.5f + rngFloat(&visualRng) * 1.5f;
     }
     // Initialize particles(wall)
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        particles[i].x = rand() % windowWidth;
-        particles[i].y = rand() % windowHeight;
-        particles[i].vx = (float)(rand() % 100 - 50) / 200.0f;
-        particles[i].vy = (float)(rand() % 100 - 50) / 200.0f;
-        particles[i].size = 1.0f + (rand() % 30) / 10.0f;
-        particles[i].color[0] = 0.1f + (rand() % 30) / 100.0f;
-        particles[i].color[1] = 0.2f + (rand() % 40) / 100.0f;
-        particles[i].color[2] = 0.5f + (rand() % 50) / 100.0f;
-        particles[i].alpha = 0.1f + (rand() % 40) / 100.0f;
-        particles[i].lifespan = 50.0f + rand() % 100;
-        particles[i].age = rand() % (int)particles[i].lifespan;
+    particleSystemInit(&particles, MAX_PARTICLES, (float)windowWidth, (float)windowHeight, rngNext(&visualRng));
+}
+
+// Runs on exit(); stops the map producer before globals are torn down
+void shutdownGame(void) {
+    MapPoolStats stats = mapPoolGetStats(&mapPool);
+    mapPoolStop(&mapPool);
+    printf("Map pool: hits=%d misses=%d generated=%d rejected=%d refill=%.3fs stalled=%.3fs\n",
+        stats.hits, stats.misses, stats.generated, stats.rejected, stats.refillSeconds, stats.missSeconds);
+    double seconds = (clockNowNs() - startedNs) * 1e-9;
+    printf("Frames: drawn=%lld fps=%.1f ticks=%lld late_frames=%lld\n", framesDrawn, framesDrawn / seconds,
+        simClock.ticks, simClock.lateFrames);
+    JobTiming timings[JOB_MAX_TIMINGS];
+    int timingCount = jobSystemTimings(&jobs, timings, JOB_MAX_TIMINGS);
+    for (int i = 0; i < timingCount; i++)
+        printf("Jobs: %s calls=%d wall=%.3fms busy=%.3fms speedup=%.2fx\n", timings[i].name, timings[i].calls,
+            timings[i].wallMs / timings[i].calls, timings[i].busyMs / timings[i].calls, timings[i].busyMs / timings[i].wallMs);
+    jobSystemStop(&jobs);
+    if (profiler.csv) printf("Profiler: wrote %lld frames to %s\n", profiler.csvRows, PROFILE_CSV_PATH);
+    frameProfilerFree(&profiler);
+    batchFree(&batch);
+    asteroidFieldFree(&asteroidField);
+    if (runHistoryOpened) {
+        runHistoryClose(&runHistory);
+        RunHistoryStats history = runHistory.stats;
+        printf("Run history: runs=%d commits=%d commit=%.3fms index_writes=%d skipped=%d truncated=%dB\n", history.runs,
+            history.commits, history.commits ? history.commitSeconds * 1000.0 / history.commits : 0.0, history.indexWrites,
+            history.skipped, history.truncatedBytes);
     }
 }
 
@@ -183,612 +206,201 @@ void init(void) {
     updateThemeColors();
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    generateEnvironment(false);
+    rngSeed(&visualRng, rngDeriveSeed(masterSeed, RNG_STREAM_VISUALS));
+    rngSeed(&renderRng, rngDeriveSeed(masterSeed, RNG_STREAM_RENDER));
+    gameWorldInit(&world, currentDifficulty, gridWidth, gridHeight, masterSeed);
+    mapPoolStart(&mapPool, world.map.grid.width, world.map.grid.height, masterSeed);
+    jobSystemStart(&jobs, 0);
+    replayInit(&replay);
+    frameProfilerInit(&profiler, passNames, PASS_COUNT);
+    batchInit(&batch);
+    asteroidFieldInit(&asteroidField);
+    atexit(shutdownGame);
     initGameObjects();
-    player.x = 1.5f;
-    player.y = 1.5f;
-    player.light = MAX_LIGHT_DURATION;
-    player.coinsCollected = 0;
-    addTrailPoint(player.x, player.y);
-    updateDifficultySettings();
-    saveLoadBestScore(false); // Load scores
+    loadBestScores();
 }
 
-// Path finding and map generation
-bool pathfindAStar(int startX, int startY, int goalX, int goalY) {
-    // Validate inputs
-    if (startX < 0 || startX >= GRID_WIDTH || startY < 0 || startY >= GRID_HEIGHT ||
-        goalX < 0 || goalX >= GRID_WIDTH || goalY < 0 || goalY >= GRID_HEIGHT ||
-        spaceMap[startY][startX] == 1 || spaceMap[goalY][goalX] == 1)
-        return false;
-
-    // A* algorithm
-    Node openSet[GRID_WIDTH * GRID_HEIGHT];
-    bool closedSet[GRID_HEIGHT][GRID_WIDTH] = { {false} };
-    int openSetSize = 0;
-
-    // Add start node
-    Node startNode = { {startX, startY}, -1, 0.0f, heuristic(startX, startY, goalX, goalY) };
-    startNode.f = startNode.g + startNode.h;
-    openSet[openSetSize++] = startNode;
-
-    while (openSetSize > 0) {
-        // Find node with lowest f score
-        int currentIndex = 0;
-        for (int i = 1; i < openSetSize; i++) {
-            if (openSet[i].f < openSet[currentIndex].f) {
-                currentIndex = i;
-            }
-        }
-
-        Node current = openSet[currentIndex];
-
-        // Remove from open set
-        openSet[currentIndex] = openSet[--openSetSize];
-
-        // Check if reached goal
-        if (current.pos.x == goalX && current.pos.y == goalY) return true;
-
-        closedSet[current.pos.y][current.pos.x] = true;
-
-        // Check neighbors - all 8 directions for more natural paths
-        for (int i = 0; i < 8; i++) {
-            int nx = current.pos.x + dx_path[i], ny = current.pos.y + dy_path[i];
-
-            if (nx < 0 || nx >= GRID_WIDTH || ny < 0 || ny >= GRID_HEIGHT ||
-                spaceMap[ny][nx] == 1 || closedSet[ny][nx]) continue;
-
-            // For diagonals, check if both adjacent cells are not blocked
-            if (i >= 4) { // Diagonal directions
-                int ax1 = current.pos.x + dx_path[i - 4]; // Adjacent cells in cardinal directions
-                int ay1 = current.pos.y;
-                int ax2 = current.pos.x;
-                int ay2 = current.pos.y + dy_path[i - 4];
-                if (spaceMap[ay1][ax1] == 1 || spaceMap[ay2][ax2] == 1) continue;
-            }
-
-            float g = current.g + (i < 4 ? 1.0f : 1.414f); // Diagonal moves cost more
-
-            // Check if neighbor is in open set
-            bool inOpenSet = false;
-            int openIndex = -1;
-            for (int j = 0; j < openSetSize; j++) {
-                if (openSet[j].pos.x == nx && openSet[j].pos.y == ny) {
-                    inOpenSet = true; openIndex = j; break;
-                }
-            }
-
-            if (inOpenSet) {
-                // Update if better path
-                if (g < openSet[openIndex].g) {
-                    openSet[openIndex].g = g;
-                    openSet[openIndex].f = g + openSet[openIndex].h;
-                    openSet[openIndex].parent = current.pos.y * GRID_WIDTH + current.pos.x;
-                }
-            }
-            else if (openSetSize < GRID_WIDTH * GRID_HEIGHT) {
-                // Add new node
-                Node neighbor = { {nx, ny}, current.pos.y * GRID_WIDTH + current.pos.x, g, heuristic(nx, ny, goalX, goalY) };
-                neighbor.f = neighbor.g + neighbor.h;
-                openSet[openSetSize++] = neighbor;
-            }
-        }
-    }
-    return false;
-}
-
-void generateRandomMap(void) {
-    // Initialize all cells as safe
-    memset(spaceMap, 0, sizeof(spaceMap));
-
-    // Create asteroid fields based on difficulty
-    int numAsteroidFields;
-    switch (currentDifficulty) {
-    case DIFFICULTY_EASY: numAsteroidFields = GRID_WIDTH * GRID_HEIGHT / 8; break;
-    case DIFFICULTY_MEDIUM: numAsteroidFields = GRID_WIDTH * GRID_HEIGHT / 6; break;
-    case DIFFICULTY_HARD: numAsteroidFields = GRID_WIDTH * GRID_HEIGHT / 4; break;
-    default: numAsteroidFields = GRID_WIDTH * GRID_HEIGHT / 6;
-    }
-
-    // Create large asteroid clusters
-    for (int i = 0; i < numAsteroidFields / 4; i++) {
-        int centerX = 3 + rand() % (GRID_WIDTH - 6);
-        int centerY = 3 + rand() % (GRID_HEIGHT - 6);
-        int radius = 1 + rand() % 2;
-
-        for (int y = centerY - radius; y <= centerY + radius; y++) {
-            for (int x = centerX - radius; x <= centerX + radius; x++) {
-                if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
-                    // Don't block starting area or exit area
-                    if (!(x <= 3 && y <= 3) && !(x >= GRID_WIDTH - 4 && y >= GRID_HEIGHT - 4)) {
-                        if (rand() % 100 < 60) spaceMap[y][x] = 1;
-                    }
-                }
-            }
-        }
-    }
-
-    // Add some scattered smaller asteroids
-    for (int i = 0; i < numAsteroidFields * 3 / 4; i++) {
-        int x = rand() % GRID_WIDTH, y = rand() % GRID_HEIGHT;
-        // Don't block starting area or exit area
-        if (!(x <= 3 && y <= 3) && !(x >= GRID_WIDTH - 4 && y >= GRID_HEIGHT - 4)) {
-            spaceMap[y][x] = 1;
-        }
-    }
-
-    // Ensure starting area is safe
-    for (int y = 0; y <= 3; y++) {
-        for (int x = 0; x <= 3; x++) {
-            spaceMap[y][x] = 0;
-        }
-    }
-}
-
-void placeCoins(void) {
-    // Adjust coin count based on difficulty
-    switch (currentDifficulty) {
-    case DIFFICULTY_EASY: totalCoins = MAX_COINS - 3; break;
-    case DIFFICULTY_MEDIUM: totalCoins = MAX_COINS - 1; break;
-    case DIFFICULTY_HARD: totalCoins = MAX_COINS; break;
-    }
-
-    // Reset coins
-    for (int i = 0; i < MAX_COINS; i++) coins[i].active = false;
-
-    // Try random placement
-    int coinsPlaced = 0, attempts = 0;
-    const int maxAttempts = 200;
-
-    while (coinsPlaced < totalCoins && attempts < maxAttempts) {
-        int x = rand() % GRID_WIDTH, y = rand() % GRID_HEIGHT;
-
-        if (spaceMap[y][x] == 0) {
-            float distFromStart = sqrt(pow(x - 1, 2) + pow(y - 1, 2));
-            float distFromExit = sqrt(pow(x - (int)exitX, 2) + pow(y - (int)exitY, 2));
-
-            if (distFromStart > 2 && distFromExit > 2) {
-                if (pathfindAStar(1, 1, x, y) && pathfindAStar(x, y, (int)exitX, (int)exitY)) {
-                    // Check distance from other coins
-                    bool tooClose = false;
-                    for (int j = 0; j < coinsPlaced; j++) {
-                        if (coins[j].active) {
-                            float dist = sqrt(pow(x - (int)coins[j].x, 2) + pow(y - (int)coins[j].y, 2));
-                            if (dist < 3) { tooClose = true; break; }
-                        }
-                    }
-
-                    if (!tooClose) {
-                        coins[coinsPlaced].x = x + 0.5f;
-                        coins[coinsPlaced].y = y + 0.5f;
-                        coins[coinsPlaced].active = true;
-                        coinsPlaced++;
-                    }
-                }
-            }
-        }
-        attempts++;
-    }
-
-    // If not all coins placed, try along valid paths
-    if (coinsPlaced < totalCoins) {
-        bool visited[GRID_HEIGHT][GRID_WIDTH] = { {false} };
-        int queue[GRID_WIDTH * GRID_HEIGHT][3], path[GRID_WIDTH * GRID_HEIGHT][2], pathLength = 0, queueFront = 0, queueBack = 0;
-
-        // BFS to find path
-        queue[queueBack][0] = 1; queue[queueBack][1] = 1; queue[queueBack][2] = -1; queueBack++;
-        visited[1][1] = true;
-
-        bool foundPath = false;
-        while (queueFront < queueBack && !foundPath) {
-            int x = queue[queueFront][0], y = queue[queueFront][1], parent = queue[queueFront][2];
-            queueFront++;
-
-            if (x == (int)exitX && y == (int)exitY) {
-                // Reconstruct path
-                int current = queueFront - 1;
-                while (current != -1) {
-                    path[pathLength][0] = queue[current][0];
-                    path[pathLength][1] = queue[current][1];
-                    pathLength++; current = queue[current][2];
-                }
-                foundPath = true; break;
-            }
-
-            // Try all directions
-            for (int i = 0; i < 4; i++) {
-                int nx = x + dx[i], ny = y + dy[i];
-                if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT &&
-                    spaceMap[ny][nx] == 0 && !visited[ny][nx]) {
-                    queue[queueBack][0] = nx; queue[queueBack][1] = ny;
-                    queue[queueBack][2] = queueFront - 1; queueBack++; visited[ny][nx] = true;
-                }
-            }
-        }
-
-        // Use path to place remaining coins
-        if (foundPath && pathLength > 0) {
-            // Reverse path (start to exit)
-            for (int i = 0; i < pathLength / 2; i++) {
-                int tempX = path[i][0], tempY = path[i][1];
-                path[i][0] = path[pathLength - i - 1][0]; path[i][1] = path[pathLength - i - 1][1];
-                path[pathLength - i - 1][0] = tempX; path[pathLength - i - 1][1] = tempY;
-            }
-
-            // Place coins evenly
-            int coinsLeft = totalCoins - coinsPlaced;
-            if (coinsLeft > 0 && pathLength > 4) {
-                int interval = pathLength / (coinsLeft + 1);
-                if (interval < 1) interval = 1;
-
-                for (int i = 1; i <= coinsLeft && coinsPlaced < totalCoins; i++) {
-                    int pathIndex = i * interval;
-                    if (pathIndex < pathLength) {
-                        int x = path[pathIndex][0], y = path[pathIndex][1];
-
-                        // Check if spot is available
-                        bool isFree = true;
-                        for (int j = 0; j < coinsPlaced; j++) {
-                            if (coins[j].active && (int)coins[j].x == x && (int)coins[j].y == y) {
-                                isFree = false; break;
-                            }
-                        }
-
-                        if (isFree) {
-                            coins[coinsPlaced].x = x + 0.5f;
-                            coins[coinsPlaced].y = y + 0.5f;
-                            coins[coinsPlaced].active = true;
-                            coinsPlaced++;
-                        }
-                    }
-                }
-            }
-        }
+// Game state functions
+void handleGameEvents(int events) {
+    if (events & (GAME_EVENT_WON | GAME_EVENT_LOST)) {
+        replayFinish(&replay, &world);
+        if (replaySave(&replay, REPLAY_PATH)) printf("Replay saved to %s\n", REPLAY_PATH);
+        recordRun();
     }
-    // Update actual count
-    totalCoins = coinsPlaced;
+    if (events != GAME_EVENT_NONE) glutPostRedisplay();
 }
 
-void findValidExit(void) {
-    int attempts = 0;
-    const int maxAttempts = 100;
-
-    // Set minimum distance based on difficulty
-    float minDistance;
-    switch (currentDifficulty) {
-    case DIFFICULTY_EASY: minDistance = GRID_WIDTH / 3; break;
-    case DIFFICULTY_MEDIUM: minDistance = GRID_WIDTH / 2.5; break;
-    case DIFFICULTY_HARD: minDistance = GRID_WIDTH / 2; break;
-    default: minDistance = GRID_WIDTH / 2.5;
-    }
-
-    // Try to place exit
-    while (attempts < maxAttempts) {
-        int x = GRID_WIDTH / 2 + rand() % (GRID_WIDTH / 2 - 2);
-        int y = GRID_HEIGHT / 2 + rand() % (GRID_HEIGHT / 2 - 2);
-        float distFromStart = sqrt(pow(x - 1, 2) + pow(y - 1, 2));
-
-        if (spaceMap[y][x] == 0 && distFromStart > minDistance) {
-            exitX = x + 0.5f; exitY = y + 0.5f; return;
-        }
-        attempts++;
-    }
-
-    // Fallback - try on the far side from start
-    exitX = GRID_WIDTH - 3 + 0.5f; exitY = GRID_HEIGHT - 3 + 0.5f;
-
-    // Make sure exit area is safe
-    int exitGridX = (int)exitX, exitGridY = (int)exitY;
-    for (int y = exitGridY - 1; y <= exitGridY + 1; y++) {
-        for (int x = exitGridX - 1; x <= exitGridX + 1; x++) {
-            if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
-                spaceMap[y][x] = 0;
-            }
-        }
-    }
+// Light as drawn: the last tick's drain spread over the time until the next
+float shownLight(void) {
+    return lightBeforeTick + (world.player.light - lightBeforeTick) * fixedStepBlend(&simClock);
 }
 
-void createGuaranteedPath(void) {
-    // Clear the map
-    memset(spaceMap, 0, sizeof(spaceMap));
-
-    // Set exit position
-    exitX = GRID_WIDTH - 3 + 0.5f; exitY = GRID_HEIGHT - 3 + 0.5f;
-
-    // Create a path from start to exit
-    int currentX = 1, currentY = 1, exitGridX = (int)exitX, exitGridY = (int)exitY;
-    int pathPoints[MAX_COINS][2], pathLength = 0;
-
-    // Add start point
-    pathPoints[pathLength][0] = currentX; pathPoints[pathLength][1] = currentY; pathLength++;
-
-    // Create path segments
-    while ((currentX < exitGridX || currentY < exitGridY) && pathLength < MAX_PATH_LENGTH - 1) {
-        bool moveHorizontalFirst = (rand() % 2 == 0);
-
-        if (moveHorizontalFirst) {
-            if (currentX < exitGridX) currentX += 1 + rand() % 2;
-            if (currentY < exitGridY) currentY += 1 + rand() % 2;
-        }
-        else {
-            if (currentY < exitGridY) currentY += 1 + rand() % 2;
-            if (currentX < exitGridX) currentX += 1 + rand() % 2;
-        }
-
-        // Keep in bounds
-        currentX = min(currentX, GRID_WIDTH - 2);
-        currentY = min(currentY, GRID_HEIGHT - 2);
-
-        // Add point to path
-        pathPoints[pathLength][0] = currentX; pathPoints[pathLength][1] = currentY; pathLength++;
-
-        // Add random obstacles near the path
-        if (rand() % 3 == 0) {
-            for (int y = currentY - 3; y <= currentY + 3; y++) {
-                for (int x = currentX - 3; x <= currentX + 3; x++) {
-                    if (x >= 0 && x < GRID_WIDTH && y >= 0 && y < GRID_HEIGHT) {
-                        if (abs(x - currentX) > 1 || abs(y - currentY) > 1) {
-                            if (rand() % 100 < 30) spaceMap[y][x] = 1;
-                        }
-                    }
-                }
-            }
-        }
+// Best times come from the run history; a store that will not open still
+// keeps this session's bests in memory
+void loadBestScores(void) {
+    for (int i = 0; i < 3; i++) bestScores[i] = -1;
+    runHistoryOpened = runHistoryOpen(&runHistory, RUN_LOG_PATH, RUN_INDEX_PATH);
+    if (!runHistoryOpened) {
+        printf("Run history: cannot open %s\n", RUN_LOG_PATH);
+        return;
     }
-
-    // Add exit point
-    pathPoints[pathLength][0] = exitGridX; pathPoints[pathLength][1] = exitGridY; pathLength++;
-
-    // Clear the path for passability
-    for (int i = 0; i < pathLength; i++) {
-        int x = pathPoints[i][0], y = pathPoints[i][1];
-        for (int ny = y - 1; ny <= y + 1; ny++) {
-            for (int nx = x - 1; nx <= x + 1; nx++) {
-                if (nx >= 0 && nx < GRID_WIDTH && ny >= 0 && ny < GRID_HEIGHT) {
-                    spaceMap[ny][nx] = 0;
+    // First run with a run log: carry the old best scores over as runs
+    if (runHistory.stats.runs == 0) {
+        FILE* file = fopen(LEGACY_SAVE_PATH, "rb");
+        if (file) {
+            char header[8];
+            int legacy[3];
+            if (fread(header, sizeof(char), 8, file) == 8 && memcmp(header, "CLWSAV01", 8) == 0 &&
+                fread(legacy, sizeof(int), 3, file) == 3) {
+                for (int i = 0; i < 3; i++) {
+                    if (legacy[i] < 0) continue;
+                    RunRecord run = { 0, 0, 0, legacy[i], 0, (DifficultyLevel)i, GAME_WIN, 0, 0 };
+                    runHistoryAppend(&runHistory, &run);
                 }
             }
+            fclose(file);
         }
     }
-
-    // Place coins along the path
-    totalCoins = min(pathLength - 2, MAX_COINS);
-
-    for (int i = 0; i < MAX_COINS; i++) coins[i].active = false;
-
-    for (int i = 0; i < totalCoins; i++) {
-        int pathIndex = 1 + i * (pathLength - 2) / totalCoins;
-        if (pathIndex >= pathLength - 1) pathIndex = pathLength - 2;
-
-        coins[i].x = pathPoints[pathIndex][0] + 0.5f;
-        coins[i].y = pathPoints[pathIndex][1] + 0.5f;
-        coins[i].active = true;
-    }
-    pathExists = true;
-}
-
-bool verifyAllPathsExist(void) {
-    // Check if exit is reachable from start
-    if (!pathfindAStar(1, 1, (int)exitX, (int)exitY)) return false;
-
-    // Check if all coins are reachable
-    for (int i = 0; i < totalCoins; i++) {
-        if (coins[i].active) {
-            int coinX = (int)coins[i].x, coinY = (int)coins[i].y;
-            if (!pathfindAStar(1, 1, coinX, coinY) || !pathfindAStar(coinX, coinY, (int)exitX, (int)exitY)) {
-                return false;
-            }
-        }
-    }
-    return true;
-}
-void generateEnvironment(bool guaranteePath) {
-    if (guaranteePath) {
-        createGuaranteedPath();
-        return;
-    }
-
-    int attempts = 0;
-    const int maxAttempts = 5;
-
-    while (attempts < maxAttempts) {
-        generateRandomMap();
-        findValidExit();
-        placeCoins();
-        if (verifyAllPathsExist()) {
-            pathExists = true;
-            return;
-        }
-        attempts++;
-    }
-    // If all attempts failed, create a guaranteed path
-    createGuaranteedPath();
+    for (int i = 0; i < 3; i++) bestScores[i] = runHistoryBest(&runHistory, (DifficultyLevel)i);
 }
 
-// Game state functions
-void updateDifficultySettings(void) {
-    switch (currentDifficulty) {
-    case DIFFICULTY_EASY:
-        timeLimit = 60;
-        lightDecayRate = LIGHT_DECAY_RATE * 2.5f; // Much slower light depletion
-        break;
-    case DIFFICULTY_MEDIUM:
-        timeLimit = 45;
-        lightDecayRate = LIGHT_DECAY_RATE * 3.0f; // Medium light depletion
-        break;
-    case DIFFICULTY_HARD:
-        timeLimit = 30;
-        lightDecayRate = LIGHT_DECAY_RATE * 3.5f; // Faster light depletion
-        break;
-    }
+// Queues the finished game for the writer; nothing here touches the disk
+void recordRun(void) {
+    int d = world.difficulty;
+    if (world.state == GAME_WIN && (bestScores[d] == -1 || world.gameTime < bestScores[d])) bestScores[d] = world.gameTime;
+    if (!runHistoryOpened) return;
+    RunRecord run = { 0, (uint32_t)time(NULL), world.map.seed, world.gameTime, world.tickCount, world.difficulty,
+        world.state, world.player.coinsCollected, world.map.totalCoins };
+    runHistoryAppend(&runHistory, &run);
 }
 
-void startNewGame(void) {
-    gameTime = 0;
-    trailLength = 0;
-    generateEnvironment(false);
-    player.x = 1.5f;
-    player.y = 1.5f;
-    player.light = MAX_LIGHT_DURATION;
-    player.coinsCollected = 0;
-    addTrailPoint(player.x, player.y);
-    currentState = GAME_PLAYING;
-}
+// Rendering functions
 
-void saveLoadBestScore(bool save) {
-    if (save) {
-        if (bestScores[currentDifficulty] == -1 || gameTime < bestScores[currentDifficulty]) {
-            bestScores[currentDifficulty] = gameTime;
-            FILE* file = NULL;
-            fopen_s(&file, "cosmiclightweaver.dat", "wb");
-            if (file) {
-                const char header[] = "CLWSAV01";
-                fwrite(header, sizeof(char), 8, file);
-                fwrite(bestScores, sizeof(int), 3, file);
-                fclose(file);
-            }
+// Draws what the batch holds: one call per bucket, triangles under lines under points.
+// Flush between layers whose order matters.
+void flushBatch(void) {
+    if (batch.vertices == 0) return;
+    static const GLenum modes[] = { GL_TRIANGLES, GL_LINES, GL_POINTS };
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    for (int primitive = BATCH_TRIANGLES; primitive <= BATCH_POINTS; primitive++) {
+        for (int i = 0; i < batch.bucketCount; i++) {
+            const BatchBucket* bucket = &batch.buckets[i];
+            if (bucket->primitive != primitive || bucket->count == 0) continue;
+            if (primitive == BATCH_LINES) glLineWidth(bucket->size);
+            if (primitive == BATCH_POINTS) glPointSize(bucket->size);
+            glVertexPointer(2, GL_FLOAT, sizeof(BatchVertex), &bucket->vertices[0].x);
+            glColorPointer(4, GL_FLOAT, sizeof(BatchVertex), &bucket->vertices[0].r);
+            drawCounted(modes[primitive], 0, bucket->count);
         }
     }
-    else { // Load scores
-        for (int i = 0; i < 3; i++) bestScores[i] = -1;
-        FILE* file = NULL;
-        fopen_s(&file, "cosmiclightweaver.dat", "rb");
-        if (file) {
-            char header[8];
-            if (fread(header, sizeof(char), 8, file) == 8 && memcmp(header, "CLWSAV01", 8) == 0) {
-                fread(bestScores, sizeof(int), 3, file);
-            }
-            fclose(file);
-        }
-    }
-}
-
-// Game mechanics
-void addTrailPoint(float x, float y) {
-    if (trailLength >= MAX_TRAIL_LENGTH) {
-        memmove(&trail[0], &trail[1], (MAX_TRAIL_LENGTH - 1) * sizeof(TrailPoint));
-        trailLength--;
-    }
-    trail[trailLength].x = x; trail[trailLength].y = y; trail[trailLength].intensity = 5.0f;
-    trailLength++;
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glLineWidth(1.0f);
+    glPointSize(1.0f);
+    profiler.shapes += batch.primitives;
+    batchClear(&batch);
 }
 
-bool isValidMove(float x, float y) {
-    if (x < 0 || x >= GRID_WIDTH || y < 0 || y >= GRID_HEIGHT) return false;
-    int gridX = (int)x, gridY = (int)y;
-    return spaceMap[gridY][gridX] != 1;
+// Bitmap text in the batch's current color, over everything batched before it
+void drawText(void* font, float x, float y, const char* text) {
+    flushBatch();
+    glColor4f(batch.r, batch.g, batch.b, batch.a);
+    glRasterPos2f(x, y);
+    for (const char* c = text; *c; c++) glutBitmapCharacter(font, *c);
 }
 
-void checkCoinCollision(void) {
-    for (int i = 0; i < totalCoins; i++) {
-        if (coins[i].active) {
-            float dx = player.x - coins[i].x, dy = player.y - coins[i].y;
-            float distance = sqrt(dx * dx + dy * dy);
-
-            if (distance < 0.7f) {
-                coins[i].active = false;
-                player.coinsCollected++;
-
-                // Energy boost based on difficulty
-                float energyBoost;
-                switch (currentDifficulty) {
-                case DIFFICULTY_EASY: energyBoost = MAX_LIGHT_DURATION * 0.25f; break;
-                case DIFFICULTY_MEDIUM: energyBoost = MAX_LIGHT_DURATION * 0.2f; break;
-                case DIFFICULTY_HARD: energyBoost = MAX_LIGHT_DURATION * 0.15f; break;
-                default: energyBoost = MAX_LIGHT_DURATION * 0.2f;
-                }
-
-                player.light += energyBoost;
-                if (player.light > MAX_LIGHT_DURATION) player.light = MAX_LIGHT_DURATION;
-            }
-        }
-    }
+// 2D overlay in window pixels on top of the world
+void beginOverlay(void) {
+    flushBatch();
+    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
+    gluOrtho2D(0, windowWidth, windowHeight, 0);
+    glMatrixMode(GL_MODELVIEW); glLoadIdentity();
 }
 
-void checkWinCondition(void) {
-    float dx = player.x - exitX, dy = player.y - exitY;
-    float distance = sqrt(dx * dx + dy * dy);
-    if (distance < 0.7f && player.coinsCollected == totalCoins) {
-        currentState = GAME_WIN;
-        saveLoadBestScore(true);
-    }
+void endOverlay(void) {
+    flushBatch();
+    glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
 }
 
-// Rendering functions
 void renderBackgroundEffects(void) {
+    ProfileScope scope(&profiler, PASS_BACKGROUND);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
     float centerX = windowWidth * 0.5f, centerY = windowHeight * 0.5f;
 
     // Background vortex
     for (int arm = 0; arm < 3; arm++) {
         float armOffset = 2.0f * M_PI * arm / 3.0f;
-        glBegin(GL_LINE_STRIP);
+        batchBegin(&batch, BATCH_LINE_STRIP);
         for (float t = 0; t < 15.0f; t += 0.1f) {
             float radius = 10.0f + t * 30.0f;
             float angle = t * 1.5f + time * (1.0f - t / 15.0f) + armOffset;
-            float x = centerX + radius * cos(angle), y = centerY + radius * sin(angle);
+            float x = centerX + radius * fastCos(angle), y = centerY + radius * fastSin(angle);
             float alpha = 0.5f * (1.0f - t / 15.0f);
             // Color transitions
-            float r = 0.2f + 0.3f * sin(t + time), g = 0.3f + 0.3f * sin(t + time + 2.0f);
-            float b = 0.6f + 0.3f * sin(t + time + 4.0f);
-            glColor4f(r, g, b, alpha); glVertex2f(x, y);
+            float r = 0.2f + 0.3f * fastSin(t + time), g = 0.3f + 0.3f * fastSin(t + time + 2.0f);
+            float b = 0.6f + 0.3f * fastSin(t + time + 4.0f);
+            batchColor(&batch, r, g, b, alpha); batchVertex(&batch, x, y);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 
     // Energy grid
-    float gridSpacing = 70.0f, lineAlpha = 0.1f + 0.05f * sin(time * 0.5f);
+    float gridSpacing = 70.0f, lineAlpha = 0.1f + 0.05f * fastSin(time * 0.5f);
     // Horizontal lines
     for (float y = 0; y < windowHeight; y += gridSpacing) {
-        glBegin(GL_LINE_STRIP);
+        batchBegin(&batch, BATCH_LINE_STRIP);
         for (float x = 0; x < windowWidth; x += 5) {
-            float wave = 5.0f * sin(x * 0.02f + time * 1.5f);
-            float alpha = lineAlpha * (0.5f + 0.5f * sin(x * 0.01f + time));
-            glColor4f(0.2f, 0.5f, 0.8f, alpha); glVertex2f(x, y + wave);
+            float wave = 5.0f * fastSin(x * 0.02f + time * 1.5f);
+            float alpha = lineAlpha * (0.5f + 0.5f * fastSin(x * 0.01f + time));
+            batchColor(&batch, 0.2f, 0.5f, 0.8f, alpha); batchVertex(&batch, x, y + wave);
         }
-        glEnd();
+        batchEnd(&batch);
     }
     // Vertical lines
     for (float x = 0; x < windowWidth; x += gridSpacing) {
-        glBegin(GL_LINE_STRIP);
+        batchBegin(&batch, BATCH_LINE_STRIP);
         for (float y = 0; y < windowHeight; y += 5) {
-            float wave = 5.0f * sin(y * 0.02f + time * 1.2f + M_PI / 2);
-            float alpha = lineAlpha * (0.5f + 0.5f * sin(y * 0.01f + time));
-            glColor4f(0.3f, 0.4f, 0.9f, alpha); glVertex2f(x + wave, y);
+            float wave = 5.0f * fastSin(y * 0.02f + time * 1.2f + M_PI / 2);
+            float alpha = lineAlpha * (0.5f + 0.5f * fastSin(y * 0.01f + time));
+            batchColor(&batch, 0.3f, 0.4f, 0.9f, alpha); batchVertex(&batch, x + wave, y);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 }
 
 void renderStarsAndNebulas(void) {
+    ProfileScope scope(&profiler, PASS_STARS);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
     float starAlphaMultiplier = (currentTheme == THEME_DARK) ? 1.0f : 0.6f;
     float nebulaAlphaMultiplier = (currentTheme == THEME_DARK) ? 1.0f : 0.4f;
+    const UnitCircle<8>& circle8 = unitCircle<8>();
+    const UnitCircle<20>& circle20 = unitCircle<20>();
 
     // Stars
     for (int i = 0; i < MAX_STARS; i++) {
         float brightness = stars[i].brightness * starAlphaMultiplier;
-        glColor4f(brightness, brightness, brightness * 1.2f, brightness);
-        glPointSize(stars[i].size * (currentTheme == THEME_DARK ? 1.0f : 0.8f));
-        glBegin(GL_POINTS); glVertex2f(stars[i].x, stars[i].y); glEnd();
+        batchColor(&batch, brightness, brightness, brightness * 1.2f, brightness);
+        batchPointSize(&batch, stars[i].size * (currentTheme == THEME_DARK ? 1.0f : 0.8f));
+        batchBegin(&batch, BATCH_POINTS); batchVertex(&batch, stars[i].x, stars[i].y); batchEnd(&batch);
 
         // Glow for bright stars
         if (stars[i].brightness > 0.8f) {
-            glColor4f(brightness * 0.8f, brightness * 0.8f, brightness, 0.3f * starAlphaMultiplier);
-            glBegin(GL_TRIANGLE_FAN);
-            glVertex2f(stars[i].x, stars[i].y);
+            batchColor(&batch, brightness * 0.8f, brightness * 0.8f, brightness, 0.3f * starAlphaMultiplier);
+            batchBegin(&batch, BATCH_TRIANGLE_FAN);
+            batchVertex(&batch, stars[i].x, stars[i].y);
             for (int j = 0; j <= 8; j++) {
-                float angle = 2.0f * M_PI * j / 8;
-                glVertex2f(stars[i].x + cos(angle) * stars[i].size * 2.0f,
-                    stars[i].y + sin(angle) * stars[i].size * 2.0f);
+                batchVertex(&batch, stars[i].x + circle8.cos[j] * stars[i].size * 2.0f,
+                    stars[i].y + circle8.sin[j] * stars[i].size * 2.0f);
             }
-            glEnd();
+            batchEnd(&batch);
         }
     }
 
-    // Nebulas
+    // Nebulas over the stars, as drawn before batching
+    flushBatch();
     for (int i = 0; i < MAX_NEBULAS; i++) {
-        float pulse = 1.0f + 0.1f * sin(time * nebulas[i].pulse_speed);
+        float pulse = 1.0f + 0.1f * fastSin(time * nebulas[i].pulse_speed);
         float radius = nebulas[i].radius * pulse;
         float alpha = nebulas[i].a * nebulaAlphaMultiplier;
 
@@ -801,230 +413,209 @@ void renderStarsAndNebulas(void) {
             if (currentTheme == THEME_LIGHT) {
                 r = 0.7f + (r * 0.3f); g = 0.7f + (g * 0.3f); b = 0.8f + (b * 0.2f);
             }
-            glColor4f(r, g, b, layerAlpha);
-            glBegin(GL_TRIANGLE_FAN);
-            glVertex2f(nebulas[i].x, nebulas[i].y);
+            batchColor(&batch, r, g, b, layerAlpha);
+            batchBegin(&batch, BATCH_TRIANGLE_FAN);
+            batchVertex(&batch, nebulas[i].x, nebulas[i].y);
             for (int k = 0; k <= 20; k++) {
                 float angle = 2.0f * M_PI * k / 20;
-                float distortion = 1.0f + 0.2f * sin(angle * 5 + time);
-                glVertex2f(nebulas[i].x + cos(angle) * size * distortion,
-                    nebulas[i].y + sin(angle) * size * distortion);
+                float distortion = 1.0f + 0.2f * fastSin(angle * 5 + time);
+                batchVertex(&batch, nebulas[i].x + circle20.cos[k] * size * distortion,
+                    nebulas[i].y + circle20.sin[k] * size * distortion);
             }
-            glEnd();
+            batchEnd(&batch);
         }
     }
 }
 
 void renderParticles(void) {
-    float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        // Calculate fade
-        float fade = 1.0f;
-        if (particles[i].age < 10) fade = particles[i].age / 10.0f;
-        else if (particles[i].age > particles[i].lifespan - 10) fade = (particles[i].lifespan - particles[i].age) / 10.0f;
-        // Pulse size
-        float sizeMultiplier = 0.8f + 0.2f * sin(time * 2.0f + i * 0.1f);
-        // Draw glow
-        glPointSize(particles[i].size * sizeMultiplier * 3.0f);
-        glColor4f(particles[i].color[0], particles[i].color[1],
-            particles[i].color[2], particles[i].alpha * 0.2f * fade);
-        glBegin(GL_POINTS); glVertex2f(particles[i].x, particles[i].y); glEnd();
-        // Draw core
-        glPointSize(particles[i].size * sizeMultiplier);
-        glColor4f(particles[i].color[0] + 0.2f, particles[i].color[1] + 0.2f,
-            particles[i].color[2] + 0.2f, particles[i].alpha * fade);
-        glBegin(GL_POINTS); glVertex2f(particles[i].x, particles[i].y); glEnd();
+    ProfileScope scope(&profiler, PASS_PARTICLES);
+    particleSystemEmit(&particles, glutGet(GLUT_ELAPSED_TIME) * 0.001f, fixedStepBlend(&simClock), &jobs);
+    flushBatch();
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(2, GL_FLOAT, sizeof(ParticleVertex), &particles.vertices[0].x);
+    glColorPointer(4, GL_FLOAT, sizeof(ParticleVertex), &particles.vertices[0].r);
+    // One draw per size bin for the glows, then one per bin for the cores
+    for (int pass = 0; pass < 2; pass++) {
+        for (int b = 0; b < PARTICLE_SIZE_BINS; b++) {
+            int first = particles.binStart[b], count = particles.binStart[b + 1] - first;
+            if (count == 0) continue;
+            glPointSize(particles.binPoint[b] * (pass == 0 ? 3.0f : 1.0f));
+            drawCounted(GL_POINTS, first + pass * particles.count, count);
+        }
     }
-    glPointSize(1.0f);
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    batchPointSize(&batch, 1.0f);
 }
 
 void renderSpace(void) {
+    ProfileScope scope(&profiler, PASS_SPACE);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            if (spaceMap[y][x] == 1) {  // Asteroid field
-                float offsetX = x * CELL_SIZE + CELL_SIZE / 2;
-                float offsetY = y * CELL_SIZE + CELL_SIZE / 2;
-                // Draw multiple asteroids per cell
-                for (int i = 0; i < 3; i++) {
-                    float seedX = (float)(x * 10 + y * 7 + i * 3);
-                    float seedY = (float)(y * 10 + x * 3 + i * 7);
-                    float asteroidX = offsetX + sin(seedX) * CELL_SIZE * 0.3f;
-                    float asteroidY = offsetY + cos(seedY) * CELL_SIZE * 0.3f;
-                    float size = (0.2f + 0.1f * sin(time + seedX)) * CELL_SIZE;
-                    // Theme-appropriate colors
-                    float r, g, b;
-                    if (currentTheme == THEME_DARK) {
-                        r = 0.3f + 0.05f * sin(seedX); g = 0.25f + 0.05f * sin(seedY); b = 0.35f;
-                    }
-                    else {
-                        r = 0.5f + 0.05f * sin(seedX); g = 0.45f + 0.05f * sin(seedY); b = 0.4f;
-                    }
-                    // Draw asteroid body
-                    glColor3f(r, g, b);
-                    glBegin(GL_TRIANGLE_FAN);
-                    glVertex2f(asteroidX, asteroidY);
-                    for (int j = 0; j <= 8; j++) {
-                        float angle = 2.0f * M_PI * j / 8;
-                        float irregularity = 0.7f + 0.3f * sin(angle * 3 + seedY);
-                        glVertex2f(asteroidX + cos(angle) * size * irregularity,
-                            asteroidY + sin(angle) * size * irregularity);
-                    }
-                    glEnd();
-                    // Asteroid highlights
-                    glColor3f((currentTheme == THEME_DARK) ? 0.4f + 0.1f * sin(seedX) : 0.6f + 0.1f * sin(seedX),
-                        (currentTheme == THEME_DARK) ? 0.3f : 0.55f,
-                        (currentTheme == THEME_DARK) ? 0.45f : 0.5f);
-                    glBegin(GL_LINE_LOOP);
-                    for (int j = 0; j <= 8; j++) {
-                        float angle = 2.0f * M_PI * j / 8;
-                        float irregularity = 0.7f + 0.3f * sin(angle * 3 + seedY);
-                        glVertex2f(asteroidX + cos(angle) * size * irregularity,
-                            asteroidY + sin(angle) * size * irregularity);
-                    }
-                    glEnd();
-                    // Subtle glow
-                    float glowAlpha = (currentTheme == THEME_DARK) ? 0.1f : 0.05f;
-                    if (i == 0 && rand() % 4 == 0) {
-                        glColor4f((currentTheme == THEME_DARK) ? 0.3f : 0.5f,
-                            (currentTheme == THEME_DARK) ? 0.15f : 0.4f,
-                            (currentTheme == THEME_DARK) ? 0.4f : 0.3f, glowAlpha);
-                        glBegin(GL_TRIANGLE_FAN);
-                        glVertex2f(asteroidX, asteroidY);
-                        for (int j = 0; j <= 12; j++) {
-                            float angle = 2.0f * M_PI * j / 12;
-                            float irregularity = 0.9f + 0.1f * sin(angle * 2 + time);
-                            glVertex2f(asteroidX + cos(angle) * size * 1.8f * irregularity,
-                                asteroidY + sin(angle) * size * 1.8f * irregularity);
-                        }
-                        glEnd();
-                    }
-                }
-            }
+    // Places, outlines and colors only change with the map or theme
+    asteroidFieldUpdate(&asteroidField, &world.map.grid, cellSize, currentTheme == THEME_DARK);
+
+    // The glow's wobble is the same for every asteroid in a frame
+    const UnitCircle<12>& circle12 = unitCircle<12>();
+    float glowX[13], glowY[13];
+    for (int j = 0; j <= 12; j++) {
+        float angle = 2.0f * M_PI * j / 12;
+        float irregularity = 0.9f + 0.1f * fastSin(angle * 2 + time);
+        glowX[j] = circle12.cos[j] * 1.8f * irregularity;
+        glowY[j] = circle12.sin[j] * 1.8f * irregularity;
+    }
+    float glowAlpha = (currentTheme == THEME_DARK) ? 0.1f : 0.05f;
+
+    for (int a = 0; a < asteroidField.count; a++) {
+        const Asteroid* asteroid = &asteroidField.asteroids[a];
+        float size = (0.2f + 0.1f * fastSin(time + asteroid->phase)) * cellSize;
+        // Draw asteroid body
+        batchColor(&batch, asteroid->body[0], asteroid->body[1], asteroid->body[2], 1.0f);
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, asteroid->x, asteroid->y);
+        for (int j = 0; j <= ASTEROID_OUTLINE_POINTS; j++) {
+            int k = j % ASTEROID_OUTLINE_POINTS;
+            batchVertex(&batch, asteroid->x + asteroid->outlineX[k] * size, asteroid->y + asteroid->outlineY[k] * size);
+        }
+        batchEnd(&batch);
+        // Asteroid highlights
+        batchColor(&batch, asteroid->rim[0], asteroid->rim[1], asteroid->rim[2], 1.0f);
+        batchBegin(&batch, BATCH_LINE_LOOP);
+        for (int j = 0; j < ASTEROID_OUTLINE_POINTS; j++)
+            batchVertex(&batch, asteroid->x + asteroid->outlineX[j] * size, asteroid->y + asteroid->outlineY[j] * size);
+        batchEnd(&batch);
+        // Subtle glow, now and then on the first asteroid of a cell
+        if (a % ASTEROIDS_PER_CELL == 0 && rngRange(&renderRng, 4) == 0) {
+            batchColor(&batch, (currentTheme == THEME_DARK) ? 0.3f : 0.5f,
+                (currentTheme == THEME_DARK) ? 0.15f : 0.4f,
+                (currentTheme == THEME_DARK) ? 0.4f : 0.3f, glowAlpha);
+            batchBegin(&batch, BATCH_TRIANGLE_FAN);
+            batchVertex(&batch, asteroid->x, asteroid->y);
+            for (int j = 0; j <= 12; j++) batchVertex(&batch, asteroid->x + glowX[j] * size, asteroid->y + glowY[j] * size);
+            batchEnd(&batch);
         }
     }
 }
 
 // Updated rocket to be 30% larger than the smaller version (but still smaller than original)
 void renderPlayer(void) {
+    ProfileScope scope(&profiler, PASS_PLAYER);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.005f;
-    float radius = CELL_SIZE * 0.273f; // Increased by 30% from 0.21f
-    float pulse = 0.7f + 0.3f * sin(time);
-    float lightRatio = player.light / MAX_LIGHT_DURATION;
+    float radius = cellSize * 0.273f; // Increased by 30% from 0.21f
+    float pulse = 0.7f + 0.3f * fastSin(time);
+    float lightRatio = shownLight() / MAX_LIGHT_DURATION;
 
     // Calculate rocket orientation based on movement
     float angle = 0;
-    if (trailLength >= 2) {
-        float dx = player.x - trail[trailLength - 2].x;
-        float dy = player.y - trail[trailLength - 2].y;
+    if (world.trail.length >= 2) {
+        const TrailPoint* previous = trailAt(&world.trail, world.trail.length - 2);
+        float dx = world.player.x - previous->x;
+        float dy = world.player.y - previous->y;
         if (dx != 0 || dy != 0) angle = atan2(dy, dx);
     }
 
+    const UnitCircle<16>& circle16 = unitCircle<16>();
+    const UnitCircle<32>& circle32 = unitCircle<32>();
+
     // Draw rocket with rotation
-    glPushMatrix();
-    glTranslatef(player.x * CELL_SIZE, player.y * CELL_SIZE, 0);
-    glRotatef(angle * 180 / M_PI, 0, 0, 1);
+    batchTransform(&batch, world.player.x * cellSize, world.player.y * cellSize, angle);
 
     // Rocket body - more detailed, with new size
     // Nose cone (red-orange with highlight)
-    glBegin(GL_TRIANGLES);
-    glColor4f(0.9f, 0.4f, 0.2f, 0.9f * lightRatio);
-    glVertex2f(radius * 1.6f, 0);
-    glVertex2f(radius * 0.6f, radius * 0.45f);
-    glVertex2f(radius * 0.6f, -radius * 0.45f);
-    glEnd();
+    batchBegin(&batch, BATCH_TRIANGLES);
+    batchColor(&batch, 0.9f, 0.4f, 0.2f, 0.9f * lightRatio);
+    batchVertex(&batch, radius * 1.6f, 0);
+    batchVertex(&batch, radius * 0.6f, radius * 0.45f);
+    batchVertex(&batch, radius * 0.6f, -radius * 0.45f);
+    batchEnd(&batch);
 
     // Nose cone highlight
-    glBegin(GL_TRIANGLES);
-    glColor4f(1.0f, 0.7f, 0.5f, 0.9f * lightRatio);
-    glVertex2f(radius * 1.6f, 0);
-    glVertex2f(radius * 0.6f, radius * 0.15f);
-    glVertex2f(radius * 0.6f, -radius * 0.15f);
-    glEnd();
+    batchBegin(&batch, BATCH_TRIANGLES);
+    batchColor(&batch, 1.0f, 0.7f, 0.5f, 0.9f * lightRatio);
+    batchVertex(&batch, radius * 1.6f, 0);
+    batchVertex(&batch, radius * 0.6f, radius * 0.15f);
+    batchVertex(&batch, radius * 0.6f, -radius * 0.15f);
+    batchEnd(&batch);
 
     // Main body (silver with shadow)
-    glBegin(GL_QUADS);
-    glColor4f(0.9f, 0.9f, 0.95f, 0.9f * lightRatio);
-    glVertex2f(radius * 0.6f, radius * 0.45f);
-    glVertex2f(radius * 0.6f, -radius * 0.45f);
-    glVertex2f(-radius * 1.0f, -radius * 0.45f);
-    glVertex2f(-radius * 1.0f, radius * 0.45f);
-    glEnd();
+    batchBegin(&batch, BATCH_QUADS);
+    batchColor(&batch, 0.9f, 0.9f, 0.95f, 0.9f * lightRatio);
+    batchVertex(&batch, radius * 0.6f, radius * 0.45f);
+    batchVertex(&batch, radius * 0.6f, -radius * 0.45f);
+    batchVertex(&batch, -radius * 1.0f, -radius * 0.45f);
+    batchVertex(&batch, -radius * 1.0f, radius * 0.45f);
+    batchEnd(&batch);
 
     // Body shadow/detail
-    glBegin(GL_QUADS);
-    glColor4f(0.7f, 0.7f, 0.75f, 0.9f * lightRatio);
-    glVertex2f(radius * 0.6f, -radius * 0.15f);
-    glVertex2f(-radius * 1.0f, -radius * 0.15f);
-    glVertex2f(-radius * 1.0f, -radius * 0.45f);
-    glVertex2f(radius * 0.6f, -radius * 0.45f);
-    glEnd();
+    batchBegin(&batch, BATCH_QUADS);
+    batchColor(&batch, 0.7f, 0.7f, 0.75f, 0.9f * lightRatio);
+    batchVertex(&batch, radius * 0.6f, -radius * 0.15f);
+    batchVertex(&batch, -radius * 1.0f, -radius * 0.15f);
+    batchVertex(&batch, -radius * 1.0f, -radius * 0.45f);
+    batchVertex(&batch, radius * 0.6f, -radius * 0.45f);
+    batchEnd(&batch);
 
     // Body stripes/details
-    glBegin(GL_QUADS);
-    glColor4f(0.3f, 0.6f, 0.8f, 0.9f * lightRatio);
+    batchBegin(&batch, BATCH_QUADS);
+    batchColor(&batch, 0.3f, 0.6f, 0.8f, 0.9f * lightRatio);
     // Top stripe
-    glVertex2f(radius * 0.4f, radius * 0.45f);
-    glVertex2f(radius * 0.2f, radius * 0.45f);
-    glVertex2f(radius * 0.2f, -radius * 0.45f);
-    glVertex2f(radius * 0.4f, -radius * 0.45f);
+    batchVertex(&batch, radius * 0.4f, radius * 0.45f);
+    batchVertex(&batch, radius * 0.2f, radius * 0.45f);
+    batchVertex(&batch, radius * 0.2f, -radius * 0.45f);
+    batchVertex(&batch, radius * 0.4f, -radius * 0.45f);
     // Middle stripe
-    glVertex2f(-radius * 0.2f, radius * 0.45f);
-    glVertex2f(-radius * 0.4f, radius * 0.45f);
-    glVertex2f(-radius * 0.4f, -radius * 0.45f);
-    glVertex2f(-radius * 0.2f, -radius * 0.45f);
-    glEnd();
+    batchVertex(&batch, -radius * 0.2f, radius * 0.45f);
+    batchVertex(&batch, -radius * 0.4f, radius * 0.45f);
+    batchVertex(&batch, -radius * 0.4f, -radius * 0.45f);
+    batchVertex(&batch, -radius * 0.2f, -radius * 0.45f);
+    batchEnd(&batch);
 
     // Fins (blue with highlights)
-    glBegin(GL_TRIANGLES);
+    batchBegin(&batch, BATCH_TRIANGLES);
     // Top fin
-    glColor4f(0.2f, 0.4f, 0.9f, 0.9f * lightRatio);
-    glVertex2f(-radius * 0.7f, radius * 0.45f);
-    glVertex2f(-radius * 1.2f, radius * 0.9f);
-    glVertex2f(-radius * 1.0f, radius * 0.45f);
+    batchColor(&batch, 0.2f, 0.4f, 0.9f, 0.9f * lightRatio);
+    batchVertex(&batch, -radius * 0.7f, radius * 0.45f);
+    batchVertex(&batch, -radius * 1.2f, radius * 0.9f);
+    batchVertex(&batch, -radius * 1.0f, radius * 0.45f);
 
     // Top fin highlight
-    glColor4f(0.4f, 0.6f, 1.0f, 0.9f * lightRatio);
-    glVertex2f(-radius * 0.75f, radius * 0.45f);
-    glVertex2f(-radius * 1.15f, radius * 0.8f);
-    glVertex2f(-radius * 0.95f, radius * 0.45f);
+    batchColor(&batch, 0.4f, 0.6f, 1.0f, 0.9f * lightRatio);
+    batchVertex(&batch, -radius * 0.75f, radius * 0.45f);
+    batchVertex(&batch, -radius * 1.15f, radius * 0.8f);
+    batchVertex(&batch, -radius * 0.95f, radius * 0.45f);
 
     // Bottom fin
-    glColor4f(0.2f, 0.4f, 0.9f, 0.9f * lightRatio);
-    glVertex2f(-radius * 0.7f, -radius * 0.45f);
-    glVertex2f(-radius * 1.2f, -radius * 0.9f);
-    glVertex2f(-radius * 1.0f, -radius * 0.45f);
+    batchColor(&batch, 0.2f, 0.4f, 0.9f, 0.9f * lightRatio);
+    batchVertex(&batch, -radius * 0.7f, -radius * 0.45f);
+    batchVertex(&batch, -radius * 1.2f, -radius * 0.9f);
+    batchVertex(&batch, -radius * 1.0f, -radius * 0.45f);
 
     // Bottom fin highlight
-    glColor4f(0.4f, 0.6f, 1.0f, 0.9f * lightRatio);
-    glVertex2f(-radius * 0.75f, -radius * 0.45f);
-    glVertex2f(-radius * 1.15f, -radius * 0.8f);
-    glVertex2f(-radius * 0.95f, -radius * 0.45f);
-    glEnd();
+    batchColor(&batch, 0.4f, 0.6f, 1.0f, 0.9f * lightRatio);
+    batchVertex(&batch, -radius * 0.75f, -radius * 0.45f);
+    batchVertex(&batch, -radius * 1.15f, -radius * 0.8f);
+    batchVertex(&batch, -radius * 0.95f, -radius * 0.45f);
+    batchEnd(&batch);
 
     // Windows/porthole (brighter blue)
-    glColor4f(0.4f, 0.8f, 1.0f, 0.9f * lightRatio);
-    glBegin(GL_TRIANGLE_FAN);
+    batchColor(&batch, 0.4f, 0.8f, 1.0f, 0.9f * lightRatio);
+    batchBegin(&batch, BATCH_TRIANGLE_FAN);
     float windowX = radius * 0.2f;
     float windowY = 0;
     float windowSize = radius * 0.22f;
-    glVertex2f(windowX, windowY);
-    for (int i = 0; i <= 16; i++) {
-        float a = 2.0f * M_PI * i / 16;
-        glVertex2f(windowX + cos(a) * windowSize, windowY + sin(a) * windowSize);
-    }
-    glEnd();
+    batchVertex(&batch, windowX, windowY);
+    for (int i = 0; i <= 16; i++) batchVertex(&batch, windowX + circle16.cos[i] * windowSize, windowY + circle16.sin[i] * windowSize);
+    batchEnd(&batch);
 
     // Window highlight/reflection
-    glColor4f(0.8f, 0.9f, 1.0f, 0.7f * lightRatio);
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(windowX - windowSize * 0.3f, windowY - windowSize * 0.3f);
+    batchColor(&batch, 0.8f, 0.9f, 1.0f, 0.7f * lightRatio);
+    batchBegin(&batch, BATCH_TRIANGLE_FAN);
+    batchVertex(&batch, windowX - windowSize * 0.3f, windowY - windowSize * 0.3f);
     for (int i = 0; i <= 8; i++) {
-        float a = 2.0f * M_PI * i / 16;
-        glVertex2f(windowX - windowSize * 0.3f + cos(a) * windowSize * 0.4f,
-            windowY - windowSize * 0.3f + sin(a) * windowSize * 0.4f);
+        batchVertex(&batch, windowX - windowSize * 0.3f + circle16.cos[i] * windowSize * 0.4f,
+            windowY - windowSize * 0.3f + circle16.sin[i] * windowSize * 0.4f);
     }
-    glEnd();
+    batchEnd(&batch);
 
     // Engine exhaust/smoke - varies with energy level
     float exhaustScale = lightRatio * pulse;
@@ -1039,26 +630,26 @@ void renderPlayer(void) {
         float g = 0.3f + lightRatio * 0.7f;
         float b = (lightRatio > 0.7f) ? 0.5f * lightRatio : 0.0f;
 
-        glColor4f(r, g, b, layerAlpha);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(-radius * 1.0f, 0);
+        batchColor(&batch, r, g, b, layerAlpha);
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, -radius * 1.0f, 0);
 
         for (int i = 0; i <= 16; i++) {
-            float a = M_PI * (i / 16.0f + 0.5f); // Half circle for exhaust
-            float flicker = 1.0f + 0.4f * sin(time * 20.0f + i * 0.7f); // More dynamic flame flicker
+            // Half circle for exhaust: pi * (i / 16 + 0.5), i.e. a quarter turn on from 2 * pi * i / 32
+            float flicker = 1.0f + 0.4f * fastSin(time * 20.0f + i * 0.7f); // More dynamic flame flicker
             float exhaustWidth = (0.4f - layer * 0.1f) * radius * flicker;
-            glVertex2f(-radius * 1.0f - cos(a) * layerLength, sin(a) * exhaustWidth);
+            batchVertex(&batch, -radius * 1.0f + circle32.sin[i] * layerLength, circle32.cos[i] * exhaustWidth);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 
     // Smoke particles from exhaust (only visible with enough energy)
     if (lightRatio > 0.2f) {
-        glPointSize(3.5f); // Adjusted for increased rocket size
-        glBegin(GL_POINTS);
+        batchPointSize(&batch, 3.5f); // Adjusted for increased rocket size
+        batchBegin(&batch, BATCH_POINTS);
         for (int i = 0; i < 8; i++) {
-            float smokeX = -radius * (1.5f + (i * 0.5f)) + sin(time * 5.0f + i) * radius * 0.1f;
-            float smokeY = sin(time * 8.0f + i * 2.0f) * radius * 0.25f;
+            float smokeX = -radius * (1.5f + (i * 0.5f)) + fastSin(time * 5.0f + i) * radius * 0.1f;
+            float smokeY = fastSin(time * 8.0f + i * 2.0f) * radius * 0.25f;
             float smokeAlpha = (0.7f - i * 0.09f) * lightRatio;
 
             // Smoke gradient from orange to gray
@@ -1067,26 +658,29 @@ void renderPlayer(void) {
             float g = smokeVal * 0.9f;
             float b = smokeVal * 0.8f;
 
-            glColor4f(r, g, b, smokeAlpha);
-            glVertex2f(smokeX, smokeY);
+            batchColor(&batch, r, g, b, smokeAlpha);
+            batchVertex(&batch, smokeX, smokeY);
         }
-        glEnd();
-        glPointSize(1.0f);
+        batchEnd(&batch);
+        batchPointSize(&batch, 1.0f);
     }
 
-    glPopMatrix();
+    batchIdentity(&batch);
 }
 
 void renderTrail(void) {
+    ProfileScope scope(&profiler, PASS_TRAIL);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.01f;
-    for (int i = 0; i < trailLength; i++) {
-        float alpha = trail[i].intensity / 5.0f;
+    const UnitCircle<16>& circle16 = unitCircle<16>();
+    for (int i = 0; i < world.trail.length; i++) {
+        const TrailPoint* point = trailAt(&world.trail, i);
+        float alpha = trailIntensity(point, world.tickCount) / TRAIL_INTENSITY;
         if (alpha <= 0) continue;
 
         // Smoke gets larger and more transparent the older it is
-        float ageRatio = (float)i / trailLength;
-        float size = CELL_SIZE * (0.15f + ageRatio * 0.2f);
-        float trailX = trail[i].x * CELL_SIZE, trailY = trail[i].y * CELL_SIZE;
+        float ageRatio = (float)i / world.trail.length;
+        float size = cellSize * (0.15f + ageRatio * 0.2f);
+        float trailX = point->x * cellSize, trailY = point->y * cellSize;
 
         // Smoke color changes from orange to gray as it ages
         float smoke = 0.35f + ageRatio * 0.45f;
@@ -1095,157 +689,174 @@ void renderTrail(void) {
         float b = smoke * 0.7f;
 
         // Smoke puffs with slight pulse and more random shape
-        float pulse = 0.8f + 0.2f * sin(time + i * 0.2f);
+        float pulse = 0.8f + 0.2f * fastSin(time + i * 0.2f);
 
-        glColor4f(r, g, b, alpha * (0.8f - ageRatio * 0.6f));
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(trailX, trailY);
+        batchColor(&batch, r, g, b, alpha * (0.8f - ageRatio * 0.6f));
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, trailX, trailY);
         for (int j = 0; j <= 16; j++) {
             float angle = 2.0f * M_PI * j / 16;
-            float wobble = 1.0f + 0.4f * sin(angle * 4 + time + i * 0.3f);
-            glVertex2f(trailX + cos(angle) * size * pulse * wobble,
-                trailY + sin(angle) * size * pulse * wobble);
+            float wobble = 1.0f + 0.4f * fastSin(angle * 4 + time + i * 0.3f);
+            batchVertex(&batch, trailX + circle16.cos[j] * size * pulse * wobble,
+                trailY + circle16.sin[j] * size * pulse * wobble);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 }
 
 // Updated coins to look like lightning/electricity bolts ⚡
 void renderCoins(void) {
+    ProfileScope scope(&profiler, PASS_COINS);
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
-    for (int i = 0; i < totalCoins; i++) {
-        if (!coins[i].active) continue;
-        float x = coins[i].x * CELL_SIZE, y = coins[i].y * CELL_SIZE;
+    const UnitCircle<8>& circle8 = unitCircle<8>();
+    const UnitCircle<12>& circle12 = unitCircle<12>();
+    const UnitCircle<16>& circle16 = unitCircle<16>();
+    const UnitCircle<20>& circle20 = unitCircle<20>();
+    // Arcs turn with time, the outer end 0.2 rad ahead of the inner one
+    float arcCos1 = fastCos(time * 2.0f), arcSin1 = fastSin(time * 2.0f);
+    float arcCos2 = fastCos(time * 2.0f + 0.2f), arcSin2 = fastSin(time * 2.0f + 0.2f);
+    for (int i = 0; i < world.map.totalCoins; i++) {
+        if (!world.map.coins[i].active) continue;
+        float x = world.map.coins[i].x * cellSize, y = world.map.coins[i].y * cellSize;
         float rotation = time * 1.5f + i * 0.5f;
-        float pulse = 0.8f + 0.2f * sin(time * 3.0f + i);
-        float size = CELL_SIZE * 0.35f * pulse;
+        float pulse = 0.8f + 0.2f * fastSin(time * 3.0f + i);
+        float size = cellSize * 0.35f * pulse;
 
         // Draw warning triangle background (for standard high voltage symbol)
         // (optional - uncomment if you want triangular background)
         /*
         // Triangle with rounded corners and glow
-        glColor4f(0.9f, 0.8f, 0.0f, 0.2f + 0.1f * sin(time * 2.0f + i));
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(x, y);
+        batchColor(&batch, 0.9f, 0.8f, 0.0f, 0.2f + 0.1f * fastSin(time * 2.0f + i));
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, x, y);
         // Triangle with slight rotation
         for (int j = 0; j <= 3; j++) {
             float angle = 2.0f * M_PI * j / 3.0f + rotation * 0.1f;
             float dist = size * 2.0f;
-            glVertex2f(x + cos(angle) * dist, y + sin(angle) * dist);
+            batchVertex(&batch, x + fastCos(angle) * dist, y + fastSin(angle) * dist);
         }
-        glEnd();
+        batchEnd(&batch);
         */
 
         // Electric field glow (outer)
-        glColor4f(0.3f, 0.6f, 1.0f, 0.2f + 0.1f * sin(time * 2.0f + i));
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(x, y);
+        float glowCos = fastCos(rotation * 0.1f), glowSin = fastSin(rotation * 0.1f);
+        batchColor(&batch, 0.3f, 0.6f, 1.0f, 0.2f + 0.1f * fastSin(time * 2.0f + i));
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, x, y);
         for (int j = 0; j <= 20; j++) {
             float angle = 2.0f * M_PI * j / 20 + rotation * 0.1f;
-            float wobble = 1.0f + 0.2f * sin(angle * 4 + time * 3.0f);
-            glVertex2f(x + cos(angle) * size * 2.0f * wobble,
-                y + sin(angle) * size * 2.0f * wobble);
+            float wobble = 1.0f + 0.2f * fastSin(angle * 4 + time * 3.0f);
+            float dx, dy;
+            unitCircleTurned(circle20, j, glowCos, glowSin, &dx, &dy);
+            batchVertex(&batch, x + dx * size * 2.0f * wobble, y + dy * size * 2.0f * wobble);
         }
-        glEnd();
+        batchEnd(&batch);
 
         // Draw the standard electricity/high voltage warning bolt
         // Two layers - outer glow and inner bright core
         for (int layer = 0; layer < 2; layer++) {
             // Outer glow is blue, inner core is bright white-blue
             if (layer == 0) {
-                glColor4f(0.4f, 0.6f, 1.0f, (0.8f + 0.2f * sin(time * 5.0f + i)) * pulse);
+                batchColor(&batch, 0.4f, 0.6f, 1.0f, (0.8f + 0.2f * fastSin(time * 5.0f + i)) * pulse);
             }
             else {
-                glColor4f(0.9f, 0.95f, 1.0f, (0.9f + 0.1f * sin(time * 8.0f + i)) * pulse);
+                batchColor(&batch, 0.9f, 0.95f, 1.0f, (0.9f + 0.1f * fastSin(time * 8.0f + i)) * pulse);
             }
 
             float boltSize = size * (layer == 0 ? 1.1f : 0.9f);
 
             // Draw the classic down-pointing lightning bolt
-            glBegin(GL_TRIANGLE_STRIP);
+            batchBegin(&batch, BATCH_TRIANGLE_STRIP);
 
             // Top of the bolt
-            glVertex2f(x - boltSize * 0.2f, y - boltSize * 1.1f);
-            glVertex2f(x + boltSize * 0.2f, y - boltSize * 1.1f);
+            batchVertex(&batch, x - boltSize * 0.2f, y - boltSize * 1.1f);
+            batchVertex(&batch, x + boltSize * 0.2f, y - boltSize * 1.1f);
 
             // First zag to right
-            glVertex2f(x, y - boltSize * 0.5f);
-            glVertex2f(x + boltSize * 0.4f, y - boltSize * 0.5f);
+            batchVertex(&batch, x, y - boltSize * 0.5f);
+            batchVertex(&batch, x + boltSize * 0.4f, y - boltSize * 0.5f);
 
             // Second zag to left
-            glVertex2f(x, y + boltSize * 0.1f);
-            glVertex2f(x - boltSize * 0.4f, y + boltSize * 0.1f);
+            batchVertex(&batch, x, y + boltSize * 0.1f);
+            batchVertex(&batch, x - boltSize * 0.4f, y + boltSize * 0.1f);
 
             // Third zag to bottom point
-            glVertex2f(x - boltSize * 0.2f, y + boltSize * 1.1f);
-            glVertex2f(x + boltSize * 0.2f, y + boltSize * 1.1f);
-            glEnd();
+            batchVertex(&batch, x - boltSize * 0.2f, y + boltSize * 1.1f);
+            batchVertex(&batch, x + boltSize * 0.2f, y + boltSize * 1.1f);
+            batchEnd(&batch);
         }
 
         // Add electric spark particles around the bolt
-        glPointSize(3.0f);
-        glBegin(GL_POINTS);
+        batchPointSize(&batch, 3.0f);
+        batchBegin(&batch, BATCH_POINTS);
+        float sparkCos = fastCos(time * (1.0f + i * 0.1f)), sparkSin = fastSin(time * (1.0f + i * 0.1f));
         for (int j = 0; j < 12; j++) {
-            // Random but consistent spark positions
-            float sparkAngle = j * M_PI / 6.0f + time * (1.0f + i * 0.1f);
-            float sparkDist = size * (1.0f + 0.5f * sin(j * 0.5f + time * 3.0f));
-            float sparkX = x + cos(sparkAngle) * sparkDist;
-            float sparkY = y + sin(sparkAngle) * sparkDist;
+            // Random but consistent spark positions, a twelfth of a turn apart
+            float sparkDist = size * (1.0f + 0.5f * fastSin(j * 0.5f + time * 3.0f));
+            float dx, dy;
+            unitCircleTurned(circle12, j, sparkCos, sparkSin, &dx, &dy);
+            float sparkX = x + dx * sparkDist;
+            float sparkY = y + dy * sparkDist;
 
             // Dynamic brightness
-            float brightness = 0.7f + 0.3f * sin(time * 10.0f + j);
+            float brightness = 0.7f + 0.3f * fastSin(time * 10.0f + j);
 
             // Color gradient from white to blue
-            float blueRatio = 0.5f + 0.5f * sin(j * 0.7f + time * 2.0f);
-            glColor4f(0.7f + 0.3f * (1.0f - blueRatio),
+            float blueRatio = 0.5f + 0.5f * fastSin(j * 0.7f + time * 2.0f);
+            batchColor(&batch, 0.7f + 0.3f * (1.0f - blueRatio),
                 0.8f + 0.2f * (1.0f - blueRatio),
                 1.0f,
                 brightness);
-            glVertex2f(sparkX, sparkY);
+            batchVertex(&batch, sparkX, sparkY);
         }
-        glEnd();
+        batchEnd(&batch);
 
         // Add electric arcs connecting to sparks
-        glLineWidth(1.5f);
-        glBegin(GL_LINES);
+        batchLineWidth(&batch, 1.5f);
+        batchBegin(&batch, BATCH_LINES);
         for (int j = 0; j < 8; j++) {
-            float arcAngle1 = j * M_PI / 4.0f + time * 2.0f;
-            float arcAngle2 = j * M_PI / 4.0f + 0.2f + time * 2.0f;
-
-            float arcX1 = x + cos(arcAngle1) * size * 0.7f;
-            float arcY1 = y + sin(arcAngle1) * size * 0.7f;
-            float arcX2 = x + cos(arcAngle2) * size * 1.6f;
-            float arcY2 = y + sin(arcAngle2) * size * 1.6f;
-
-            float alpha = 0.6f + 0.4f * sin(time * 8.0f + j);
-            glColor4f(0.4f, 0.7f, 1.0f, alpha);
-            glVertex2f(arcX1, arcY1);
-            glVertex2f(arcX2, arcY2);
+            float dx1, dy1, dx2, dy2;
+            unitCircleTurned(circle8, j, arcCos1, arcSin1, &dx1, &dy1);
+            unitCircleTurned(circle8, j, arcCos2, arcSin2, &dx2, &dy2);
+
+            float arcX1 = x + dx1 * size * 0.7f;
+            float arcY1 = y + dy1 * size * 0.7f;
+            float arcX2 = x + dx2 * size * 1.6f;
+            float arcY2 = y + dy2 * size * 1.6f;
+
+            float alpha = 0.6f + 0.4f * fastSin(time * 8.0f + j);
+            batchColor(&batch, 0.4f, 0.7f, 1.0f, alpha);
+            batchVertex(&batch, arcX1, arcY1);
+            batchVertex(&batch, arcX2, arcY2);
         }
-        glEnd();
-        glLineWidth(1.0f);
+        batchEnd(&batch);
+        batchLineWidth(&batch, 1.0f);
 
         // Occasional energy burst (only on some coins and at random intervals)
         if (i % 3 == 0 && (int)(time * 3.0f) % 2 == 0) {
-            glColor4f(0.5f, 0.8f, 1.0f, 0.3f * pulse);
-            glBegin(GL_TRIANGLE_FAN);
-            glVertex2f(x, y);
+            batchColor(&batch, 0.5f, 0.8f, 1.0f, 0.3f * pulse);
+            batchBegin(&batch, BATCH_TRIANGLE_FAN);
+            batchVertex(&batch, x, y);
             for (int j = 0; j <= 16; j++) {
                 float burstAngle = 2.0f * M_PI * j / 16;
-                float burstDist = size * 2.5f * (1.0f + 0.3f * sin(burstAngle * 5 + time * 7.0f));
-                glVertex2f(x + cos(burstAngle) * burstDist, y + sin(burstAngle) * burstDist);
+                float burstDist = size * 2.5f * (1.0f + 0.3f * fastSin(burstAngle * 5 + time * 7.0f));
+                batchVertex(&batch, x + circle16.cos[j] * burstDist, y + circle16.sin[j] * burstDist);
             }
-            glEnd();
+            batchEnd(&batch);
         }
     }
 }
 
 void renderExit(void) {
-    float radius = CELL_SIZE * 0.6f;
+    ProfileScope scope(&profiler, PASS_EXIT);
+    float radius = cellSize * 0.6f;
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
     float rotation = time * 2.0f;
-    float pulse = 1.0f + 0.1f * sin(time * 3.0f);
-    float exitPosX = exitX * CELL_SIZE, exitPosY = exitY * CELL_SIZE;
+    float pulse = 1.0f + 0.1f * fastSin(time * 3.0f);
+    float exitPosX = world.map.exitX * cellSize, exitPosY = world.map.exitY * cellSize;
+    const UnitCircle<20>& circle20 = unitCircle<20>();
+    const UnitCircle<30>& circle30 = unitCircle<30>();
+    const UnitCircle<100>& circle100 = unitCircle<100>();
 
     // Outer event horizon layers
     for (int i = 0; i < 5; i++) {
@@ -1253,47 +864,51 @@ void renderExit(void) {
         float size = (1.2f + i * 0.4f) * pulse;
         float hue = i / 5.0f;
         float rotDir = (i % 2 == 0) ? 1 : -1;
-        glColor4f(0.2f + 0.2f * sin(hue * M_PI + time), 0.0f + 0.2f * sin(hue * M_PI * 2),
+        float turnCos = fastCos(rotation * rotDir), turnSin = fastSin(rotation * rotDir);
+        batchColor(&batch, 0.2f + 0.2f * fastSin(hue * M_PI + time), 0.0f + 0.2f * fastSin(hue * M_PI * 2),
             0.4f - 0.1f * hue, alpha);
-        glBegin(GL_TRIANGLE_FAN);
-        glVertex2f(exitPosX, exitPosY);
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        batchVertex(&batch, exitPosX, exitPosY);
         for (int j = 0; j <= 30; j++) {
             float angle = 2.0f * M_PI * j / 30 + rotation * rotDir;
-            float wobble = 1.0f + 0.2f * sin(angle * 6 + time * 4);
-            glVertex2f(exitPosX + cos(angle) * radius * size * wobble,
-                exitPosY + sin(angle) * radius * size * wobble);
+            float wobble = 1.0f + 0.2f * fastSin(angle * 6 + time * 4);
+            float dx, dy;
+            unitCircleTurned(circle30, j, turnCos, turnSin, &dx, &dy);
+            batchVertex(&batch, exitPosX + dx * radius * size * wobble, exitPosY + dy * radius * size * wobble);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 
     // Inner event horizon
-    glColor4f(0.4f, 0.0f, 0.6f, 0.5f);
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(exitPosX, exitPosY);
+    float innerCos = fastCos(rotation), innerSin = -fastSin(rotation);
+    batchColor(&batch, 0.4f, 0.0f, 0.6f, 0.5f);
+    batchBegin(&batch, BATCH_TRIANGLE_FAN);
+    batchVertex(&batch, exitPosX, exitPosY);
     for (int i = 0; i <= 20; i++) {
         float angle = 2.0f * M_PI * i / 20 - rotation;
-        float wobble = 1.0f + 0.15f * sin(angle * 4 + time * 5);
-        glVertex2f(exitPosX + cos(angle) * radius * 0.8f * pulse * wobble,
-            exitPosY + sin(angle) * radius * 0.8f * pulse * wobble);
+        float wobble = 1.0f + 0.15f * fastSin(angle * 4 + time * 5);
+        float dx, dy;
+        unitCircleTurned(circle20, i, innerCos, innerSin, &dx, &dy);
+        batchVertex(&batch, exitPosX + dx * radius * 0.8f * pulse * wobble, exitPosY + dy * radius * 0.8f * pulse * wobble);
     }
-    glEnd();
+    batchEnd(&batch);
     // Central singularity
-    glColor4f(0.0f, 0.0f, 0.0f, 0.95f);
-    glBegin(GL_TRIANGLE_FAN);
-    glVertex2f(exitPosX, exitPosY);
+    batchColor(&batch, 0.0f, 0.0f, 0.0f, 0.95f);
+    batchBegin(&batch, BATCH_TRIANGLE_FAN);
+    batchVertex(&batch, exitPosX, exitPosY);
     for (int i = 0; i <= 20; i++) {
-        float angle = 2.0f * M_PI * i / 20;
-        glVertex2f(exitPosX + cos(angle) * radius * 0.5f * pulse,
-            exitPosY + sin(angle) * radius * 0.5f * pulse);
+        batchVertex(&batch, exitPosX + circle20.cos[i] * radius * 0.5f * pulse,
+            exitPosY + circle20.sin[i] * radius * 0.5f * pulse);
     }
-    glEnd();
+    batchEnd(&batch);
 
     // Accretion disk
     for (int s = 0; s < 3; s++) {
         float spiralOffset = s * 2.0f * M_PI / 3.0f;
-        float brightness = 0.7f + 0.3f * sin(time * 2.0f + s);
+        float brightness = 0.7f + 0.3f * fastSin(time * 2.0f + s);
+        float armCos = fastCos(rotation + spiralOffset), armSin = fastSin(rotation + spiralOffset);
 
-        glBegin(GL_LINE_STRIP);
+        batchBegin(&batch, BATCH_LINE_STRIP);
         for (int i = 0; i <= 100; i++) {
             float t = i / 100.0f * 8.0f * M_PI;
             float r = 0.2f + 0.6f * t / (8.0f * M_PI);
@@ -1302,71 +917,71 @@ void renderExit(void) {
 
             // Color based on spiral arm
             switch (s) {
-            case 0: glColor4f(0.7f - 0.4f * colorPos, 0.1f + 0.3f * colorPos, 0.9f, alpha); break;
-            case 1: glColor4f(0.2f + 0.5f * colorPos, 0.0f + 0.3f * colorPos, 0.8f - 0.3f * colorPos, alpha); break;
-            case 2: glColor4f(0.7f - 0.3f * colorPos, 0.2f * colorPos, 0.5f + 0.3f * colorPos, alpha); break;
+            case 0: batchColor(&batch, 0.7f - 0.4f * colorPos, 0.1f + 0.3f * colorPos, 0.9f, alpha); break;
+            case 1: batchColor(&batch, 0.2f + 0.5f * colorPos, 0.0f + 0.3f * colorPos, 0.8f - 0.3f * colorPos, alpha); break;
+            case 2: batchColor(&batch, 0.7f - 0.3f * colorPos, 0.2f * colorPos, 0.5f + 0.3f * colorPos, alpha); break;
             }
-            glVertex2f(exitPosX + cos(t + rotation + spiralOffset) * radius * r,
-                exitPosY + sin(t + rotation + spiralOffset) * radius * r);
+            // t is four turns over the strip: point 4 * i of a 100-gon
+            float dx, dy;
+            unitCircleTurned(circle100, 4 * i % 100, armCos, armSin, &dx, &dy);
+            batchVertex(&batch, exitPosX + dx * radius * r, exitPosY + dy * radius * r);
         }
-        glEnd();
+        batchEnd(&batch);
     }
 
     // Sparkles
-    glPointSize(2.0f);
-    glBegin(GL_POINTS);
+    batchPointSize(&batch, 2.0f);
+    batchBegin(&batch, BATCH_POINTS);
     for (int i = 0; i < 30; i++) {
-        float angle = (rand() % 628) / 100.0f;
-        float dist = (0.9f + 0.6f * (rand() % 100) / 100.0f) * radius;
-        float brightness = 0.5f + 0.5f * sin(time * 5.0f + i * 0.5f);
+        float angle = (rngRange(&renderRng, 628)) / 100.0f;
+        float dist = (0.9f + 0.6f * (rngRange(&renderRng, 100)) / 100.0f) * radius;
+        float brightness = 0.5f + 0.5f * fastSin(time * 5.0f + i * 0.5f);
         switch (i % 3) {
-        case 0: glColor4f(0.9f, 0.7f, 1.0f, brightness); break;
-        case 1: glColor4f(0.7f, 0.9f, 1.0f, brightness); break;
-        case 2: glColor4f(1.0f, 0.8f, 0.5f, brightness); break;
+        case 0: batchColor(&batch, 0.9f, 0.7f, 1.0f, brightness); break;
+        case 1: batchColor(&batch, 0.7f, 0.9f, 1.0f, brightness); break;
+        case 2: batchColor(&batch, 1.0f, 0.8f, 0.5f, brightness); break;
         }
-        glVertex2f(exitPosX + cos(angle) * dist, exitPosY + sin(angle) * dist);
+        batchVertex(&batch, exitPosX + fastCos(angle) * dist, exitPosY + fastSin(angle) * dist);
     }
-    glEnd();
+    batchEnd(&batch);
 }
 
 // Updated HUD to show "LIGHT" instead of "FUEL"
 void renderHUD(void) {
-    // Set up 2D overlay
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
-    gluOrtho2D(0, windowWidth, windowHeight, 0);
-    glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    ProfileScope scope(&profiler, PASS_HUD);
+    beginOverlay();
 
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
     float pulse = 0.8f + 0.2f * sin(time * 2.0f);
 
     // HUD panel background and border
-    glColor4f(0.1f, 0.1f, 0.2f, 0.7f);
-    glBegin(GL_QUADS);
-    glVertex2f(10, 10); glVertex2f(windowWidth - 10, 10);
-    glVertex2f(windowWidth - 10, 50); glVertex2f(10, 50);
-    glEnd();
-
-    glColor4f(0.3f, 0.5f, 0.8f, 0.5f * pulse);
-    glBegin(GL_LINE_LOOP);
-    glVertex2f(10, 10); glVertex2f(windowWidth - 10, 10);
-    glVertex2f(windowWidth - 10, 50); glVertex2f(10, 50);
-    glEnd();
+    batchColor(&batch, 0.1f, 0.1f, 0.2f, 0.7f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, 10, 10); batchVertex(&batch, windowWidth - 10, 10);
+    batchVertex(&batch, windowWidth - 10, 50); batchVertex(&batch, 10, 50);
+    batchEnd(&batch);
+
+    batchColor(&batch, 0.3f, 0.5f, 0.8f, 0.5f * pulse);
+    batchBegin(&batch, BATCH_LINE_LOOP);
+    batchVertex(&batch, 10, 10); batchVertex(&batch, windowWidth - 10, 10);
+    batchVertex(&batch, windowWidth - 10, 50); batchVertex(&batch, 10, 50);
+    batchEnd(&batch);
 
     // Light meter (changed from Fuel meter)
     float lightBarWidth = windowWidth / 4.0f;
     float lightBarHeight = 15.0f;
     float lightBarX = 20.0f;
     float lightBarY = 25.0f;
-    float lightPercentage = player.light / MAX_LIGHT_DURATION;
+    float lightPercentage = shownLight() / MAX_LIGHT_DURATION;
 
     // Light bar background
-    glColor4f(0.15f, 0.15f, 0.25f, 0.8f);
-    glBegin(GL_QUADS);
-    glVertex2f(lightBarX, lightBarY);
-    glVertex2f(lightBarX + lightBarWidth, lightBarY);
-    glVertex2f(lightBarX + lightBarWidth, lightBarY + lightBarHeight);
-    glVertex2f(lightBarX, lightBarY + lightBarHeight);
-    glEnd();
+    batchColor(&batch, 0.15f, 0.15f, 0.25f, 0.8f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, lightBarX, lightBarY);
+    batchVertex(&batch, lightBarX + lightBarWidth, lightBarY);
+    batchVertex(&batch, lightBarX + lightBarWidth, lightBarY + lightBarHeight);
+    batchVertex(&batch, lightBarX, lightBarY + lightBarHeight);
+    batchEnd(&batch);
 
     // Light indicator with color
     float r, g, b;
@@ -1377,241 +992,225 @@ void renderHUD(void) {
         pulse = 0.7f + 0.3f * sin(time * 10.0f); // Pulsing effect when low
     }
 
-    glColor4f(r, g, b, 0.8f * pulse);
-    glBegin(GL_QUADS);
-    glVertex2f(lightBarX, lightBarY);
-    glVertex2f(lightBarX + lightBarWidth * lightPercentage, lightBarY);
-    glVertex2f(lightBarX + lightBarWidth * lightPercentage, lightBarY + lightBarHeight);
-    glVertex2f(lightBarX, lightBarY + lightBarHeight);
-    glEnd();
+    batchColor(&batch, r, g, b, 0.8f * pulse);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, lightBarX, lightBarY);
+    batchVertex(&batch, lightBarX + lightBarWidth * lightPercentage, lightBarY);
+    batchVertex(&batch, lightBarX + lightBarWidth * lightPercentage, lightBarY + lightBarHeight);
+    batchVertex(&batch, lightBarX, lightBarY + lightBarHeight);
+    batchEnd(&batch);
 
     // Light meter label - LIGHT instead of FUEL
-    glColor3f(0.8f, 0.8f, 1.0f);
-    glRasterPos2f(lightBarX, lightBarY - 5);
-    const char lightLabel[] = "LIGHT";
-    for (const char* c = lightLabel; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_10, *c);
+    batchColor(&batch, 0.8f, 0.8f, 1.0f, 1.0f);
+    drawText(GLUT_BITMAP_HELVETICA_10, lightBarX, lightBarY - 5, "LIGHT");
 
     // Time remaining - no changes needed
     char timeStr[50];
-    int timeRemaining = timeLimit - gameTime;
+    int timeRemaining = world.timeLimit - world.gameTime;
     if (timeRemaining < 0) timeRemaining = 0;
     snprintf(timeStr, sizeof(timeStr), "TIME: %02d:%02d", timeRemaining / 60, timeRemaining % 60);
 
     // Color based on remaining time
-    if (timeRemaining > timeLimit / 2) glColor3f(0.7f, 1.0f, 0.7f); // Green
-    else if (timeRemaining > timeLimit / 5) glColor3f(1.0f, 1.0f, 0.5f); // Yellow
+    if (timeRemaining > world.timeLimit / 2) batchColor(&batch, 0.7f, 1.0f, 0.7f, 1.0f); // Green
+    else if (timeRemaining > world.timeLimit / 5) batchColor(&batch, 1.0f, 1.0f, 0.5f, 1.0f); // Yellow
     else { // Pulsing red
         float urgentPulse = 0.7f + 0.3f * sin(time * 8.0f);
-        glColor3f(1.0f * urgentPulse, 0.3f * urgentPulse, 0.3f * urgentPulse);
+        batchColor(&batch, 1.0f * urgentPulse, 0.3f * urgentPulse, 0.3f * urgentPulse, 1.0f);
     }
 
-    glRasterPos2f(windowWidth - 100, 25);
-    for (const char* c = timeStr; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+    drawText(GLUT_BITMAP_HELVETICA_12, windowWidth - 100, 25, timeStr);
 
     // Energy bolts collected
     char boltStr[50];
-    snprintf(boltStr, sizeof(boltStr), "ENERGY: %d/%d", player.coinsCollected, totalCoins);
+    snprintf(boltStr, sizeof(boltStr), "ENERGY: %d/%d", world.player.coinsCollected, world.map.totalCoins);
 
     // Visual indication when all energy bolts collected
-    if (player.coinsCollected == totalCoins) {
+    if (world.player.coinsCollected == world.map.totalCoins) {
         // Electric blue pulsing effect
         float energyPulse = 0.5f + 0.5f * sin(time * 5.0f);
-        glColor3f(0.3f + 0.4f * energyPulse,
+        batchColor(&batch, 0.3f + 0.4f * energyPulse,
             0.7f + 0.3f * energyPulse,
-            1.0f);
+            1.0f, 1.0f);
     }
     else {
-        glColor3f(0.6f, 0.8f, 1.0f);
+        batchColor(&batch, 0.6f, 0.8f, 1.0f, 1.0f);
     }
 
-    glRasterPos2f(windowWidth / 2 - 40, 25);
-    for (const char* c = boltStr; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+    drawText(GLUT_BITMAP_HELVETICA_12, windowWidth / 2 - 40, 25, boltStr);
 
-    // Restore the projection matrix
-    glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    endOverlay();
 }
 
 
 
 void renderGameState(void) {
-    // Set up 2D overlay for game states
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
-    gluOrtho2D(0, windowWidth, windowHeight, 0);
-    glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    ProfileScope scope(&profiler, PASS_GAME_STATE);
+    beginOverlay();
 
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
 
     // Render appropriate state screen
-    if (currentState == GAME_WIN || currentState == GAME_LOSE) {
+    if (world.state == GAME_WIN || world.state == GAME_LOSE) {
         // Background
-        bool isWin = (currentState == GAME_WIN);
-        glColor4f(isWin ? 0.0f : 0.2f, isWin ? 0.0f : 0.0f, isWin ? 0.2f : 0.0f, 0.7f);
-        glBegin(GL_QUADS);
-        glVertex2f(windowWidth / 2 - 250, windowHeight / 2 - 50);
-        glVertex2f(windowWidth / 2 + 250, windowHeight / 2 - 50);
-        glVertex2f(windowWidth / 2 + 250, windowHeight / 2 + 100);
-        glVertex2f(windowWidth / 2 - 250, windowHeight / 2 + 100);
-        glEnd();
+        bool isWin = (world.state == GAME_WIN);
+        batchColor(&batch, isWin ? 0.0f : 0.2f, isWin ? 0.0f : 0.0f, isWin ? 0.2f : 0.0f, 0.7f);
+        batchBegin(&batch, BATCH_QUADS);
+        batchVertex(&batch, windowWidth / 2 - 250, windowHeight / 2 - 50);
+        batchVertex(&batch, windowWidth / 2 + 250, windowHeight / 2 - 50);
+        batchVertex(&batch, windowWidth / 2 + 250, windowHeight / 2 + 100);
+        batchVertex(&batch, windowWidth / 2 - 250, windowHeight / 2 + 100);
+        batchEnd(&batch);
 
         // Border
         float borderPulse = 0.7f + 0.3f * sin(time * 3.0f);
-        glColor4f(isWin ? 0.3f : 0.8f * borderPulse, isWin ? 0.7f * borderPulse : 0.2f,
+        batchColor(&batch, isWin ? 0.3f : 0.8f * borderPulse, isWin ? 0.7f * borderPulse : 0.2f,
             isWin ? 0.3f * borderPulse : 0.2f, 0.8f);
-        glLineWidth(2.0f);
-        glBegin(GL_LINE_LOOP);
-        glVertex2f(windowWidth / 2 - 250, windowHeight / 2 - 50);
-        glVertex2f(windowWidth / 2 + 250, windowHeight / 2 - 50);
-        glVertex2f(windowWidth / 2 + 250, windowHeight / 2 + 100);
-        glVertex2f(windowWidth / 2 - 250, windowHeight / 2 + 100);
-        glEnd();
-        glLineWidth(1.0f);
+        batchLineWidth(&batch, 2.0f);
+        batchBegin(&batch, BATCH_LINE_LOOP);
+        batchVertex(&batch, windowWidth / 2 - 250, windowHeight / 2 - 50);
+        batchVertex(&batch, windowWidth / 2 + 250, windowHeight / 2 - 50);
+        batchVertex(&batch, windowWidth / 2 + 250, windowHeight / 2 + 100);
+        batchVertex(&batch, windowWidth / 2 - 250, windowHeight / 2 + 100);
+        batchEnd(&batch);
+        batchLineWidth(&batch, 1.0f);
 
         // Main message
         const char* mainMsg;
         if (isWin) {
             mainMsg = "WORMHOLE TRAVERSED SUCCESSFULLY!";
             float textPulse = 0.8f + 0.2f * sin(time * 2.0f);
-            glColor3f(0.3f * textPulse, 1.0f * textPulse, 0.3f * textPulse);
+            batchColor(&batch, 0.3f * textPulse, 1.0f * textPulse, 0.3f * textPulse, 1.0f);
         }
         else {
             // Changed to LIGHT instead of FUEL
-            mainMsg = player.light <= 0 ? "LIGHT DEPLETED - MISSION FAILED!" : "TIME EXPIRED - MISSION FAILED!";
+            mainMsg = world.player.light <= 0 ? "LIGHT DEPLETED - MISSION FAILED!" : "TIME EXPIRED - MISSION FAILED!";
             float textPulse = 0.8f + 0.2f * sin(time * 2.0f);
-            glColor3f(1.0f * textPulse, 0.3f * textPulse, 0.3f * textPulse);
+            batchColor(&batch, 1.0f * textPulse, 0.3f * textPulse, 0.3f * textPulse, 1.0f);
         }
 
-        glRasterPos2f(windowWidth / 2 - 150, windowHeight / 2 - 20);
-        for (const char* c = mainMsg; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+        drawText(GLUT_BITMAP_HELVETICA_18, windowWidth / 2 - 150, windowHeight / 2 - 20, mainMsg);
 
         // Stats
         if (isWin) {
             char timeMsg[100];
-            snprintf(timeMsg, sizeof(timeMsg), "Mission Time: %02d:%02d", gameTime / 60, gameTime % 60);
-            glColor3f(0.7f, 0.9f, 1.0f);
-            glRasterPos2f(windowWidth / 2 - 70, windowHeight / 2 + 20);
-            for (const char* c = timeMsg; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+            snprintf(timeMsg, sizeof(timeMsg), "Mission Time: %02d:%02d", world.gameTime / 60, world.gameTime % 60);
+            batchColor(&batch, 0.7f, 0.9f, 1.0f, 1.0f);
+            drawText(GLUT_BITMAP_HELVETICA_12, windowWidth / 2 - 70, windowHeight / 2 + 20, timeMsg);
+
+            // Moves against the shortest route
+            if (shortestMoves >= 0) {
+                char movesMsg[100];
+                snprintf(movesMsg, sizeof(movesMsg), "Moves: %d (shortest %d)", world.player.moves, shortestMoves);
+                drawText(GLUT_BITMAP_HELVETICA_12, windowWidth / 2 - 70, windowHeight / 2 + 35, movesMsg);
+            }
 
             // Best time if applicable
-            if (bestScores[currentDifficulty] != -1) {
+            if (bestScores[world.difficulty] != -1) {
                 char bestMsg[100];
                 snprintf(bestMsg, sizeof(bestMsg), "Best Time: %02d:%02d",
-                    bestScores[currentDifficulty] / 60, bestScores[currentDifficulty] % 60);
-                glColor3f(1.0f, 0.9f, 0.5f);
-                glRasterPos2f(windowWidth / 2 - 60, windowHeight / 2 + 50);
-                for (const char* c = bestMsg; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+                    bestScores[world.difficulty] / 60, bestScores[world.difficulty] % 60);
+                batchColor(&batch, 1.0f, 0.9f, 0.5f, 1.0f);
+                drawText(GLUT_BITMAP_HELVETICA_12, windowWidth / 2 - 60, windowHeight / 2 + 50, bestMsg);
             }
         }
         else {
             char statsMsg[100];
-            snprintf(statsMsg, sizeof(statsMsg), "Energy Collected: %d/%d", player.coinsCollected, totalCoins);
-            glColor3f(0.7f, 0.8f, 1.0f); // More blue tint for energy
-            glRasterPos2f(windowWidth / 2 - 70, windowHeight / 2 + 20);
-            for (const char* c = statsMsg; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_14, *c);
+            snprintf(statsMsg, sizeof(statsMsg), "Energy Collected: %d/%d", world.player.coinsCollected, world.map.totalCoins);
+            batchColor(&batch, 0.7f, 0.8f, 1.0f, 1.0f); // More blue tint for energy
+            drawText(GLUT_BITMAP_HELVETICA_14, windowWidth / 2 - 70, windowHeight / 2 + 20, statsMsg);
         }
 
         // Instructions
         const char pressR[] = "PRESS 'R' TO RETURN TO MENU";
-        glColor3f(0.8f, 0.8f, 1.0f);
-        glRasterPos2f(windowWidth / 2 - 100, windowHeight / 2 + 80);
-        for (const char* c = pressR; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+        batchColor(&batch, 0.8f, 0.8f, 1.0f, 1.0f);
+        drawText(GLUT_BITMAP_HELVETICA_12, windowWidth / 2 - 100, windowHeight / 2 + 80, pressR);
     }
 
-    // Restore the projection matrix
-    glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    endOverlay();
 }
 
 
 void renderMenu(void) {
-    // Setup 2D overlay
-    glMatrixMode(GL_PROJECTION); glPushMatrix(); glLoadIdentity();
-    gluOrtho2D(0, windowWidth, windowHeight, 0);
-    glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    ProfileScope scope(&profiler, PASS_MENU);
+    beginOverlay();
 
     float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
 
     // Best scores section
-    glColor3f(currentColors.textR, currentColors.textG, currentColors.textB);
+    batchColor(&batch, currentColors.textR, currentColors.textG, currentColors.textB, 1.0f);
     const char bestScoreLabel[] = "BEST SCORE";
-    glRasterPos2f(20, 30);
-    for (const char* c = bestScoreLabel; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+    drawText(GLUT_BITMAP_HELVETICA_12, 20, 30, bestScoreLabel);
 
     // Show difficulty scores
     const char difficultyNames[][10] = { "Easy", "Medium", "Hard" };
     for (int i = 0; i < 3; i++) {
         char timeStr[50];
-        if (bestScores[i] != -1) sprintf_s(timeStr, "%s: %02d:%02d", difficultyNames[i], bestScores[i] / 60, bestScores[i] % 60);
-        else sprintf_s(timeStr, "%s: --:--", difficultyNames[i]);
+        if (bestScores[i] != -1)
+            snprintf(timeStr, sizeof(timeStr), "%s: %02d:%02d", difficultyNames[i], bestScores[i] / 60, bestScores[i] % 60);
+        else snprintf(timeStr, sizeof(timeStr), "%s: --:--", difficultyNames[i]);
 
-        glColor3f(currentColors.textR * 0.9f, currentColors.textG * 0.9f, currentColors.textB * 0.9f);
-        glRasterPos2f(20, 50 + i * 20);
-        for (const char* c = timeStr; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_12, *c);
+        batchColor(&batch, currentColors.textR * 0.9f, currentColors.textG * 0.9f, currentColors.textB * 0.9f, 1.0f);
+        drawText(GLUT_BITMAP_HELVETICA_12, 20, 50 + i * 20, timeStr);
     }
 
     // Theme toggle switch
     float toggleX = windowWidth - 80, toggleY = 20;
 
     // Draw switch background and handle
-    glColor4f(0.2f, 0.2f, 0.3f, 0.8f);
-    glBegin(GL_QUADS);
-    glVertex2f(toggleX, toggleY); glVertex2f(toggleX + 60, toggleY);
-    glVertex2f(toggleX + 60, toggleY + 30); glVertex2f(toggleX, toggleY + 30);
-    glEnd();
+    batchColor(&batch, 0.2f, 0.2f, 0.3f, 0.8f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, toggleX, toggleY); batchVertex(&batch, toggleX + 60, toggleY);
+    batchVertex(&batch, toggleX + 60, toggleY + 30); batchVertex(&batch, toggleX, toggleY + 30);
+    batchEnd(&batch);
 
     float handlePos = currentTheme == THEME_DARK ? toggleX + 5 : toggleX + 35;
-    glColor4f(currentTheme == THEME_DARK ? 0.3f : 0.9f, currentTheme == THEME_DARK ? 0.5f : 0.9f,
+    batchColor(&batch, currentTheme == THEME_DARK ? 0.3f : 0.9f, currentTheme == THEME_DARK ? 0.5f : 0.9f,
         currentTheme == THEME_DARK ? 0.9f : 0.5f, 1.0f);
-    glBegin(GL_QUADS);
-    glVertex2f(handlePos, toggleY + 5); glVertex2f(handlePos + 20, toggleY + 5);
-    glVertex2f(handlePos + 20, toggleY + 25); glVertex2f(handlePos, toggleY + 25);
-    glEnd();
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, handlePos, toggleY + 5); batchVertex(&batch, handlePos + 20, toggleY + 5);
+    batchVertex(&batch, handlePos + 20, toggleY + 25); batchVertex(&batch, handlePos, toggleY + 25);
+    batchEnd(&batch);
 
     // Theme label
-    glColor3f(currentColors.textR, currentColors.textG, currentColors.textB);
+    batchColor(&batch, currentColors.textR, currentColors.textG, currentColors.textB, 1.0f);
     const char themeLabel[] = "Theme";
-    glRasterPos2f(toggleX + 10, toggleY + 45);
-    for (const char* c = themeLabel; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_10, *c);
+    drawText(GLUT_BITMAP_HELVETICA_10, toggleX + 10, toggleY + 45, themeLabel);
 
     // Main panel
     float panelWidth = 400, panelHeight = 450;
     float panelX = windowWidth / 2 - panelWidth / 2, panelY = windowHeight / 2 - panelHeight / 2;
 
     // Panel background and border
-    glColor4f(currentColors.uiR, currentColors.uiG, currentColors.uiB, 0.8f);
-    glBegin(GL_QUADS);
-    glVertex2f(panelX, panelY); glVertex2f(panelX + panelWidth, panelY);
-    glVertex2f(panelX + panelWidth, panelY + panelHeight); glVertex2f(panelX, panelY + panelHeight);
-    glEnd();
-
-    glColor4f(currentColors.accentR, currentColors.accentG, currentColors.accentB, 0.6f);
-    glLineWidth(2.0f);
-    glBegin(GL_LINE_LOOP);
-    glVertex2f(panelX, panelY); glVertex2f(panelX + panelWidth, panelY);
-    glVertex2f(panelX + panelWidth, panelY + panelHeight); glVertex2f(panelX, panelY + panelHeight);
-    glEnd();
-    glLineWidth(1.0f);
+    batchColor(&batch, currentColors.uiR, currentColors.uiG, currentColors.uiB, 0.8f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, panelX, panelY); batchVertex(&batch, panelX + panelWidth, panelY);
+    batchVertex(&batch, panelX + panelWidth, panelY + panelHeight); batchVertex(&batch, panelX, panelY + panelHeight);
+    batchEnd(&batch);
+
+    batchColor(&batch, currentColors.accentR, currentColors.accentG, currentColors.accentB, 0.6f);
+    batchLineWidth(&batch, 2.0f);
+    batchBegin(&batch, BATCH_LINE_LOOP);
+    batchVertex(&batch, panelX, panelY); batchVertex(&batch, panelX + panelWidth, panelY);
+    batchVertex(&batch, panelX + panelWidth, panelY + panelHeight); batchVertex(&batch, panelX, panelY + panelHeight);
+    batchEnd(&batch);
+    batchLineWidth(&batch, 1.0f);
 
     // Title
     const char title[] = "COSMIC LIGHT WEAVER";
     float titleX = panelX + panelWidth / 2 - 130, titleY = panelY + 80;
 
     // Title background
-    glColor4f(currentColors.uiR + 0.1f, currentColors.uiG + 0.1f, currentColors.uiB + 0.1f, 0.5f);
-    glBegin(GL_QUADS);
-    glVertex2f(titleX - 30, titleY - 25); glVertex2f(titleX + 280, titleY - 25);
-    glVertex2f(titleX + 280, titleY + 25); glVertex2f(titleX - 30, titleY + 25);
-    glEnd();
+    batchColor(&batch, currentColors.uiR + 0.1f, currentColors.uiG + 0.1f, currentColors.uiB + 0.1f, 0.5f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, titleX - 30, titleY - 25); batchVertex(&batch, titleX + 280, titleY - 25);
+    batchVertex(&batch, titleX + 280, titleY + 25); batchVertex(&batch, titleX - 30, titleY + 25);
+    batchEnd(&batch);
 
     // Title text with scaling
     float scaleFactor = 1.0f + 0.1f * sin(time * 2.0f);
-    glColor3f(currentColors.textR, currentColors.textG, currentColors.textB);
-    glPushMatrix();
-    glTranslatef(titleX + 130, titleY, 0);
-    glScalef(scaleFactor, scaleFactor, 1.0f);
-    glTranslatef(-(titleX + 130), -titleY, 0);
-
-    glRasterPos2f(titleX, titleY);
-    for (const char* c = title; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
-    glPopMatrix();
+    batchColor(&batch, currentColors.textR, currentColors.textG, currentColors.textB, 1.0f);
+    // Bitmap glyphs do not scale; the start of the line moves out from the center
+    drawText(GLUT_BITMAP_HELVETICA_18, titleX + 130 - 130 * scaleFactor, titleY, title);
 
     // Menu options
     const char* options[] = {
@@ -1626,78 +1225,130 @@ void renderMenu(void) {
     for (int i = 0; i < MENU_COUNT; i++) {
         if (i == selectedOption) {
             // Selected option
-            glColor3f(currentColors.textR + 0.2f, currentColors.textG + 0.2f, currentColors.textB + 0.2f);
-            glPushMatrix();
-            glTranslatef(optionX, optionY + i * optionSpacing, 0);
-            glScalef(1.2f, 1.2f, 1.0f);
-            glTranslatef(-optionX, -(optionY + i * optionSpacing), 0);
-            glRasterPos2f(optionX, optionY + i * optionSpacing);
-            for (const char* c = options[i]; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_14, *c);
-            glPopMatrix();
+            batchColor(&batch, currentColors.textR + 0.2f, currentColors.textG + 0.2f, currentColors.textB + 0.2f, 1.0f);
+            drawText(GLUT_BITMAP_HELVETICA_14, optionX, optionY + i * optionSpacing, options[i]);
 
             // Underline
             float textWidth = strlen(options[i]) * 9;
-            glLineWidth(2.0f);
-            glBegin(GL_LINES);
-            glVertex2f(optionX, optionY + i * optionSpacing + 5);
-            glVertex2f(optionX + textWidth, optionY + i * optionSpacing + 5);
-            glEnd();
-            glLineWidth(1.0f);
+            batchLineWidth(&batch, 2.0f);
+            batchBegin(&batch, BATCH_LINES);
+            batchVertex(&batch, optionX, optionY + i * optionSpacing + 5);
+            batchVertex(&batch, optionX + textWidth, optionY + i * optionSpacing + 5);
+            batchEnd(&batch);
+            batchLineWidth(&batch, 1.0f);
         }
         else {
             // Non-selected options
-            glColor3f(currentColors.textR * 0.7f, currentColors.textG * 0.7f, currentColors.textB * 0.7f);
-            glRasterPos2f(optionX, optionY + i * optionSpacing);
-            for (const char* c = options[i]; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_14, *c);
+            batchColor(&batch, currentColors.textR * 0.7f, currentColors.textG * 0.7f, currentColors.textB * 0.7f, 1.0f);
+            drawText(GLUT_BITMAP_HELVETICA_14, optionX, optionY + i * optionSpacing, options[i]);
         }
 
         // Difficulty indicator
         if (i < 3 && i == currentDifficulty) {
-            glColor3f(0.3f, 0.8f, 0.3f);
-            glPointSize(8.0f);
-            glBegin(GL_POINTS); glVertex2f(optionX + 120, optionY + i * optionSpacing); glEnd();
-            glPointSize(1.0f);
+            batchColor(&batch, 0.3f, 0.8f, 0.3f, 1.0f);
+            batchPointSize(&batch, 8.0f);
+            batchBegin(&batch, BATCH_POINTS); batchVertex(&batch, optionX + 120, optionY + i * optionSpacing); batchEnd(&batch);
+            batchPointSize(&batch, 1.0f);
         }
     }
 
     // Instructions
     const char instructions[] = "Use arrow keys to navigate, Enter to select";
-    glColor3f(currentColors.textR * 0.8f, currentColors.textG * 0.8f, currentColors.textB * 0.8f);
-    glRasterPos2f(panelX + panelWidth / 2 - 120, panelY + panelHeight - 30);
-    for (const char* c = instructions; *c; c++) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_10, *c);
+    batchColor(&batch, currentColors.textR * 0.8f, currentColors.textG * 0.8f, currentColors.textB * 0.8f, 1.0f);
+    drawText(GLUT_BITMAP_HELVETICA_10, panelX + panelWidth / 2 - 120, panelY + panelHeight - 30, instructions);
 
-    // Restore projection
-    glMatrixMode(GL_PROJECTION); glPopMatrix(); glMatrixMode(GL_MODELVIEW);
+    endOverlay();
 }
 
 void renderGame(void) {
-    // Render game elements in proper order
-    renderSpace(); renderTrail(); renderCoins(); renderExit(); renderPlayer();
+    // Render game elements back to front; a flush between passes keeps one pass's
+    // lines and points under the next pass's triangles
+    renderSpace(); flushBatch();
+    renderTrail(); flushBatch();
+    renderCoins(); flushBatch();
+    renderExit(); flushBatch();
+    renderPlayer();
     // Overlay UI
     renderHUD();
     // Game state overlays (win/lose screens)
-    if (currentState == GAME_WIN || currentState == GAME_LOSE) renderGameState();
+    if (world.state == GAME_WIN || world.state == GAME_LOSE) renderGameState();
+}
+
+// Rolling percentiles of the last PROFILER_HISTORY frames, top right
+void renderProfiler(void) {
+    ProfileScope scope(&profiler, PASS_PROFILER);
+    if (profiler.frames % PROFILER_OVERLAY_REFRESH == 0 || profileSummary.frames == 0)
+        frameProfilerSummarize(&profiler, &profileSummary);
+    const ProfileSummary* summary = &profileSummary;
+
+    beginOverlay();
+
+    const float lineHeight = 12.0f, width = 250.0f;
+    float left = windowWidth - width - 10.0f, top = 60.0f;
+    float height = (PASS_COUNT + 4) * lineHeight + 8.0f;
+    batchColor(&batch, 0.0f, 0.0f, 0.0f, 0.7f);
+    batchBegin(&batch, BATCH_QUADS);
+    batchVertex(&batch, left, top); batchVertex(&batch, left + width, top);
+    batchVertex(&batch, left + width, top + height); batchVertex(&batch, left, top + height);
+    batchEnd(&batch);
+
+    char line[128];
+    float x = left + 6.0f, y = top + lineHeight;
+    batchColor(&batch, 0.6f, 1.0f, 0.6f, 1.0f);
+    snprintf(line, sizeof(line), "%d frames  %.0f fps%s", summary->frames,
+        summary->interval.p50 > 0.0f ? 1e6f / summary->interval.p50 : 0.0f, profiler.csv ? "  [csv]" : "");
+    drawText(GLUT_BITMAP_HELVETICA_10, x, y, line); y += lineHeight;
+    snprintf(line, sizeof(line), "frame ms  p50 %.2f  p99 %.2f  max %.2f", summary->interval.p50 * 1e-3f,
+        summary->interval.p99 * 1e-3f, summary->interval.max * 1e-3f);
+    drawText(GLUT_BITMAP_HELVETICA_10, x, y, line); y += lineHeight;
+    snprintf(line, sizeof(line), "work ms   p50 %.2f  p99 %.2f  max %.2f", summary->work.p50 * 1e-3f,
+        summary->work.p99 * 1e-3f, summary->work.max * 1e-3f);
+    drawText(GLUT_BITMAP_HELVETICA_10, x, y, line); y += lineHeight;
+    snprintf(line, sizeof(line), "draws %.0f for %.0f shapes  vertices %.0f (p50)", summary->draws.p50,
+        summary->shapes.p50, summary->vertices.p50);
+    drawText(GLUT_BITMAP_HELVETICA_10, x, y, line); y += lineHeight;
+
+    // One line per pass in microseconds
+    batchColor(&batch, 0.9f, 0.9f, 0.9f, 1.0f);
+    for (int i = 0; i < PASS_COUNT; i++) {
+        const ProfilePercentiles* pass = &summary->pass[i];
+        drawText(GLUT_BITMAP_HELVETICA_10, x, y, passNames[i]);
+        snprintf(line, sizeof(line), "%7.1f %7.1f %7.1f us", pass->p50, pass->p95, pass->p99);
+        drawText(GLUT_BITMAP_HELVETICA_10, x + 80.0f, y, line);
+        y += lineHeight;
+    }
+
+    endOverlay();
 }
 
 void display(void) {
     glClear(GL_COLOR_BUFFER_BIT);
-    // Background effects
-    renderBackgroundEffects(); renderStarsAndNebulas(); renderParticles();
+    // Background effects, back to front
+    renderBackgroundEffects(); flushBatch();
+    renderStarsAndNebulas(); renderParticles();
     // Render game or menu based on state
-    if (currentState == GAME_MENU) renderMenu(); else renderGame();
-    glutSwapBuffers();
+    if (world.state == GAME_MENU) renderMenu(); else renderGame();
+    if (profilerOverlay) renderProfiler();
+    {
+        ProfileScope scope(&profiler, PASS_SWAP);
+        flushBatch();
+        glutSwapBuffers();
+    }
+    framesDrawn++;
+    frameProfilerEndFrame(&profiler);
 }
 
 void reshape(int w, int h) {
     windowWidth = w; windowHeight = h;
+    particleSystemResize(&particles, (float)w, (float)h);
     glViewport(0, 0, (GLsizei)w, (GLsizei)h);
     glMatrixMode(GL_PROJECTION); glLoadIdentity();
-    gluOrtho2D(0.0, GRID_WIDTH * CELL_SIZE, GRID_HEIGHT * CELL_SIZE, 0.0);
+    gluOrtho2D(0.0, gridWidth * cellSize, gridHeight * cellSize, 0.0);
     glMatrixMode(GL_MODELVIEW);
 }
 
 void keyboard(unsigned char key, int x, int y) {
-    if (currentState == GAME_MENU) {
+    if (world.state == GAME_MENU) {
         switch (key) {
         case 13: // Enter key
             switch (selectedOption) {
@@ -1707,7 +1358,15 @@ void keyboard(unsigned char key, int x, int y) {
             case MENU_THEME:
                 currentTheme = (currentTheme == THEME_DARK) ? THEME_LIGHT : THEME_DARK;
                 updateThemeColors(); break;
-            case MENU_START: updateDifficultySettings(); startNewGame(); break;
+            case MENU_START: {
+                // The pool solved the map's route when it rated it
+                MapRating rating;
+                mapPoolTake(&mapPool, currentDifficulty, &world.map, &rating);
+                shortestMoves = rating.moves;
+                gameWorldStartGame(&world, currentDifficulty);
+                lightBeforeTick = world.player.light;
+                replayBegin(&replay, &world); break;
+            }
             case MENU_EXIT: exit(0); break;
             }
             break;
@@ -1719,32 +1378,40 @@ void keyboard(unsigned char key, int x, int y) {
         glutPostRedisplay(); return;
     }
 
-    if (currentState == GAME_WIN || currentState == GAME_LOSE) {
-        if (key == 'r' || key == 'R') { currentState = GAME_MENU; glutPostRedisplay(); }
+    if (world.state == GAME_WIN || world.state == GAME_LOSE) {
+        if (key == 'r' || key == 'R') { world.state = GAME_MENU; glutPostRedisplay(); }
         else if (key == 'q' || key == 'Q' || key == 27) exit(0);
         return;
     }
 
     // Game controls
-    float newX = player.x, newY = player.y;
+    GameInput input = { MOVE_NONE };
     switch (key) {
-    case 'w': case 'W': newY -= 1.0f; break;
-    case 's': case 'S': newY += 1.0f; break;
-    case 'a': case 'A': newX -= 1.0f; break;
-    case 'd': case 'D': newX += 1.0f; break;
-    case 27: currentState = GAME_MENU; break; // ESC key
+    case 'w': case 'W': input.move = MOVE_UP; break;
+    case 's': case 'S': input.move = MOVE_DOWN; break;
+    case 'a': case 'A': input.move = MOVE_LEFT; break;
+    case 'd': case 'D': input.move = MOVE_RIGHT; break;
+    case 27: world.state = GAME_MENU; break; // ESC key
     }
 
-    if (isValidMove(newX, newY)) {
-        player.x = newX; player.y = newY;
-        addTrailPoint(player.x, player.y);
-        checkCoinCollision(); checkWinCondition();
-    }
+    replayRecordInput(&replay, &world, input.move);
+    handleGameEvents(gameWorldStep(&world, &input, 0.0f));
     glutPostRedisplay();
 }
 
 void specialKeys(int key, int x, int y) {
-    if (currentState == GAME_MENU) {
+    // Profiler keys work in every state
+    if (key == GLUT_KEY_F3) { profilerOverlay = !profilerOverlay; glutPostRedisplay(); return; }
+    if (key == GLUT_KEY_F4) {
+        if (profiler.csv) {
+            frameProfilerStopCsv(&profiler);
+            printf("Profiler: wrote %lld frames to %s\n", profiler.csvRows, PROFILE_CSV_PATH);
+        }
+        else if (frameProfilerStartCsv(&profiler, PROFILE_CSV_PATH)) printf("Profiler: recording to %s\n", PROFILE_CSV_PATH);
+        return;
+    }
+
+    if (world.state == GAME_MENU) {
         switch (key) {
         case GLUT_KEY_UP:
             selectedOption = (MenuOption)((selectedOption == 0) ? MENU_COUNT - 1 : selectedOption - 1); break;
@@ -1754,112 +1421,82 @@ void specialKeys(int key, int x, int y) {
         glutPostRedisplay(); return;
     }
 
-    if (currentState != GAME_PLAYING) return;
+    if (world.state != GAME_PLAYING) return;
 
-    float newX = player.x, newY = player.y;
+    GameInput input = { MOVE_NONE };
     switch (key) {
-    case GLUT_KEY_UP: newY -= 1.0f; break;
-    case GLUT_KEY_DOWN: newY += 1.0f; break;
-    case GLUT_KEY_LEFT: newX -= 1.0f; break;
-    case GLUT_KEY_RIGHT: newX += 1.0f; break;
+    case GLUT_KEY_UP: input.move = MOVE_UP; break;
+    case GLUT_KEY_DOWN: input.move = MOVE_DOWN; break;
+    case GLUT_KEY_LEFT: input.move = MOVE_LEFT; break;
+    case GLUT_KEY_RIGHT: input.move = MOVE_RIGHT; break;
     }
 
-    if (isValidMove(newX, newY)) {
-        player.x = newX; player.y = newY;
-        addTrailPoint(player.x, player.y);
-        checkCoinCollision(); checkWinCondition();
-    }
+    replayRecordInput(&replay, &world, input.move);
+    handleGameEvents(gameWorldStep(&world, &input, 0.0f));
     glutPostRedisplay();
 }
 
-void update(int value) {
-    float time = glutGet(GLUT_ELAPSED_TIME) * 0.001f;
+// One fixed step of everything that moves on its own
+void simulationTick(void) {
+    ProfileScope scope(&profiler, PASS_TICK);
+    float time = simClock.ticks * SIM_TICK_SECONDS;
 
-    if (currentState == GAME_PLAYING) {
-        // Decrease player light
-        float decayRate;
-        switch (currentDifficulty) {
-        case DIFFICULTY_EASY: decayRate = LIGHT_DECAY_RATE * 0.6f; break;
-        case DIFFICULTY_MEDIUM: decayRate = LIGHT_DECAY_RATE * 1.0f; break;
-        case DIFFICULTY_HARD: decayRate = LIGHT_DECAY_RATE * 1.5f; break;
-        default: decayRate = LIGHT_DECAY_RATE;
-        }
-        player.light -= decayRate;
-
-        // Update trail intensities and remove faded points
-        for (int i = 0; i < trailLength; i++) trail[i].intensity -= 0.2f;
-        int i = 0;
-        while (i < trailLength) {
-            if (trail[i].intensity <= 0) {
-                memmove(&trail[i], &trail[i + 1], (trailLength - i - 1) * sizeof(TrailPoint));
-                trailLength--;
-            }
-            else i++;
-        }
+    lightBeforeTick = world.player.light;
+    handleGameEvents(gameWorldStep(&world, NULL, SIM_TICK_SECONDS));
 
+    if (world.state == GAME_PLAYING) {
         // Twinkle stars
         for (int i = 0; i < MAX_STARS; i++)
-            if (rand() % 30 == 0) stars[i].brightness = 0.3f + ((float)rand() / RAND_MAX) * 0.7f;
+            if (rngRange(&visualRng, 30) == 0) stars[i].brightness = 0.3f + rngFloat(&visualRng) * 0.7f;
 
         // Animate nebulas
         for (int i = 0; i < MAX_NEBULAS; i++)
             nebulas[i].a = (0.05f + 0.03f * sin(time * nebulas[i].pulse_speed));
-
-        // Check lose condition
-        if (player.light <= 0 || gameTime >= timeLimit) currentState = GAME_LOSE;
     }
 
     // Update particles in all game states
-    for (int i = 0; i < MAX_PARTICLES; i++) {
-        // Age particles
-        particles[i].age += 0.5f;
-
-        // Reset dead particles
-        if (particles[i].age >= particles[i].lifespan) {
-            // Spawn from sides
-            if (rand() % 2 == 0) {
-                // Left or right
-                particles[i].x = rand() % 2 == 0 ? 0 : windowWidth;
-                particles[i].y = rand() % windowHeight;
-                particles[i].vx = particles[i].x == 0 ? (0.2f + (rand() % 20) / 100.0f) :
-                    -(0.2f + (rand() % 20) / 100.0f);
-                particles[i].vy = (float)(rand() % 60 - 30) / 300.0f;
-            }
-            else {
-                // Top or bottom
-                particles[i].y = rand() % 2 == 0 ? 0 : windowHeight;
-                particles[i].x = rand() % windowWidth;
-                particles[i].vy = particles[i].y == 0 ? (0.2f + (rand() % 20) / 100.0f) :
-                    -(0.2f + (rand() % 20) / 100.0f);
-                particles[i].vx = (float)(rand() % 60 - 30) / 300.0f;
-            }
-
-            // Reset properties
-            particles[i].size = 1.0f + (rand() % 30) / 10.0f;
-            particles[i].color[0] = 0.1f + (rand() % 30) / 100.0f;
-            particles[i].color[1] = 0.2f + (rand() % 40) / 100.0f;
-            particles[i].color[2] = 0.5f + (rand() % 50) / 100.0f;
-            particles[i].alpha = 0.1f + (rand() % 40) / 100.0f;
-            particles[i].age = 0; particles[i].lifespan = 50.0f + rand() % 100;
-        }
-
-        // Move particles with wave motion
-        particles[i].x += particles[i].vx + sin(time + particles[i].y * 0.01f) * 0.2f;
-        particles[i].y += particles[i].vy + cos(time + particles[i].x * 0.01f) * 0.2f;
-    }
+    particleSystemUpdate(&particles, time, &jobs);
+}
 
+// Runs the ticks the clock has banked since the last frame, then draws. GLUT
+// timers only promise "not before", so a late callback shows up as extra
+// ticks instead of a slower game.
+void advanceFrame(void) {
+    int ticks = fixedStepAdvance(&simClock, clockNowNs());
+    for (int i = 0; i < ticks; i++) simulationTick();
     glutPostRedisplay();
-    glutTimerFunc(100, update, 0);
 }
 
-void updateTimer(int value) {
-    if (currentState == GAME_PLAYING) gameTime++;
-    glutTimerFunc(1000, updateTimer, 0);
+void frame(int value) {
+    advanceFrame();
+    // Frames keep to a fixed schedule; ones already missed are skipped
+    int64_t now = clockNowNs(), periodNs = 1000000000ll / renderRate;
+    nextFrameNs += periodNs;
+    if (nextFrameNs < now) nextFrameNs = now + periodNs;
+    glutTimerFunc((unsigned)((nextFrameNs - now) / 1000000), frame, 0);
+}
+
+void idleFrame(void) {
+    advanceFrame();
 }
 
 int main(int argc, char** argv) {
-    srand((unsigned int)time(NULL));
     glutInit(&argc, argv);
+
+    // Optional playfield size, seed and frame rate: cosmic_light_weaver [width height [seed [fps]]]
+    if (argc >= 3) {
+        gridWidth = atoi(argv[1]); gridHeight = atoi(argv[2]);
+        if (gridWidth < MIN_GRID_SIZE) gridWidth = MIN_GRID_SIZE;
+        if (gridHeight < MIN_GRID_SIZE) gridHeight = MIN_GRID_SIZE;
+    }
+    masterSeed = argc >= 4 ? strtoull(argv[3], NULL, 10) : (uint64_t)time(NULL);
+    if (argc >= 5) renderRate = atoi(argv[4]) > 0 ? atoi(argv[4]) : 0;
+    printf("Seed: %llu\n", (unsigned long long)masterSeed);
+    // Shrink cells so large maps still fit on screen
+    int largestSide = gridWidth > gridHeight ? gridWidth : gridHeight;
+    if (largestSide * cellSize > MAX_WINDOW_SIZE) cellSize = (float)MAX_WINDOW_SIZE / largestSide;
+    windowWidth = (int)(gridWidth * cellSize); windowHeight = (int)(gridHeight * cellSize);
+
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
     glutInitWindowSize(windowWidth, windowHeight);
     glutInitWindowPosition(100, 100);
@@ -1869,8 +1506,10 @@ int main(int argc, char** argv) {
     glutReshapeFunc(reshape);
     glutKeyboardFunc(keyboard);
     glutSpecialFunc(specialKeys);
-    glutTimerFunc(100, update, 0);
-    glutTimerFunc(1000, updateTimer, 0);
+    fixedStepStart(&simClock, SIM_TICKS_PER_SECOND, clockNowNs());
+    startedNs = nextFrameNs = simClock.lastNs;
+    if (renderRate > 0) glutTimerFunc(0, frame, 0);
+    else glutIdleFunc(idleFrame);
     glutMainLoop();
     return 0;
-}
\ No newline at end of file
+}
\ No newline at end of file
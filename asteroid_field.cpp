@@ -0,0 +1,60 @@
+#include "asteroid_field.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fast_trig.h"
+
+void asteroidFieldInit(AsteroidField* field) {
+    memset(field, 0, sizeof(*field));
+}
+
+void asteroidFieldFree(AsteroidField* field) {
+    free(field->asteroids);
+    memset(field, 0, sizeof(*field));
+}
+
+static void buildAsteroid(Asteroid* asteroid, int x, int y, int i, float cellSize, bool darkTheme) {
+    const UnitCircle<ASTEROID_OUTLINE_POINTS>& circle = unitCircle<ASTEROID_OUTLINE_POINTS>();
+    float seedX = (float)(x * 10 + y * 7 + i * 3);
+    float seedY = (float)(y * 10 + x * 3 + i * 7);
+    asteroid->x = x * cellSize + cellSize / 2 + sinf(seedX) * cellSize * 0.3f;
+    asteroid->y = y * cellSize + cellSize / 2 + cosf(seedY) * cellSize * 0.3f;
+    asteroid->phase = seedX;
+    if (darkTheme) {
+        asteroid->body[0] = 0.3f + 0.05f * sinf(seedX); asteroid->body[1] = 0.25f + 0.05f * sinf(seedY); asteroid->body[2] = 0.35f;
+        asteroid->rim[0] = 0.4f + 0.1f * sinf(seedX); asteroid->rim[1] = 0.3f; asteroid->rim[2] = 0.45f;
+    }
+    else {
+        asteroid->body[0] = 0.5f + 0.05f * sinf(seedX); asteroid->body[1] = 0.45f + 0.05f * sinf(seedY); asteroid->body[2] = 0.4f;
+        asteroid->rim[0] = 0.6f + 0.1f * sinf(seedX); asteroid->rim[1] = 0.55f; asteroid->rim[2] = 0.5f;
+    }
+    for (int j = 0; j < ASTEROID_OUTLINE_POINTS; j++) {
+        float angle = TRIG_TWO_PI * j / ASTEROID_OUTLINE_POINTS;
+        float irregularity = 0.7f + 0.3f * sinf(angle * 3 + seedY);
+        asteroid->outlineX[j] = circle.cos[j] * irregularity;
+        asteroid->outlineY[j] = circle.sin[j] * irregularity;
+    }
+}
+
+bool asteroidFieldUpdate(AsteroidField* field, const SpaceGrid* grid, float cellSize, bool darkTheme) {
+    if (field->valid && field->gridId == grid->id && field->gridVersion == grid->version &&
+        field->cellSize == cellSize && field->darkTheme == darkTheme) return false;
+
+    field->count = 0;
+    for (int y = 0; y < grid->height; y++) {
+        for (int x = 0; x < grid->width; x++) {
+            if (!spaceGridBlocked(grid, x, y)) continue;
+            if (field->count + ASTEROIDS_PER_CELL > field->capacity) {
+                field->capacity = field->capacity ? field->capacity * 2 : 256 * ASTEROIDS_PER_CELL;
+                field->asteroids = (Asteroid*)realloc(field->asteroids, field->capacity * sizeof(Asteroid));
+            }
+            for (int i = 0; i < ASTEROIDS_PER_CELL; i++) buildAsteroid(&field->asteroids[field->count++], x, y, i, cellSize, darkTheme);
+        }
+    }
+    field->gridId = grid->id; field->gridVersion = grid->version;
+    field->cellSize = cellSize;
+    field->darkTheme = darkTheme;
+    field->valid = true;
+    field->builds++;
+    return true;
+}
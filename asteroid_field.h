@@ -0,0 +1,40 @@
+#ifndef ASTEROID_FIELD_H
+#define ASTEROID_FIELD_H
+
+#include <stdbool.h>
+#include "space_grid.h"
+
+// What the renderer draws for blocked cells: three asteroids per cell, each
+// with a place, an irregular outline and colors that only depend on the cell
+// and the theme. They are worked out once per map and cached by grid id,
+// version, cell size and theme, so a frame only pulses each asteroid's size
+// and emits it. Nothing here touches OpenGL.
+
+#define ASTEROIDS_PER_CELL 3
+#define ASTEROID_OUTLINE_POINTS 8   // An octagon; a closed fan repeats the first
+
+typedef struct {
+    float x, y;             // Center in pixels
+    float phase;            // Size is (0.2 + 0.1 * sin(time + phase)) * cellSize
+    float body[3], rim[3];  // Fill and outline colors for the theme built for
+    float outlineX[ASTEROID_OUTLINE_POINTS], outlineY[ASTEROID_OUTLINE_POINTS]; // At size 1
+} Asteroid;
+
+typedef struct {
+    Asteroid* asteroids;    // Cell by cell in row order, ASTEROIDS_PER_CELL per blocked cell
+    int count, capacity;
+    unsigned int gridId, gridVersion;
+    float cellSize;
+    bool darkTheme;
+    bool valid;
+    int builds;             // Rebuilds since init, for benchmarks
+} AsteroidField;
+
+void asteroidFieldInit(AsteroidField* field);
+void asteroidFieldFree(AsteroidField* field);
+
+// Brings the field up to date with the grid, cell size and theme. Returns
+// true if it had to be rebuilt, false on a cache hit.
+bool asteroidFieldUpdate(AsteroidField* field, const SpaceGrid* grid, float cellSize, bool darkTheme);
+
+#endif
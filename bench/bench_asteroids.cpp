@@ -0,0 +1,185 @@
+// Asteroid drawing with and without the per-map geometry cache. On Hard maps
+// of a few sizes, times a frame of asteroids emitted into a render batch the
+// old way (place, outline and colors worked out again for every asteroid)
+// and from the cache (only the size pulse per asteroid), plus the cost of a
+// rebuild and of a cache hit. Checks that both ways emit the same vertices.
+//
+// Build: g++ -O2 -I. bench/bench_asteroids.cpp asteroid_field.cpp render_batch.cpp game_world.cpp pathfinding.cpp bitboard.cpp space_grid.cpp spatial_hash.cpp -o bench_asteroids -pthread
+// Usage: bench_asteroids [frames] [seed] [size...]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "asteroid_field.h"
+#include "fast_trig.h"
+#include "frame_clock.h"
+#include "game_world.h"
+#include "render_batch.h"
+
+#define CELL 40.0f
+
+// renderSpace before the cache, dark theme
+static void emitRecomputed(RenderBatch* batch, const SpaceGrid* grid, float time, RngStream* rng) {
+    const UnitCircle<8>& circle8 = unitCircle<8>();
+    const UnitCircle<12>& circle12 = unitCircle<12>();
+    for (int y = 0; y < grid->height; y++) {
+        for (int x = 0; x < grid->width; x++) {
+            if (!spaceGridBlocked(grid, x, y)) continue;
+            float offsetX = x * CELL + CELL / 2, offsetY = y * CELL + CELL / 2;
+            for (int i = 0; i < 3; i++) {
+                float seedX = (float)(x * 10 + y * 7 + i * 3);
+                float seedY = (float)(y * 10 + x * 3 + i * 7);
+                float asteroidX = offsetX + fastSin(seedX) * CELL * 0.3f;
+                float asteroidY = offsetY + fastCos(seedY) * CELL * 0.3f;
+                float size = (0.2f + 0.1f * fastSin(time + seedX)) * CELL;
+                batchColor(batch, 0.3f + 0.05f * fastSin(seedX), 0.25f + 0.05f * fastSin(seedY), 0.35f, 1.0f);
+                batchBegin(batch, BATCH_TRIANGLE_FAN);
+                batchVertex(batch, asteroidX, asteroidY);
+                for (int j = 0; j <= 8; j++) {
+                    float irregularity = 0.7f + 0.3f * fastSin(TRIG_TWO_PI * j / 8 * 3 + seedY);
+                    batchVertex(batch, asteroidX + circle8.cos[j] * size * irregularity, asteroidY + circle8.sin[j] * size * irregularity);
+                }
+                batchEnd(batch);
+                batchColor(batch, 0.4f + 0.1f * fastSin(seedX), 0.3f, 0.45f, 1.0f);
+                batchBegin(batch, BATCH_LINE_LOOP);
+                for (int j = 0; j < 8; j++) {
+                    float irregularity = 0.7f + 0.3f * fastSin(TRIG_TWO_PI * j / 8 * 3 + seedY);
+                    batchVertex(batch, asteroidX + circle8.cos[j] * size * irregularity, asteroidY + circle8.sin[j] * size * irregularity);
+                }
+                batchEnd(batch);
+                if (i == 0 && rngRange(rng, 4) == 0) {
+                    batchColor(batch, 0.3f, 0.15f, 0.4f, 0.1f);
+                    batchBegin(batch, BATCH_TRIANGLE_FAN);
+                    batchVertex(batch, asteroidX, asteroidY);
+                    for (int j = 0; j <= 12; j++) {
+                        float irregularity = 0.9f + 0.1f * fastSin(TRIG_TWO_PI * j / 12 * 2 + time);
+                        batchVertex(batch, asteroidX + circle12.cos[j] * size * 1.8f * irregularity,
+                            asteroidY + circle12.sin[j] * size * 1.8f * irregularity);
+                    }
+                    batchEnd(batch);
+                }
+            }
+        }
+    }
+}
+
+// renderSpace with the cache, dark theme
+static void emitCached(RenderBatch* batch, AsteroidField* field, const SpaceGrid* grid, float time, RngStream* rng) {
+    asteroidFieldUpdate(field, grid, CELL, true);
+    const UnitCircle<12>& circle12 = unitCircle<12>();
+    float glowX[13], glowY[13];
+    for (int j = 0; j <= 12; j++) {
+        float irregularity = 0.9f + 0.1f * fastSin(TRIG_TWO_PI * j / 12 * 2 + time);
+        glowX[j] = circle12.cos[j] * 1.8f * irregularity;
+        glowY[j] = circle12.sin[j] * 1.8f * irregularity;
+    }
+    for (int a = 0; a < field->count; a++) {
+        const Asteroid* asteroid = &field->asteroids[a];
+        float size = (0.2f + 0.1f * fastSin(time + asteroid->phase)) * CELL;
+        batchColor(batch, asteroid->body[0], asteroid->body[1], asteroid->body[2], 1.0f);
+        batchBegin(batch, BATCH_TRIANGLE_FAN);
+        batchVertex(batch, asteroid->x, asteroid->y);
+        for (int j = 0; j <= ASTEROID_OUTLINE_POINTS; j++) {
+            int k = j % ASTEROID_OUTLINE_POINTS;
+            batchVertex(batch, asteroid->x + asteroid->outlineX[k] * size, asteroid->y + asteroid->outlineY[k] * size);
+        }
+        batchEnd(batch);
+        batchColor(batch, asteroid->rim[0], asteroid->rim[1], asteroid->rim[2], 1.0f);
+        batchBegin(batch, BATCH_LINE_LOOP);
+        for (int j = 0; j < ASTEROID_OUTLINE_POINTS; j++)
+            batchVertex(batch, asteroid->x + asteroid->outlineX[j] * size, asteroid->y + asteroid->outlineY[j] * size);
+        batchEnd(batch);
+        if (a % ASTEROIDS_PER_CELL == 0 && rngRange(rng, 4) == 0) {
+            batchColor(batch, 0.3f, 0.15f, 0.4f, 0.1f);
+            batchBegin(batch, BATCH_TRIANGLE_FAN);
+            batchVertex(batch, asteroid->x, asteroid->y);
+            for (int j = 0; j <= 12; j++) batchVertex(batch, asteroid->x + glowX[j] * size, asteroid->y + glowY[j] * size);
+            batchEnd(batch);
+        }
+    }
+}
+
+// Largest difference in position or color between the two batches' vertices
+static float batchDifference(const RenderBatch* a, const RenderBatch* b) {
+    if (a->bucketCount != b->bucketCount) return INFINITY;
+    float worst = 0.0f;
+    for (int i = 0; i < a->bucketCount; i++) {
+        const BatchBucket *p = &a->buckets[i], *q = &b->buckets[i];
+        if (p->count != q->count) return INFINITY;
+        for (int v = 0; v < p->count; v++) {
+            const BatchVertex *s = &p->vertices[v], *t = &q->vertices[v];
+            worst = fmaxf(worst, fmaxf(fabsf(s->x - t->x), fabsf(s->y - t->y)));
+            worst = fmaxf(worst, fmaxf(fabsf(s->r - t->r), fmaxf(fabsf(s->g - t->g), fabsf(s->b - t->b))));
+        }
+    }
+    return worst;
+}
+
+static void runSize(int size, int frames, uint64_t seed) {
+    MapLayout map;
+    mapLayoutInit(&map, size, size);
+    generateEnvironment(&map, DIFFICULTY_HARD, false, seed);
+    int blocked = 0;
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++) blocked += spaceGridBlocked(&map.grid, x, y);
+
+    RenderBatch batch, check;
+    batchInit(&batch);
+    batchInit(&check);
+    AsteroidField field;
+    asteroidFieldInit(&field);
+    RngStream rng;
+
+    rngSeed(&rng, seed);
+    emitRecomputed(&batch, &map.grid, 0.0f, &rng);     // Warm-up grows the buckets
+    int vertices = batch.vertices;
+    int64_t start = clockNowNs();
+    for (int f = 0; f < frames; f++) {
+        batchClear(&batch);
+        emitRecomputed(&batch, &map.grid, f * 0.016f, &rng);
+    }
+    double recomputedUs = (clockNowNs() - start) * 1e-3 / frames;
+
+    start = clockNowNs();
+    for (int f = 0; f < frames; f++) {
+        batchClear(&batch);
+        emitCached(&batch, &field, &map.grid, f * 0.016f, &rng);
+    }
+    double cachedUs = (clockNowNs() - start) * 1e-3 / frames;
+
+    // Rebuilds, as after a new map or a theme change
+    const int rebuilds = 20;
+    start = clockNowNs();
+    for (int i = 0; i < rebuilds; i++) asteroidFieldUpdate(&field, &map.grid, CELL, i % 2 == 0);
+    double buildUs = (clockNowNs() - start) * 1e-3 / rebuilds;
+    start = clockNowNs();
+    for (int i = 0; i < 1000; i++) asteroidFieldUpdate(&field, &map.grid, CELL, false);
+    double hitNs = (clockNowNs() - start) / 1000.0;
+
+    // Same frame both ways
+    batchClear(&batch);
+    rngSeed(&rng, seed);
+    emitRecomputed(&batch, &map.grid, 1.5f, &rng);
+    rngSeed(&rng, seed);
+    emitCached(&check, &field, &map.grid, 1.5f, &rng);
+    printf("grid=%dx%d blocked=%d asteroids=%d vertices=%d recomputed_us=%.1f cached_us=%.1f speedup=%.2fx "
+        "build_us=%.1f hit_ns=%.1f builds=%d max_difference=%.4f\n", size, size, blocked, field.count, vertices,
+        recomputedUs, cachedUs, recomputedUs / cachedUs, buildUs, hitNs, field.builds, batchDifference(&batch, &check));
+
+    asteroidFieldFree(&field);
+    batchFree(&check);
+    batchFree(&batch);
+    mapLayoutFree(&map);
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 500;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    if (argc > 3) {
+        for (int i = 3; i < argc; i++) runSize(atoi(argv[i]), frames, seed);
+        return 0;
+    }
+    const int sizes[] = { 20, 64, 128 };
+    for (int i = 0; i < 3; i++) runSize(sizes[i], sizes[i] > 64 ? frames / 10 : frames, seed);
+    return 0;
+}
@@ -0,0 +1,305 @@
+// Render batching. Describes a frame shaped like the game's (the same shapes,
+// vertex counts and flush points as the render passes, on a map with a share
+// of asteroid cells) through the batcher, and reports draw calls per frame
+// against the one draw per shape immediate mode made, plus the CPU time to
+// describe the frame (vertex math included) and to batch a vertex alone.
+// The frame is described twice: with a libm sin and cos per direction and
+// wobble, as the render passes used to, and with the unit-circle tables and
+// fastSin; libm calls are counted per frame. Then checks the tables and
+// fastSin against libm, and that every shape came out as the independent
+// primitives it stands for.
+//
+// Build: g++ -O2 -I. bench/bench_batch.cpp render_batch.cpp -o bench_batch
+// Usage: bench_batch [frames] [asteroid percent] [seed]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "fast_trig.h"
+#include "frame_clock.h"
+#include "render_batch.h"
+#include "rng.h"
+
+#define GRID 20
+#define CELL 40.0f
+#define WINDOW (GRID * CELL)
+#define STARS 200
+#define NEBULAS 8
+#define COINS 10
+#define TRAIL_PUFFS 30
+#define PARTICLE_DRAWS 16       // Size bins times glow and core, drawn outside the batch
+#define VERTEX_ROUNDS 4000000
+
+static bool useTables;          // Directions from the tables and wobbles from fastSin, or both from libm
+static long long trigCalls;     // libm calls made describing frames
+
+static float waveSin(float x) {
+    if (useTables) return fastSin(x);
+    trigCalls++;
+    return sinf(x);
+}
+
+static float waveCos(float x) {
+    if (useTables) return fastCos(x);
+    trigCalls++;
+    return cosf(x);
+}
+
+typedef struct {
+    int draws, shapes, flushes;
+    long long vertices;
+} FrameCounts;
+
+// What the renderer's flush does, minus OpenGL: one draw per non-empty bucket
+static void flush(RenderBatch* batch, FrameCounts* counts) {
+    if (batch->vertices == 0) return;
+    for (int i = 0; i < batch->bucketCount; i++) counts->draws += batch->buckets[i].count > 0;
+    counts->shapes += batch->primitives;
+    counts->vertices += batch->vertices;
+    counts->flushes++;
+    batchClear(batch);
+}
+
+// An N-gon with a wobbling rim, like most fans the game draws
+template <int N> static void circle(RenderBatch* batch, BatchShape shape, float x, float y, float radius, bool center, float time) {
+    const UnitCircle<N>& table = unitCircle<N>();
+    batchBegin(batch, shape);
+    if (center) batchVertex(batch, x, y);
+    for (int j = 0; j <= N; j++) {
+        float angle = 6.2831853f * j / N;
+        float rim = radius * (1.0f + 0.2f * waveSin(angle * 4 + time));
+        float dx = useTables ? table.cos[j] : waveCos(angle), dy = useTables ? table.sin[j] : waveSin(angle);
+        batchVertex(batch, x + dx * rim, y + dy * rim);
+    }
+    batchEnd(batch);
+}
+
+static void quad(RenderBatch* batch, BatchShape shape, float x0, float y0, float x1, float y1) {
+    batchBegin(batch, shape);
+    batchVertex(batch, x0, y0); batchVertex(batch, x1, y0);
+    batchVertex(batch, x1, y1); batchVertex(batch, x0, y1);
+    batchEnd(batch);
+}
+
+static void describeFrame(RenderBatch* batch, const bool* blocked, const float* starSize, float time, FrameCounts* counts) {
+    // Background: vortex arms and the wavy grid
+    for (int arm = 0; arm < 3; arm++) {
+        batchBegin(batch, BATCH_LINE_STRIP);
+        for (float t = 0; t < 15.0f; t += 0.1f) {
+            batchColor(batch, 0.2f + 0.3f * waveSin(t + time), 0.3f + 0.3f * waveSin(t + time + 2.0f),
+                0.6f + 0.3f * waveSin(t + time + 4.0f), 0.5f * (1.0f - t / 15.0f));
+            batchVertex(batch, WINDOW / 2 + (10.0f + t * 30.0f) * waveCos(t * 1.5f + time),
+                WINDOW / 2 + (10.0f + t * 30.0f) * waveSin(t * 1.5f + time));
+        }
+        batchEnd(batch);
+    }
+    for (float y = 0; y < WINDOW; y += 70.0f) {
+        batchBegin(batch, BATCH_LINE_STRIP);
+        for (float x = 0; x < WINDOW; x += 5) {
+            batchColor(batch, 0.2f, 0.5f, 0.8f, 0.1f * (0.5f + 0.5f * waveSin(x * 0.01f + time)));
+            batchVertex(batch, x, y + 5.0f * waveSin(x * 0.02f + time));
+        }
+        batchEnd(batch);
+    }
+    for (float x = 0; x < WINDOW; x += 70.0f) {
+        batchBegin(batch, BATCH_LINE_STRIP);
+        for (float y = 0; y < WINDOW; y += 5) {
+            batchColor(batch, 0.3f, 0.4f, 0.9f, 0.1f * (0.5f + 0.5f * waveSin(y * 0.01f + time)));
+            batchVertex(batch, x + 5.0f * waveSin(y * 0.02f + time), y);
+        }
+        batchEnd(batch);
+    }
+    flush(batch, counts);
+
+    // Stars, glows on a third of them, nebula layers
+    for (int i = 0; i < STARS; i++) {
+        float x = (float)(i * 37 % 800), y = (float)(i * 91 % 800);
+        batchPointSize(batch, starSize[i]);
+        batchBegin(batch, BATCH_POINTS); batchVertex(batch, x, y); batchEnd(batch);
+        if (i % 3 == 0) circle<8>(batch, BATCH_TRIANGLE_FAN, x, y, starSize[i] * 2.0f, true, time);
+    }
+    flush(batch, counts);
+    for (int i = 0; i < NEBULAS; i++)
+        for (int j = 0; j < 5; j++) circle<20>(batch, BATCH_TRIANGLE_FAN, i * 100.0f, 400.0f, 150.0f * (1.0f - j * 0.15f), true, time);
+    flush(batch, counts);
+    counts->draws += PARTICLE_DRAWS;
+    counts->shapes += PARTICLE_DRAWS;
+
+    // Asteroids: three per blocked cell, a body and an outline each, now and then a glow
+    int glow = 0;
+    for (int cell = 0; cell < GRID * GRID; cell++) {
+        if (!blocked[cell]) continue;
+        float cx = (cell % GRID + 0.5f) * CELL, cy = (cell / GRID + 0.5f) * CELL;
+        for (int i = 0; i < 3; i++) {
+            batchColor(batch, 0.3f, 0.25f, 0.35f, 1.0f);
+            circle<8>(batch, BATCH_TRIANGLE_FAN, cx + i, cy - i, 0.25f * CELL, true, time);
+            circle<8>(batch, BATCH_LINE_LOOP, cx + i, cy - i, 0.25f * CELL, false, time);
+            if (i == 0 && glow++ % 4 == 0) circle<12>(batch, BATCH_TRIANGLE_FAN, cx, cy, 0.45f * CELL, true, time);
+        }
+    }
+    flush(batch, counts);
+    for (int i = 0; i < TRAIL_PUFFS; i++) circle<16>(batch, BATCH_TRIANGLE_FAN, i * CELL, 60.0f, 8.0f, true, time);
+    flush(batch, counts);
+
+    // Coins: glow, two bolt strips, sparks, arcs, a burst on every third
+    for (int i = 0; i < COINS; i++) {
+        float x = (i * 3 % GRID + 0.5f) * CELL, y = (i * 7 % GRID + 0.5f) * CELL;
+        circle<20>(batch, BATCH_TRIANGLE_FAN, x, y, 28.0f, true, time);
+        for (int layer = 0; layer < 2; layer++) {
+            batchBegin(batch, BATCH_TRIANGLE_STRIP);
+            for (int v = 0; v < 8; v++) batchVertex(batch, x + (v % 2) * 4.0f, y + v * 2.0f);
+            batchEnd(batch);
+        }
+        batchPointSize(batch, 3.0f);
+        batchBegin(batch, BATCH_POINTS);
+        for (int j = 0; j < 12; j++) batchVertex(batch, x + j, y - j);
+        batchEnd(batch);
+        batchLineWidth(batch, 1.5f);
+        batchBegin(batch, BATCH_LINES);
+        for (int j = 0; j < 16; j++) batchVertex(batch, x + j, y + j);
+        batchEnd(batch);
+        batchLineWidth(batch, 1.0f);
+        if (i % 3 == 0) circle<16>(batch, BATCH_TRIANGLE_FAN, x, y, 35.0f, true, time);
+    }
+    flush(batch, counts);
+
+    // Exit: horizon layers, inner and center discs, spiral arms, sparkles
+    for (int i = 0; i < 5; i++) circle<30>(batch, BATCH_TRIANGLE_FAN, 700.0f, 700.0f, 30.0f + i * 10.0f, true, time);
+    circle<20>(batch, BATCH_TRIANGLE_FAN, 700.0f, 700.0f, 20.0f, true, time);
+    circle<20>(batch, BATCH_TRIANGLE_FAN, 700.0f, 700.0f, 12.0f, true, time);
+    for (int s = 0; s < 3; s++) circle<100>(batch, BATCH_LINE_STRIP, 700.0f, 700.0f, 15.0f + s, false, time);
+    batchPointSize(batch, 2.0f);
+    batchBegin(batch, BATCH_POINTS);
+    for (int i = 0; i < 30; i++) batchVertex(batch, 700.0f + i, 690.0f);
+    batchEnd(batch);
+    flush(batch, counts);
+
+    // Player, rotated on the way in: 2 triangles, 3 quad shapes, 4 fins, 2 windows, 3 flames, smoke
+    batchTransform(batch, 60.0f, 60.0f, time);
+    for (int i = 0; i < 2; i++) {
+        batchBegin(batch, BATCH_TRIANGLES);
+        batchVertex(batch, 17.0f, 0.0f); batchVertex(batch, 6.0f, 5.0f); batchVertex(batch, 6.0f, -5.0f);
+        batchEnd(batch);
+    }
+    for (int i = 0; i < 3; i++) quad(batch, BATCH_QUADS, -11.0f, -5.0f, 6.0f, 5.0f);
+    batchBegin(batch, BATCH_TRIANGLES);
+    for (int v = 0; v < 12; v++) batchVertex(batch, -8.0f - v, v % 3 * 3.0f);
+    batchEnd(batch);
+    circle<16>(batch, BATCH_TRIANGLE_FAN, 2.0f, 0.0f, 2.4f, true, time);
+    circle<8>(batch, BATCH_TRIANGLE_FAN, 1.0f, -1.0f, 1.0f, true, time);
+    for (int layer = 0; layer < 3; layer++) circle<16>(batch, BATCH_TRIANGLE_FAN, -11.0f, 0.0f, 15.0f, true, time);
+    batchPointSize(batch, 3.5f);
+    batchBegin(batch, BATCH_POINTS);
+    for (int i = 0; i < 8; i++) batchVertex(batch, -16.0f - i * 5.0f, 0.0f);
+    batchEnd(batch);
+    batchIdentity(batch);
+
+    // HUD: the overlay flushes the world, then panel, border and bars, then three labels
+    flush(batch, counts);
+    quad(batch, BATCH_QUADS, 10, 10, WINDOW - 10, 50);
+    quad(batch, BATCH_LINE_LOOP, 10, 10, WINDOW - 10, 50);
+    quad(batch, BATCH_QUADS, 20, 25, 220, 40);
+    quad(batch, BATCH_QUADS, 20, 25, 120, 40);
+    flush(batch, counts);
+}
+
+template <int N> static double circleError(void) {
+    const UnitCircle<N>& table = unitCircle<N>();
+    double worst = 0.0;
+    for (int j = 0; j <= N; j++) {
+        double angle = 2.0 * M_PI * j / N;
+        worst = fmax(worst, fmax(fabs(table.cos[j] - cos(angle)), fabs(table.sin[j] - sin(angle))));
+    }
+    return worst;
+}
+
+// Vertices each shape kind turns into, to check the frame against
+static long long triangleVertices(int fanVertices) { return 3ll * (fanVertices - 2); }
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    int asteroidPercent = argc > 2 ? atoi(argv[2]) : 30;
+    uint64_t seed = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+
+    RngStream rng;
+    rngSeed(&rng, seed);
+    static bool blocked[GRID * GRID];
+    int asteroidCells = 0;
+    for (int i = 0; i < GRID * GRID; i++) asteroidCells += blocked[i] = (int)rngRange(&rng, 100) < asteroidPercent;
+    float starSize[STARS];
+    for (int i = 0; i < STARS; i++) starSize[i] = 1.0f + rngFloat(&rng) * 2.0f;
+
+    RenderBatch batch;
+    batchInit(&batch);
+    FrameCounts counts = { 0, 0, 0, 0 };
+    describeFrame(&batch, blocked, starSize, 0.0f, &counts);   // Warm-up grows the buckets
+
+    // The same frames with libm, then with the tables
+    double frameUs[2];
+    long long framesTrig[2];
+    int64_t start;
+    for (int mode = 0; mode < 2; mode++) {
+        useTables = mode == 1;
+        trigCalls = 0;
+        FrameCounts total = { 0, 0, 0, 0 };
+        start = clockNowNs();
+        for (int f = 0; f < frames; f++) describeFrame(&batch, blocked, starSize, f * 0.016f, &total);
+        frameUs[mode] = (clockNowNs() - start) * 1e-3 / frames;
+        framesTrig[mode] = trigCalls / frames;
+    }
+
+    // Fans of 18 vertices, as many puffs and asteroids are, with no math between vertices
+    batchClear(&batch);
+    start = clockNowNs();
+    for (int i = 0; i < VERTEX_ROUNDS / 18; i++) {
+        batchBegin(&batch, BATCH_TRIANGLE_FAN);
+        for (int v = 0; v < 18; v++) batchVertex(&batch, (float)v, (float)i);
+        batchEnd(&batch);
+        if (batch.vertices > 60000) batchClear(&batch);
+    }
+    double vertexNs = (clockNowNs() - start) / (double)(VERTEX_ROUNDS / 18 * 18);
+    printf("asteroid_cells=%d shapes=%d draws=%d flushes=%d vertices=%lld buckets=%d batch_ns_per_input_vertex=%.2f\n",
+        asteroidCells, counts.shapes, counts.draws, counts.flushes, counts.vertices, batch.bucketCount, vertexNs);
+    printf("draw_calls_before=%d draw_calls_after=%d reduction=%.0fx\n", counts.shapes, counts.draws,
+        (double)counts.shapes / counts.draws);
+    printf("trig=libm frame_us=%.1f libm_calls_per_frame=%lld\ntrig=tables frame_us=%.1f libm_calls_per_frame=%lld speedup=%.2fx\n",
+        frameUs[0], framesTrig[0], frameUs[1], framesTrig[1], frameUs[0] / frameUs[1]);
+
+    // Tables against libm for every segment count the game draws with, and fastSin over a long stretch of time
+    double fastError = 0.0;
+    double tableError = fmax(0.0, circleError<8>());
+    tableError = fmax(tableError, circleError<12>());
+    tableError = fmax(tableError, circleError<16>());
+    tableError = fmax(tableError, circleError<20>());
+    tableError = fmax(tableError, circleError<30>());
+    tableError = fmax(tableError, circleError<32>());
+    tableError = fmax(tableError, circleError<100>());
+    for (float x = -100.0f; x < 1000.0f; x += 0.001f) fastError = fmax(fastError, fabs(fastSin(x) - sin((double)x)));
+    printf("table_max_error=%.2e fast_sin_max_error=%.2e\n", tableError, fastError);
+
+    // Each kind of shape on its own against the primitives it should become
+    struct { BatchShape shape; int in; long long out; const char* name; } cases[] = {
+        { BATCH_TRIANGLE_FAN, 10, triangleVertices(10), "fan" },
+        { BATCH_TRIANGLE_STRIP, 8, triangleVertices(8), "strip" },
+        { BATCH_QUADS, 8, 12, "quads" },
+        { BATCH_TRIANGLES, 7, 6, "triangles" },         // The seventh vertex is dropped
+        { BATCH_LINE_STRIP, 9, 16, "line_strip" },
+        { BATCH_LINE_LOOP, 9, 18, "line_loop" },
+        { BATCH_LINES, 5, 4, "lines" },
+        { BATCH_POINTS, 5, 5, "points" },
+    };
+    int failures = 0;
+    for (int c = 0; c < (int)(sizeof(cases) / sizeof(cases[0])); c++) {
+        batchClear(&batch);
+        batchBegin(&batch, cases[c].shape);
+        for (int v = 0; v < cases[c].in; v++) batchVertex(&batch, (float)v, (float)(v * v));
+        batchEnd(&batch);
+        if (batch.vertices != cases[c].out) {
+            printf("shape=%s vertices=%d expected=%lld\n", cases[c].name, batch.vertices, cases[c].out);
+            failures++;
+        }
+    }
+    printf("shape_checks=%d failures=%d\n", (int)(sizeof(cases) / sizeof(cases[0])), failures);
+    batchFree(&batch);
+    return failures != 0;
+}
@@ -0,0 +1,168 @@
+// Coin route solver. On generated maps of every difficulty: solve time next
+// to map generation time, and three checks per map. The route is played
+// through gameWorldStep and must win in exactly the solved number of moves;
+// the exact order is compared with trying every order of up to
+// BRUTE_FORCE_COINS coins; and the heuristic is run on the same map to report
+// how far it lands from the optimum. Then exact and heuristic solve times on
+// a larger random field with more coins.
+//
+// Build: g++ -O2 -I. bench/bench_coin_route.cpp coin_route.cpp game_world.cpp pathfinding.cpp bitboard.cpp space_grid.cpp spatial_hash.cpp -o bench_coin_route -pthread
+// Usage: bench_coin_route [maps] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include "coin_route.h"
+
+#define BRUTE_FORCE_COINS 8
+#define FIELD_SIZE 64
+#define FIELD_DENSITY 20        // Percent of cells blocked
+#define FIELD_ROUNDS 200
+
+static const char* difficultyNames[3] = { "easy", "medium", "hard" };
+
+static double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+static double percentile(double* samples, int count, double p) {
+    std::sort(samples, samples + count);
+    return samples[(int)(p * (count - 1) + 0.5)];
+}
+
+// Walks the route cell by cell through the simulation; true if the game is
+// won on the last step and took exactly moves steps
+static bool playRoute(GameWorld* world, DifficultyLevel difficulty, const Point* path, int length, int moves) {
+    gameWorldStartGame(world, difficulty);
+    for (int i = 1; i < length; i++) {
+        int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        GameInput input = { dx > 0 ? MOVE_RIGHT : dx < 0 ? MOVE_LEFT : dy > 0 ? MOVE_DOWN : MOVE_UP };
+        if (!(gameWorldStep(world, &input, 0.0f) & GAME_EVENT_MOVED)) return false;
+        if (world->state != GAME_PLAYING && i != length - 1) return false;
+    }
+    return world->state == GAME_WIN && world->player.moves == moves;
+}
+
+// Best order of the solver's stops by trying them all
+static int bruteForce(const CoinRouteSolver* solver) {
+    const int n = solver->stopCount, c = n - 2;
+    int perm[BRUTE_FORCE_COINS], best = -1;
+    for (int i = 0; i < c; i++) perm[i] = i + 1;
+    do {
+        int cost = solver->matrix[perm[0]], previous = perm[0];
+        for (int i = 1; i < c; i++) { cost += solver->matrix[previous * n + perm[i]]; previous = perm[i]; }
+        cost += solver->matrix[previous * n + n - 1];
+        if (best < 0 || cost < best) best = cost;
+    } while (std::next_permutation(perm, perm + c));
+    return best;
+}
+
+static void runMaps(int maps, uint64_t seed) {
+    GameWorld world;
+    gameWorldInit(&world, DIFFICULTY_MEDIUM, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, seed);
+    CoinRouteSolver solver;
+    coinRouteInit(&solver, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    Point* path = (Point*)malloc(DEFAULT_GRID_WIDTH * DEFAULT_GRID_HEIGHT * (MAX_COINS + 1) * sizeof(Point));
+    double* solveUs = (double*)malloc(maps * sizeof(double));
+    RngStream seeds;
+    rngSeed(&seeds, seed);
+
+    for (int d = 0; d < 3; d++) {
+        DifficultyLevel difficulty = (DifficultyLevel)d;
+        double generateUs = 0.0;
+        long long totalMoves = 0, heuristicMoves = 0;
+        int solved = 0, unsolvable = 0, playFailures = 0, bruteMismatches = 0, heuristicOptimal = 0;
+        double worstGap = 0.0;
+        for (int m = 0; m < maps; m++) {
+            auto start = std::chrono::steady_clock::now();
+            generateEnvironment(&world.map, difficulty, false, rngNext(&seeds));
+            generateUs += elapsedUs(start);
+
+            // Heuristic first: playing the route below collects the coins
+            solver.exactMax = 0;
+            int heuristic = coinRouteSolveMap(&solver, &world.map, NULL);
+            solver.exactMax = COIN_ROUTE_EXACT_MAX;
+            start = std::chrono::steady_clock::now();
+            int moves = coinRouteSolveMap(&solver, &world.map, NULL);
+            solveUs[m] = elapsedUs(start);
+            if (moves < 0) { unsolvable++; continue; }
+            solved++;
+            totalMoves += moves;
+            heuristicMoves += heuristic;
+            heuristicOptimal += heuristic == moves;
+            if (moves > 0) worstGap = std::max(worstGap, (heuristic - moves) * 100.0 / moves);
+
+            int coins = solver.stopCount - 2;
+            if (coins <= BRUTE_FORCE_COINS && coins > 0 && bruteForce(&solver) != moves) bruteMismatches++;
+            int length = coinRoutePath(&solver, path, DEFAULT_GRID_WIDTH * DEFAULT_GRID_HEIGHT * (MAX_COINS + 1));
+            if (length != moves + 1 || !playRoute(&world, difficulty, path, length, moves)) playFailures++;
+        }
+        printf("difficulty=%s maps=%d solved=%d unsolvable=%d avg_moves=%.1f generate_us=%.1f solve_us_p50=%.1f "
+            "solve_us_p99=%.1f play_failures=%d brute_force_mismatches=%d heuristic_optimal=%.1f%% heuristic_gap=%.2f%% "
+            "heuristic_worst_gap=%.1f%%\n",
+            difficultyNames[d], maps, solved, unsolvable, solved ? (double)totalMoves / solved : 0.0, generateUs / maps,
+            percentile(solveUs, solved, 0.5), percentile(solveUs, solved, 0.99), playFailures, bruteMismatches,
+            solved ? heuristicOptimal * 100.0 / solved : 0.0,
+            totalMoves ? (heuristicMoves - totalMoves) * 100.0 / totalMoves : 0.0, worstGap);
+    }
+    free(solveUs); free(path);
+    coinRouteFree(&solver);
+    gameWorldFree(&world);
+}
+
+// Random open field with coins on free cells; start and exit in opposite corners
+static void runField(int coinCount, uint64_t seed) {
+    SpaceGrid grid;
+    spaceGridInit(&grid, FIELD_SIZE, FIELD_SIZE);
+    CoinRouteSolver solver;
+    coinRouteInit(&solver, FIELD_SIZE, FIELD_SIZE);
+    RngStream rng;
+    rngSeed(&rng, seed);
+    Point* coins = (Point*)malloc(coinCount * sizeof(Point));
+    Point start = { 0, 0 }, exit = { FIELD_SIZE - 1, FIELD_SIZE - 1 };
+    double exactUs = 0.0, heuristicUs = 0.0;
+    long long exactMoves = 0, heuristicMoves = 0;
+    int rounds = 0;
+    for (int r = 0; r < FIELD_ROUNDS; r++) {
+        for (int y = 0; y < FIELD_SIZE; y++)
+            for (int x = 0; x < FIELD_SIZE; x++) spaceGridSet(&grid, x, y, (int)rngRange(&rng, 100) < FIELD_DENSITY);
+        spaceGridSet(&grid, start.x, start.y, false);
+        spaceGridSet(&grid, exit.x, exit.y, false);
+        for (int i = 0; i < coinCount; i++) {
+            do { coins[i].x = rngRange(&rng, FIELD_SIZE); coins[i].y = rngRange(&rng, FIELD_SIZE); }
+            while (spaceGridBlocked(&grid, coins[i].x, coins[i].y));
+        }
+        solver.exactMax = COIN_ROUTE_EXACT_MAX;
+        auto t0 = std::chrono::steady_clock::now();
+        int exact = coinRouteSolve(&solver, &grid, start, coins, coinCount, exit, NULL);
+        double us = elapsedUs(t0);
+        if (exact < 0) continue;
+        bool wasExact = solver.exact;
+        solver.exactMax = 0;
+        t0 = std::chrono::steady_clock::now();
+        int heuristic = coinRouteSolve(&solver, &grid, start, coins, coinCount, exit, NULL);
+        heuristicUs += elapsedUs(t0);
+        exactUs += us;
+        exactMoves += wasExact ? exact : 0;
+        heuristicMoves += heuristic;
+        rounds++;
+    }
+    printf("field=%dx%d density=%d%% coins=%d rounds=%d solve_us=%.1f heuristic_us=%.1f", FIELD_SIZE, FIELD_SIZE,
+        FIELD_DENSITY, coinCount, rounds, rounds ? exactUs / rounds : 0.0, rounds ? heuristicUs / rounds : 0.0);
+    if (coinCount <= COIN_ROUTE_EXACT_MAX && exactMoves)
+        printf(" heuristic_gap=%.2f%%", (heuristicMoves - exactMoves) * 100.0 / exactMoves);
+    printf("\n");
+    free(coins);
+    coinRouteFree(&solver);
+    spaceGridFree(&grid);
+}
+
+int main(int argc, char** argv) {
+    int maps = argc > 1 ? atoi(argv[1]) : 3000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    runMaps(maps, seed);
+    const int coinCounts[] = { 10, COIN_ROUTE_EXACT_MAX, 30, 100 };
+    for (int i = 0; i < 4; i++) runField(coinCounts[i], seed + i);
+    return 0;
+}
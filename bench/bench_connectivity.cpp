@@ -0,0 +1,121 @@
+// Connectivity check cost: bit-parallel Bitboard floods against a scalar
+// queue BFS on random asteroid fields, plus route agreement.
+//
+// Build: g++ -O2 -I. bench/bench_connectivity.cpp bitboard.cpp space_grid.cpp -o bench_connectivity
+//        (add -mavx2 for the AVX2 path on maps up to 16x16)
+// Usage: bench_connectivity [seed]
+//
+// Times are per flood from the top-left corner.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "bitboard.h"
+
+static unsigned int xorshiftState = 2463534242u;
+
+static inline unsigned int xorshift(void) {
+    xorshiftState ^= xorshiftState << 13;
+    xorshiftState ^= xorshiftState >> 17;
+    xorshiftState ^= xorshiftState << 5;
+    return xorshiftState;
+}
+
+// Reference 4-connected BFS: steps from the source into dist, -1 if unreachable
+static void bfsDistances(const SpaceGrid* grid, int* dist, int* queue, int sourceX, int sourceY) {
+    static const int dx[4] = { 0, 1, 0, -1 }, dy[4] = { -1, 0, 1, 0 };
+    const int width = grid->width;
+    memset(dist, 0xFF, (size_t)width * grid->height * sizeof(int));
+    if (spaceGridBlocked(grid, sourceX, sourceY)) return;
+    int front = 0, back = 0;
+    dist[sourceY * width + sourceX] = 0;
+    queue[back++] = sourceY * width + sourceX;
+    while (front < back) {
+        int current = queue[front++];
+        int x = current % width, y = current / width;
+        for (int i = 0; i < 4; i++) {
+            int nx = x + dx[i], ny = y + dy[i];
+            if (spaceGridBlocked(grid, nx, ny) || dist[ny * width + nx] >= 0) continue; // Blocked also covers off the map
+            dist[ny * width + nx] = dist[current] + 1;
+            queue[back++] = ny * width + nx;
+        }
+    }
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void runSize(int size, int density) {
+    SpaceGrid grid;
+    spaceGridInit(&grid, size, size);
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+            spaceGridSet(&grid, x, y, xorshift() % 100 < (unsigned int)density);
+    // Clear start area, as the generator does
+    for (int y = 0; y < 3; y++)
+        for (int x = 0; x < 3; x++) spaceGridSet(&grid, x, y, false);
+
+    Bitboard board;
+    bitboardInit(&board, size, size);
+    int* dist = (int*)malloc((size_t)size * size * sizeof(int));
+    int* queue = (int*)malloc((size_t)size * size * sizeof(int));
+    int repeats = (int)(20000000 / ((long long)size * size)) + 1;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) bitboardLoad(&board, &grid);
+    double loadNs = elapsedNs(t0) / repeats;
+
+    int reached = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) reached = bitboardFlood(&board, 0, 0);
+    double floodNs = elapsedNs(t0) / repeats;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < repeats; r++) bfsDistances(&grid, dist, queue, 0, 0);
+    double bfsNs = elapsedNs(t0) / repeats;
+
+    // Same reached set, and every route as short as the BFS distance
+    bool match = true;
+    int bfsReached = 0, routes = 0;
+    Point* path = (Point*)malloc((size_t)size * size * sizeof(Point));
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            int steps = dist[y * size + x];
+            if (steps >= 0) bfsReached++;
+            if ((steps >= 0) != bitboardReached(&board, x, y)) match = false;
+            if (steps >= 0 && (x * 7 + y * 13) % 97 == 0) {
+                int length = bitboardRoute(&board, x, y, path, size * size);
+                if (length != steps + 1 || path[0].x != 0 || path[0].y != 0 || path[length - 1].x != x || path[length - 1].y != y) match = false;
+                for (int i = 1; i < length; i++)
+                    if (abs(path[i].x - path[i - 1].x) + abs(path[i].y - path[i - 1].y) != 1 || spaceGridBlocked(&grid, path[i].x, path[i].y)) match = false;
+                routes++;
+            }
+        }
+    }
+    if (reached != bfsReached) match = false;
+
+    printf("grid=%dx%d density=%d%% layout=%s reached=%d load_ns=%.0f flood_ns=%.0f bfs_ns=%.0f speedup=%.1fx routes=%d match=%s\n",
+        size, size, density, board.packed ? "packed256" : "rows", reached, loadNs, floodNs, bfsNs,
+        bfsNs / floodNs, routes, match ? "yes" : "NO");
+
+    free(path); free(dist); free(queue);
+    bitboardFree(&board);
+    spaceGridFree(&grid);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) xorshiftState = (unsigned int)strtoul(argv[1], NULL, 10) | 1u;
+#ifdef __AVX2__
+    printf("avx2=yes\n");
+#else
+    printf("avx2=no\n");
+#endif
+    const int sizes[] = { 15, 16, 32, 64, 128, 256, 512, 1024 };
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        runSize(sizes[i], 20);
+        runSize(sizes[i], 35);
+    }
+    return 0;
+}
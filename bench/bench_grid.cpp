@@ -0,0 +1,102 @@
+// Grid storage comparison: the old int-per-cell row-major map against the
+// bit-packed Morton-tiled SpaceGrid at several map sizes, one long and thin.
+//
+// Build: g++ -O2 -I. bench/bench_grid.cpp space_grid.cpp -o bench_grid
+// Usage: bench_grid [seed]
+//
+// Times are per cell for scans and per 3x3 neighbourhood for probes.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "bit_ops.h"
+#include "space_grid.h"
+
+static unsigned int xorshiftState = 2463534242u;
+
+static inline unsigned int xorshift(void) {
+    xorshiftState ^= xorshiftState << 13;
+    xorshiftState ^= xorshiftState >> 17;
+    xorshiftState ^= xorshiftState << 5;
+    return xorshiftState;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void runSize(int width, int height) {
+    size_t cells = (size_t)width * height;
+    int* flat = (int*)malloc(cells * sizeof(int));
+    SpaceGrid grid;
+    spaceGridInit(&grid, width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            bool blocked = xorshift() % 100 < 20;
+            flat[(size_t)y * width + x] = blocked;
+            spaceGridSet(&grid, x, y, blocked);
+        }
+    }
+
+    // Full scans
+    long long flatCount = 0, gridCount = 0;
+    int scans = (int)(64000000 / cells) + 1;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < scans; s++)
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++) flatCount += flat[(size_t)y * width + x] == 1;
+    double flatScanNs = elapsedNs(t0) / ((double)scans * cells);
+    t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < scans; s++)
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++) gridCount += spaceGridBlocked(&grid, x, y);
+    double gridScanNs = elapsedNs(t0) / ((double)scans * cells);
+
+    // Full scans eight cells at a time through the tile row bytes
+    long long rowCount = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int s = 0; s < scans; s++)
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x += GRID_TILE_SIZE) {
+                uint8_t bits = spaceGridRowByte(&grid, x, y);
+                if (width - x < GRID_TILE_SIZE) bits &= (uint8_t)((1u << (width - x)) - 1);
+                rowCount += popCount64(bits);
+            }
+    double rowScanNs = elapsedNs(t0) / ((double)scans * cells);
+
+    // 3x3 neighbourhoods around random cells, the pathfinder access pattern
+    const int probes = 4000000;
+    long long flatHits = 0, gridHits = 0;
+    unsigned int seed = xorshiftState;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < probes; i++) {
+        int cx = 1 + xorshift() % (width - 2), cy = 1 + xorshift() % (height - 2);
+        for (int y = cy - 1; y <= cy + 1; y++)
+            for (int x = cx - 1; x <= cx + 1; x++) flatHits += flat[(size_t)y * width + x] == 1;
+    }
+    double flatProbeNs = elapsedNs(t0) / probes;
+    xorshiftState = seed;
+    t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < probes; i++) {
+        int cx = 1 + xorshift() % (width - 2), cy = 1 + xorshift() % (height - 2);
+        for (int y = cy - 1; y <= cy + 1; y++)
+            for (int x = cx - 1; x <= cx + 1; x++) gridHits += spaceGridBlocked(&grid, x, y);
+    }
+    double gridProbeNs = elapsedNs(t0) / probes;
+
+    bool match = flatCount == gridCount && flatCount == rowCount && flatHits == gridHits;
+    printf("grid=%dx%d flat_bytes=%zu packed_bytes=%zu flat_scan_ns=%.3f packed_scan_ns=%.3f packed_row_scan_ns=%.3f "
+        "flat_probe_ns=%.2f packed_probe_ns=%.2f match=%s\n",
+        width, height, cells * sizeof(int), spaceGridMemoryBytes(&grid), flatScanNs, gridScanNs, rowScanNs,
+        flatProbeNs, gridProbeNs, match ? "yes" : "NO");
+
+    spaceGridFree(&grid);
+    free(flat);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) xorshiftState = (unsigned int)strtoul(argv[1], NULL, 10) | 1u;
+    const int sizes[][2] = { { 15, 15 }, { 64, 64 }, { 256, 256 }, { 1024, 1024 }, { 4096, 4096 }, { 4096, 16 } };
+    for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) runSize(sizes[i][0], sizes[i][1]);
+    return 0;
+}
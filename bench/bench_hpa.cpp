@@ -0,0 +1,177 @@
+// Hierarchical pathfinding on large asteroid-field maps: graph build time,
+// time to patch one changed cell, long-distance query time (abstract search,
+// then refinement) and path cost against the exact A* and JPS searches.
+//
+// Build: g++ -O2 -I. bench/bench_hpa.cpp hpa.cpp pathfinding.cpp space_grid.cpp -o bench_hpa
+// Usage: bench_hpa [seed] [size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "hpa.h"
+
+static unsigned int xorshiftState = 2463534242u;
+
+static inline unsigned int xorshift(void) {
+    xorshiftState ^= xorshiftState << 13;
+    xorshiftState ^= xorshiftState >> 17;
+    xorshiftState ^= xorshiftState << 5;
+    return xorshiftState;
+}
+
+static double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Every step is one of the eight moves, onto a free cell, obeying the corner rule
+static bool validPath(const SpaceGrid* grid, const Point* path, int length, float* cost) {
+    *cost = 0.0f;
+    for (int i = 0; i < length; i++) {
+        if (spaceGridBlocked(grid, path[i].x, path[i].y)) return false;
+        if (i == 0) continue;
+        int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        if (abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0)) return false;
+        if (dx != 0 && dy != 0 && (spaceGridBlocked(grid, path[i - 1].x + dx, path[i - 1].y) ||
+            spaceGridBlocked(grid, path[i - 1].x, path[i - 1].y + dy))) return false;
+        *cost += dx != 0 && dy != 0 ? 1.414f : 1.0f;
+    }
+    return true;
+}
+
+// Round asteroid fields until the density is reached
+static void fillGrid(SpaceGrid* grid, int size, int density) {
+    long long target = (long long)size * size * density / 100, blocked = 0;
+    while (blocked < target) {
+        int cx = xorshift() % size, cy = xorshift() % size, r = 1 + xorshift() % 5;
+        for (int y = cy - r; y <= cy + r; y++)
+            for (int x = cx - r; x <= cx + r; x++)
+                if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r && spaceGridInBounds(grid, x, y) && !spaceGridBlocked(grid, x, y)) {
+                    spaceGridSet(grid, x, y, true);
+                    blocked++;
+                }
+    }
+}
+
+// Free endpoint pairs at least half the map apart
+static void longQueries(const SpaceGrid* grid, int size, int* endpoints, int queries) {
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        do {
+            do { e[0] = xorshift() % size; e[1] = xorshift() % size; } while (spaceGridBlocked(grid, e[0], e[1]));
+            do { e[2] = xorshift() % size; e[3] = xorshift() % size; } while (spaceGridBlocked(grid, e[2], e[3]));
+        } while (abs(e[0] - e[2]) < size / 2 && abs(e[1] - e[3]) < size / 2);
+    }
+}
+
+static void runSize(int size, int density, int queries, int exactQueries, int updates) {
+    SpaceGrid grid;
+    spaceGridInit(&grid, size, size);
+    fillGrid(&grid, size, density);
+    int* endpoints = (int*)malloc(queries * 4 * sizeof(int));
+    longQueries(&grid, size, endpoints, queries);
+
+    HpaGraph hpa;
+    auto t0 = std::chrono::steady_clock::now();
+    hpaInit(&hpa, &grid);
+    double buildMs = elapsedUs(t0) / 1000.0;
+
+    long long nodes = 0;
+    for (int i = 0; i < hpa.clustersX * hpa.clustersY; i++) nodes += hpa.clusters[i].count;
+
+    // Abstract search alone, then search plus refinement
+    Point* path = (Point*)malloc((size_t)size * size * sizeof(Point));
+    long long expanded = 0;
+    int found = 0;
+    t0 = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        found += hpaFindRoute(&hpa, &grid, e[0], e[1], e[2], e[3]) >= 0;
+        expanded += hpa.nodesExpanded;
+    }
+    double routeUs = elapsedUs(t0) / queries;
+    t0 = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        if (hpaFindRoute(&hpa, &grid, e[0], e[1], e[2], e[3]) >= 0) hpaRefineRoute(&hpa, &grid, path, size * size);
+    }
+    double fullUs = elapsedUs(t0) / queries;
+
+    // Exact searches on a subset for time and path quality
+    PathSearchContext ctx;
+    pathSearchInit(&ctx, size, size);
+    double astarUs = 0.0, jpsUs = 0.0, ratioSum = 0.0, ratioMax = 1.0;
+    int agree = 0, valid = 0, compared = 0;
+    for (int q = 0; q < exactQueries && q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        t0 = std::chrono::steady_clock::now();
+        bool reachable = pathSearchFind(&ctx, &grid, e[0], e[1], e[2], e[3], NULL, 0) >= 0;
+        astarUs += elapsedUs(t0);
+        float exact = ctx.pathCost;
+        t0 = std::chrono::steady_clock::now();
+        pathSearchFindJPS(&ctx, &grid, e[0], e[1], e[2], e[3], NULL, 0);
+        jpsUs += elapsedUs(t0);
+
+        bool routed = hpaFindRoute(&hpa, &grid, e[0], e[1], e[2], e[3]) >= 0;
+        if (routed == reachable) agree++;
+        if (!routed) { valid++; continue; }
+        int length = hpaRefineRoute(&hpa, &grid, path, size * size);
+        float walked;
+        if (validPath(&grid, path, length, &walked) && path[0].x == e[0] && path[0].y == e[1] &&
+            path[length - 1].x == e[2] && path[length - 1].y == e[3] && fabsf(walked - hpa.pathCost) < 1e-3f * (1.0f + walked)) valid++;
+        if (reachable && exact > 0.0f) {
+            double ratio = hpa.pathCost / exact;
+            ratioSum += ratio;
+            if (ratio > ratioMax) ratioMax = ratio;
+            compared++;
+        }
+    }
+    int exactRun = exactQueries < queries ? exactQueries : queries;
+
+    // Toggle random cells and patch the graph; afterwards it must route like a fresh build
+    double updateUs = 0.0;
+    for (int u = 0; u < updates; u++) {
+        int x = xorshift() % size, y = xorshift() % size;
+        spaceGridSet(&grid, x, y, !spaceGridBlocked(&grid, x, y));
+        t0 = std::chrono::steady_clock::now();
+        hpaUpdateCell(&hpa, &grid, x, y);
+        updateUs += elapsedUs(t0);
+    }
+    HpaGraph fresh;
+    hpaInit(&fresh, &grid);
+    int consistent = 0;
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        int a = hpaFindRoute(&hpa, &grid, e[0], e[1], e[2], e[3]);
+        int b = hpaFindRoute(&fresh, &grid, e[0], e[1], e[2], e[3]);
+        if ((a >= 0) == (b >= 0) && hpa.pathCost == fresh.pathCost) consistent++;
+    }
+
+    printf("grid=%dx%d density=%d clusters=%dx%d nodes=%lld build_ms=%.1f queries=%d found=%d expanded=%lld route_us=%.1f route_refine_us=%.1f "
+        "astar_us=%.1f jps_us=%.1f speedup_vs_astar=%.0fx cost_ratio_mean=%.4f cost_ratio_max=%.4f agree=%d/%d valid=%d/%d "
+        "update_us=%.1f updated_matches_rebuild=%d/%d\n",
+        size, size, density, hpa.clustersX, hpa.clustersY, nodes, buildMs, queries, found, expanded / queries, routeUs, fullUs,
+        astarUs / exactRun, jpsUs / exactRun, (astarUs / exactRun) / fullUs, compared ? ratioSum / compared : 1.0, ratioMax,
+        agree, exactRun, valid, exactRun, updates ? updateUs / updates : 0.0, consistent, queries);
+
+    hpaFree(&fresh);
+    pathSearchFree(&ctx);
+    hpaFree(&hpa);
+    free(path); free(endpoints);
+    spaceGridFree(&grid);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) xorshiftState = (unsigned int)strtoul(argv[1], NULL, 10) | 1u;
+    if (argc > 2) {
+        int size = atoi(argv[2]);
+        runSize(size, 10, 200, 10, 1000);
+        runSize(size, 25, 200, 10, 1000);
+        return 0;
+    }
+    runSize(256, 10, 1000, 200, 1000);
+    runSize(256, 25, 1000, 200, 1000);
+    runSize(2048, 10, 200, 10, 1000);
+    runSize(2048, 25, 200, 10, 1000);
+    return 0;
+}
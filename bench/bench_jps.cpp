@@ -0,0 +1,131 @@
+// Jump Point Search against the binary-heap A* on random asteroid grids, both
+// scattered cells and round asteroid fields: expansions, time per query and
+// whether both return walkable paths of equal cost.
+//
+// Build: g++ -O2 -I. bench/bench_jps.cpp pathfinding.cpp space_grid.cpp -o bench_jps
+// Usage: bench_jps [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "pathfinding.h"
+
+static unsigned int xorshiftState = 2463534242u;
+
+static inline unsigned int xorshift(void) {
+    xorshiftState ^= xorshiftState << 13;
+    xorshiftState ^= xorshiftState >> 17;
+    xorshiftState ^= xorshiftState << 5;
+    return xorshiftState;
+}
+
+static double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Every step is one of the eight moves, onto a free cell, obeying the corner rule
+static bool validPath(const SpaceGrid* grid, const Point* path, int length, float* cost) {
+    *cost = 0.0f;
+    for (int i = 0; i < length; i++) {
+        if (spaceGridBlocked(grid, path[i].x, path[i].y)) return false;
+        if (i == 0) continue;
+        int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        if (abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0)) return false;
+        if (dx != 0 && dy != 0 && (spaceGridBlocked(grid, path[i - 1].x + dx, path[i - 1].y) ||
+            spaceGridBlocked(grid, path[i - 1].x, path[i - 1].y + dy))) return false;
+        *cost += dx != 0 && dy != 0 ? 1.414f : 1.0f;
+    }
+    return true;
+}
+
+// Scattered single cells, or round asteroid fields until the density is reached
+static void fillGrid(SpaceGrid* grid, int size, int density, bool clustered) {
+    if (!clustered) {
+        for (int y = 0; y < size; y++)
+            for (int x = 0; x < size; x++)
+                spaceGridSet(grid, x, y, xorshift() % 100 < (unsigned int)density);
+        return;
+    }
+    long long target = (long long)size * size * density / 100, blocked = 0;
+    while (blocked < target) {
+        int cx = xorshift() % size, cy = xorshift() % size, r = 1 + xorshift() % 5;
+        for (int y = cy - r; y <= cy + r; y++)
+            for (int x = cx - r; x <= cx + r; x++)
+                if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r && spaceGridInBounds(grid, x, y) && !spaceGridBlocked(grid, x, y)) {
+                    spaceGridSet(grid, x, y, true);
+                    blocked++;
+                }
+    }
+}
+
+static void runSize(int size, int density, bool clustered, int queries) {
+    SpaceGrid grid;
+    spaceGridInit(&grid, size, size);
+    fillGrid(&grid, size, density, clustered);
+
+    // Free endpoints anywhere on the map
+    int* endpoints = (int*)malloc(queries * 4 * sizeof(int));
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        do { e[0] = xorshift() % size; e[1] = xorshift() % size; } while (spaceGridBlocked(&grid, e[0], e[1]));
+        do { e[2] = xorshift() % size; e[3] = xorshift() % size; } while (spaceGridBlocked(&grid, e[2], e[3]));
+    }
+
+    PathSearchContext ctx;
+    pathSearchInit(&ctx, size, size);
+    Point* path = (Point*)malloc((size_t)size * size * sizeof(Point));
+    float* astarCost = (float*)malloc(queries * sizeof(float));
+    long long astarExpanded = 0, jpsExpanded = 0;
+    int found = 0, agree = 0, valid = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        astarCost[q] = pathSearchFind(&ctx, &grid, e[0], e[1], e[2], e[3], path, size * size) >= 0 ? ctx.pathCost : -1.0f;
+        astarExpanded += ctx.nodesExpanded;
+        found += astarCost[q] >= 0;
+    }
+    double astarUs = elapsedUs(t0) / queries;
+
+    t0 = std::chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        pathSearchFindJPS(&ctx, &grid, e[0], e[1], e[2], e[3], path, size * size);
+        jpsExpanded += ctx.nodesExpanded;
+    }
+    double jpsUs = elapsedUs(t0) / queries;
+
+    // Check pass: same reachability, same cost, and a walkable path
+    for (int q = 0; q < queries; q++) {
+        int* e = &endpoints[q * 4];
+        int length = pathSearchFindJPS(&ctx, &grid, e[0], e[1], e[2], e[3], path, size * size);
+        float jpsCost = length >= 0 ? ctx.pathCost : -1.0f;
+        if ((length >= 0) == (astarCost[q] >= 0) && fabsf(jpsCost - astarCost[q]) <= 1e-3f * (1.0f + fabsf(astarCost[q]))) agree++;
+        float walked;
+        if (length < 0 || (validPath(&grid, path, length, &walked) && path[0].x == e[0] && path[0].y == e[1] &&
+            path[length - 1].x == e[2] && path[length - 1].y == e[3] && fabsf(walked - jpsCost) < 1e-3f * (1.0f + walked))) valid++;
+    }
+
+    printf("grid=%dx%d density=%d layout=%s queries=%d found=%d astar_expanded=%lld jps_expanded=%lld astar_us=%.2f jps_us=%.2f speedup=%.2fx agree=%d/%d valid=%d/%d\n",
+        size, size, density, clustered ? "fields" : "scatter", queries, found, astarExpanded / queries, jpsExpanded / queries,
+        astarUs, jpsUs, astarUs / jpsUs, agree, queries, valid, queries);
+
+    free(astarCost); free(path); free(endpoints);
+    pathSearchFree(&ctx);
+    spaceGridFree(&grid);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) xorshiftState = (unsigned int)strtoul(argv[1], NULL, 10) | 1u;
+    for (int clustered = 0; clustered < 2; clustered++) {
+        runSize(15, 20, clustered, 20000);
+        runSize(15, 35, clustered, 20000);
+        runSize(64, 20, clustered, 2000);
+        runSize(256, 10, clustered, 200);
+        runSize(256, 25, clustered, 200);
+        runSize(1024, 10, clustered, 20);
+        runSize(1024, 25, clustered, 20);
+    }
+    return 0;
+}
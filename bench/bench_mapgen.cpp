@@ -0,0 +1,77 @@
+// Map generation statistics: generates maps per difficulty and grid size and
+// reports latency percentiles, validation rejects, guaranteed-path fallbacks
+// and coins placed against the difficulty's target. One key=value line per
+// size and difficulty, so runs can be diffed or parsed.
+//
+// Build: g++ -O2 -I. bench/bench_mapgen.cpp game_world.cpp pathfinding.cpp bitboard.cpp space_grid.cpp spatial_hash.cpp -o bench_mapgen -pthread
+// Usage: bench_mapgen [maps] [seed] [size...]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include "game_world.h"
+
+static const char* difficultyNames[3] = { "easy", "medium", "hard" };
+
+static double percentile(const double* sorted, int count, double p) {
+    int index = (int)(p * (count - 1) + 0.5);
+    return sorted[index];
+}
+
+static void runSize(int size, int maps, uint64_t seed) {
+    MapLayout map;
+    mapLayoutInit(&map, size, size);
+    double* micros = (double*)malloc(maps * sizeof(double));
+    RngStream seeds;
+    rngSeed(&seeds, rngDeriveSeed(seed, size));
+
+    for (int d = 0; d < 3; d++) {
+        DifficultyLevel difficulty = (DifficultyLevel)d;
+        long long attempts = 0, rejects = 0, coinsPlaced = 0, coinsShort = 0;
+        int fallbacks = 0;
+        double total = 0.0;
+
+        for (int i = 0; i < maps; i++) {
+            auto t0 = std::chrono::steady_clock::now();
+            generateEnvironment(&map, difficulty, false, rngNext(&seeds));
+            micros[i] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            total += micros[i];
+
+            // Attempts are numbered from 0; every one before the winner failed validation
+            if (map.attempt < 0) { fallbacks++; attempts += MAP_GEN_MAX_ATTEMPTS; rejects += MAP_GEN_MAX_ATTEMPTS; }
+            else { attempts += map.attempt + 1; rejects += map.attempt; }
+            coinsPlaced += map.totalCoins;
+            if (map.totalCoins < coinsForDifficulty(difficulty)) coinsShort++;
+        }
+
+        std::sort(micros, micros + maps);
+        int successes = maps - fallbacks;
+        printf("grid=%dx%d difficulty=%s maps=%d mean_us=%.1f p50_us=%.1f p90_us=%.1f p99_us=%.1f max_us=%.1f "
+            "attempts_per_map=%.2f attempts_per_success=%.2f reject_rate=%.3f fallback_rate=%.3f "
+            "coins_requested=%d coins_mean=%.2f coins_short_rate=%.3f\n",
+            map.grid.width, map.grid.height, difficultyNames[d], maps, total / maps,
+            percentile(micros, maps, 0.50), percentile(micros, maps, 0.90), percentile(micros, maps, 0.99), micros[maps - 1],
+            (double)attempts / maps, successes > 0 ? (double)(attempts - (long long)fallbacks * MAP_GEN_MAX_ATTEMPTS) / successes : 0.0,
+            (double)rejects / attempts, (double)fallbacks / maps,
+            coinsForDifficulty(difficulty), (double)coinsPlaced / maps, (double)coinsShort / maps);
+    }
+    free(micros);
+    mapLayoutFree(&map);
+}
+
+int main(int argc, char** argv) {
+    int maps = argc > 1 ? atoi(argv[1]) : 500;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    if (maps < 1) maps = 1;
+    printf("maps=%d seed=%llu max_attempts=%d\n", maps, (unsigned long long)seed, MAP_GEN_MAX_ATTEMPTS);
+
+    if (argc > 3) {
+        for (int i = 3; i < argc; i++) runSize(atoi(argv[i]), maps, seed);
+    }
+    else {
+        const int sizes[] = { 15, 32, 64, 128 };
+        for (int i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) runSize(sizes[i], maps, seed);
+    }
+    return 0;
+}
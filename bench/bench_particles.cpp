@@ -0,0 +1,108 @@
+// Ambient particle cost per tick: the structure-of-arrays system against the
+// array of structs it replaced, which called libm sin/cos per particle and
+// drew respawn values inline. Emit (bin and write the vertices a frame draws)
+// is timed separately from the update.
+//
+// Build: g++ -O2 -I. bench/bench_particles.cpp particles.cpp job_system.cpp -o bench_particles -pthread
+// Usage: bench_particles [ticks] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "particles.h"
+
+#define WIDTH 800.0f
+#define HEIGHT 800.0f
+
+typedef struct {
+    float x, y; float vx, vy; float size; float alpha; float color[3];
+    float lifespan; float age;
+} Particle;
+
+static double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// The removed update loop, kept here as the baseline
+static void structUpdate(Particle* particles, int count, float time, RngStream* rng) {
+    for (int i = 0; i < count; i++) {
+        Particle* p = &particles[i];
+        p->age += 0.5f;
+        if (p->age >= p->lifespan) {
+            if (rngRange(rng, 2) == 0) {
+                p->x = rngRange(rng, 2) == 0 ? 0 : WIDTH;
+                p->y = rngRange(rng, (int)HEIGHT);
+                p->vx = p->x == 0 ? (0.2f + rngRange(rng, 20) / 100.0f) : -(0.2f + rngRange(rng, 20) / 100.0f);
+                p->vy = (float)(rngRange(rng, 60) - 30) / 300.0f;
+            }
+            else {
+                p->y = rngRange(rng, 2) == 0 ? 0 : HEIGHT;
+                p->x = rngRange(rng, (int)WIDTH);
+                p->vy = p->y == 0 ? (0.2f + rngRange(rng, 20) / 100.0f) : -(0.2f + rngRange(rng, 20) / 100.0f);
+                p->vx = (float)(rngRange(rng, 60) - 30) / 300.0f;
+            }
+            p->size = 1.0f + rngRange(rng, 30) / 10.0f;
+            p->color[0] = 0.1f + rngRange(rng, 30) / 100.0f;
+            p->color[1] = 0.2f + rngRange(rng, 40) / 100.0f;
+            p->color[2] = 0.5f + rngRange(rng, 50) / 100.0f;
+            p->alpha = 0.1f + rngRange(rng, 40) / 100.0f;
+            p->age = 0; p->lifespan = 50.0f + rngRange(rng, 100);
+        }
+        p->x += p->vx + sin(time + p->y * 0.01f) * 0.2f;
+        p->y += p->vy + cos(time + p->x * 0.01f) * 0.2f;
+    }
+}
+
+static void runCount(int count, int ticks, uint64_t seed) {
+    ParticleSystem ps;
+    particleSystemInit(&ps, count, WIDTH, HEIGHT, seed);
+    RngStream rng;
+    rngSeed(&rng, seed);
+    Particle* particles = (Particle*)calloc(count, sizeof(Particle));
+    for (int i = 0; i < count; i++) {
+        particles[i].x = ps.x[i]; particles[i].y = ps.y[i];
+        particles[i].vx = ps.vx[i]; particles[i].vy = ps.vy[i];
+        particles[i].age = ps.age[i]; particles[i].lifespan = ps.lifespan[i];
+    }
+
+    double updateUs = 0.0, emitUs = 0.0, structUs = 0.0, worstUs = 0.0;
+    long long respawned = 0;
+    for (int t = 0; t < ticks; t++) {
+        float time = t * 0.1f;
+        auto t0 = std::chrono::steady_clock::now();
+        particleSystemUpdate(&ps, time, NULL);
+        double us = elapsedUs(t0);
+        updateUs += us;
+        if (us > worstUs) worstUs = us;
+        respawned += ps.deadCount;
+
+        t0 = std::chrono::steady_clock::now();
+        particleSystemEmit(&ps, time, 1.0f, NULL);
+        emitUs += elapsedUs(t0);
+
+        t0 = std::chrono::steady_clock::now();
+        structUpdate(particles, count, time, &rng);
+        structUs += elapsedUs(t0);
+    }
+
+    // Keeps the baseline from being optimised away
+    double checksum = 0.0;
+    for (int i = 0; i < count; i++) checksum += particles[i].x + ps.vertices[i].x;
+
+    printf("particles=%d ticks=%d respawns_per_tick=%.1f update_us=%.1f worst_update_us=%.1f emit_us=%.1f "
+        "struct_update_us=%.1f speedup=%.1fx checksum=%.0f\n",
+        count, ticks, (double)respawned / ticks, updateUs / ticks, worstUs, emitUs / ticks,
+        structUs / ticks, structUs / updateUs, checksum);
+
+    free(particles);
+    particleSystemFree(&ps);
+}
+
+int main(int argc, char** argv) {
+    int ticks = argc > 1 ? atoi(argv[1]) : 500;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    const int counts[] = { 120, 1000, 10000, 100000 };
+    for (int i = 0; i < (int)(sizeof(counts) / sizeof(counts[0])); i++) runCount(counts[i], ticks, seed);
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Frame profiler overhead. Times an empty scoped timer, closing a frame with
+// and without a CSV row, and summarizing the history for the overlay. Then
+// runs frames of busy-wait passes with known lengths and checks that the
+// percentiles and the CSV report them back.
+//
+// Build: g++ -O2 -I. bench/bench_profiler.cpp frame_profiler.cpp -o bench_profiler -pthread
+// Usage: bench_profiler [frames] [csv path]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "frame_profiler.h"
+
+#define SCOPE_ROUNDS 1000000
+#define PASSES 14               // As many as the game profiles
+#define SUMMARY_ROUNDS 1000
+
+static const char* names[PASSES] = { "p0", "p1", "p2", "p3", "p4", "p5", "p6", "p7", "p8", "p9", "p10", "p11", "p12", "p13" };
+
+static void spin(int64_t ns) {
+    int64_t until = clockNowNs() + ns;
+    while (clockNowNs() < until) {}
+}
+
+static double nsPer(int64_t since, int rounds) {
+    return (clockNowNs() - since) / (double)rounds;
+}
+
+int main(int argc, char** argv) {
+    int frames = argc > 1 ? atoi(argv[1]) : 2000;
+    const char* csvPath = argc > 2 ? argv[2] : "bench_profile.csv";
+    static FrameProfiler profiler;
+    frameProfilerInit(&profiler, names, PASSES);
+
+    int64_t start = clockNowNs();
+    for (int i = 0; i < SCOPE_ROUNDS; i++) ProfileScope scope(&profiler, i % PASSES);
+    double scopeNs = nsPer(start, SCOPE_ROUNDS);
+
+    start = clockNowNs();
+    for (int i = 0; i < SCOPE_ROUNDS; i++) frameProfilerEndFrame(&profiler);
+    double endNs = nsPer(start, SCOPE_ROUNDS);
+
+    if (!frameProfilerStartCsv(&profiler, csvPath)) { printf("cannot write %s\n", csvPath); return 1; }
+    start = clockNowNs();
+    for (int i = 0; i < SCOPE_ROUNDS / 10; i++) frameProfilerEndFrame(&profiler);
+    double csvNs = nsPer(start, SCOPE_ROUNDS / 10);
+    frameProfilerStopCsv(&profiler);
+
+    ProfileSummary summary;
+    start = clockNowNs();
+    for (int i = 0; i < SUMMARY_ROUNDS; i++) frameProfilerSummarize(&profiler, &summary);
+    double summaryUs = nsPer(start, SUMMARY_ROUNDS) * 1e-3;
+    printf("scope_ns=%.1f end_frame_ns=%.1f end_frame_csv_ns=%.1f summarize_us=%.1f per_frame_overhead_us=%.2f\n",
+        scopeNs, endNs, csvNs, summaryUs, (PASSES * scopeNs + csvNs) * 1e-3);
+
+    // Pass i takes (i + 1) * 20us; every 50th frame pass 0 takes 1ms instead
+    frameProfilerInit(&profiler, names, PASSES);
+    frameProfilerStartCsv(&profiler, csvPath);
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < PASSES; i++) {
+            ProfileScope scope(&profiler, i);
+            spin(i == 0 && f % 50 == 0 ? 1000000 : (i + 1) * 20000);
+            profiler.draws += 3;
+            profiler.vertices += 12;
+        }
+        frameProfilerEndFrame(&profiler);
+    }
+    frameProfilerStopCsv(&profiler);
+    frameProfilerSummarize(&profiler, &summary);
+    double worstError = 0.0;
+    for (int i = 1; i < PASSES; i++) worstError = fmax(worstError, fabs(summary.pass[i].p50 - (i + 1) * 20.0f) / ((i + 1) * 20.0f));
+    printf("frames=%d history=%d pass0_p50_us=%.1f pass0_p99_us=%.1f pass0_max_us=%.1f work_p50_us=%.1f draws_p50=%.0f "
+        "vertices_p50=%.0f worst_p50_error=%.1f%%\n", frames, summary.frames, summary.pass[0].p50, summary.pass[0].p99,
+        summary.pass[0].max, summary.work.p50, summary.draws.p50, summary.vertices.p50, worstError * 100.0);
+
+    // Read the CSV back: one header and one row per frame
+    FILE* csv = fopen(csvPath, "r");
+    int lines = 0, ch;
+    while (csv && (ch = fgetc(csv)) != EOF) lines += ch == '\n';
+    if (csv) fclose(csv);
+    printf("csv=%s rows=%d expected=%d\n", csvPath, lines - 1, frames);
+    remove(csvPath);
+    frameProfilerFree(&profiler);
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Map difficulty ratings. First checks the model against the game: on a
+// sample of maps per difficulty the solved route is played through
+// gameWorldStep one move every 1 / pace seconds, a little faster than the
+// required pace (must win) and a little slower (must lose). Then rates maps
+// from consecutive seeds on the job system and reports, per difficulty, the
+// spread over tiers, pace percentiles and how many maps fall outside the
+// difficulty's band, next to rating throughput on one thread and on all.
+//
+// Build: g++ -O2 -I. bench/bench_rating.cpp map_rating.cpp coin_route.cpp job_system.cpp game_world.cpp pathfinding.cpp bitboard.cpp space_grid.cpp spatial_hash.cpp -o bench_rating -pthread
+// Usage: bench_rating [maps per difficulty] [seed] [threads]
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "map_rating.h"
+
+#define CHECK_MAPS 2000
+#define CHECK_MARGIN 0.03f      // Paces played either side of the required one
+#define CHUNK_MAPS 65536        // Ratings held at once
+#define PACE_BUCKETS 4096       // Histogram for percentiles, in PACE_BUCKET_WIDTH steps
+#define PACE_BUCKET_WIDTH 0.005f
+
+static const char* difficultyNames[3] = { "easy", "medium", "hard" };
+
+static double secondsSince(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Plays path with one move every 1 / pace seconds; true on a win
+static bool playAtPace(GameWorld* world, DifficultyLevel difficulty, const Point* path, int length, float pace) {
+    gameWorldStartGame(world, difficulty);
+    for (int i = 1; i < length && world->state == GAME_PLAYING; i++) {
+        int due = (int)floorf(i * (float)SIM_TICKS_PER_SECOND / pace);
+        while (world->tickCount < due && world->state == GAME_PLAYING) gameWorldStep(world, NULL, SIM_TICK_SECONDS);
+        if (world->state != GAME_PLAYING) break;
+        int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        GameInput input = { dx > 0 ? MOVE_RIGHT : dx < 0 ? MOVE_LEFT : dy > 0 ? MOVE_DOWN : MOVE_UP };
+        gameWorldStep(world, &input, 0.0f);
+    }
+    return world->state == GAME_WIN;
+}
+
+static void checkModel(DifficultyLevel difficulty, uint64_t seed) {
+    GameWorld world;
+    gameWorldInit(&world, difficulty, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, seed);
+    MapRater rater;
+    mapRaterInit(&rater, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT);
+    std::vector<Point> path;
+    int checked = 0, fastLosses = 0, slowWins = 0;
+    for (int m = 0; m < CHECK_MAPS; m++) {
+        generateEnvironment(&world.map, difficulty, false, rngDeriveSeed(seed, m));
+        MapRating rating = mapRate(&rater, &world.map, difficulty);
+        if (rating.moves < 0 || !isfinite(rating.requiredPace)) continue;
+        path.resize(rating.moves + 1);
+        int length = coinRoutePath(&rater.solver, path.data(), (int)path.size());
+        checked++;
+        fastLosses += !playAtPace(&world, difficulty, path.data(), length, rating.requiredPace * (1.0f + CHECK_MARGIN));
+        slowWins += playAtPace(&world, difficulty, path.data(), length, rating.requiredPace * (1.0f - CHECK_MARGIN));
+    }
+    printf("check difficulty=%s maps=%d path_walks=%d fast_losses=%d slow_wins=%d\n", difficultyNames[difficulty], checked,
+        rater.walks, fastLosses, slowWins);
+    mapRaterFree(&rater);
+    gameWorldFree(&world);
+}
+
+// Rates maps seeds in chunks; fills the summary counters and returns seconds
+static double rateAll(JobSystem* jobs, DifficultyLevel difficulty, uint64_t seed, int64_t maps, std::vector<MapRating>* chunk,
+    long long* tiers, long long* paces, long long* lightBound, long long* inBand, double* moves, double* timeSlack) {
+    RatingBand band = ratingBandForDifficulty(difficulty);
+    double seconds = 0.0;
+    for (int64_t first = 0; first < maps; first += CHUNK_MAPS) {
+        int count = (int)std::min<int64_t>(CHUNK_MAPS, maps - first);
+        auto start = std::chrono::steady_clock::now();
+        mapRateSeeds(jobs, difficulty, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, seed, first, count, chunk->data());
+        seconds += secondsSince(start);
+        if (!tiers) continue;
+        for (int i = 0; i < count; i++) {
+            const MapRating* r = &(*chunk)[i];
+            tiers[r->tier]++;
+            *inBand += ratingInBand(r, band);
+            if (r->moves < 0) continue;
+            int bucket = isfinite(r->requiredPace) ? (int)(r->requiredPace / PACE_BUCKET_WIDTH) : PACE_BUCKETS - 1;
+            paces[std::min(bucket, PACE_BUCKETS - 1)]++;
+            *lightBound += r->lightBound;
+            *moves += r->moves;
+            *timeSlack += r->timeSlack;
+        }
+    }
+    return seconds;
+}
+
+static float pacePercentile(const long long* paces, long long total, double p) {
+    long long want = (long long)(p * (total - 1)), seen = 0;
+    for (int b = 0; b < PACE_BUCKETS; b++) {
+        seen += paces[b];
+        if (seen > want) return (b + 0.5f) * PACE_BUCKET_WIDTH;
+    }
+    return INFINITY;
+}
+
+int main(int argc, char** argv) {
+    int64_t maps = argc > 1 ? atoll(argv[1]) : 200000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    int threads = argc > 3 ? atoi(argv[3]) : 0;
+
+    for (int d = 0; d < 3; d++) checkModel((DifficultyLevel)d, seed + d);
+
+    JobSystem jobs;
+    jobSystemStart(&jobs, threads);
+    std::vector<MapRating> chunk(CHUNK_MAPS);
+    std::vector<long long> paces(PACE_BUCKETS);
+    for (int d = 0; d < 3; d++) {
+        DifficultyLevel difficulty = (DifficultyLevel)d;
+        long long tiers[RATING_TIER_COUNT] = {}, lightBound = 0, inBand = 0;
+        double moves = 0.0, timeSlack = 0.0;
+        std::fill(paces.begin(), paces.end(), 0);
+        double seconds = rateAll(&jobs, difficulty, seed, maps, &chunk, tiers, paces.data(), &lightBound, &inBand, &moves,
+            &timeSlack);
+        // The same maps on the calling thread alone, capped to keep the run short
+        int64_t serialMaps = std::min<int64_t>(maps, CHUNK_MAPS);
+        double serialSeconds = rateAll(NULL, difficulty, seed, serialMaps, &chunk, NULL, NULL, NULL, NULL, NULL, NULL);
+
+        long long solved = 0;
+        for (int b = 0; b < PACE_BUCKETS; b++) solved += paces[b];
+        RatingBand band = ratingBandForDifficulty(difficulty);
+        printf("difficulty=%s maps=%lld threads=%d maps_per_sec=%.0f serial_maps_per_sec=%.0f speedup=%.2fx us_per_map=%.1f\n",
+            difficultyNames[d], (long long)maps, jobs.threadCount, maps / seconds, serialMaps / serialSeconds,
+            (maps / seconds) / (serialMaps / serialSeconds), serialSeconds * 1e6 / serialMaps);
+        printf("  tiers");
+        for (int t = 0; t < RATING_TIER_COUNT; t++) printf(" %s=%.2f%%", ratingTierName((RatingTier)t), tiers[t] * 100.0 / maps);
+        printf("\n  pace_p10=%.2f pace_p50=%.2f pace_p90=%.2f pace_p99=%.2f light_bound=%.1f%% avg_moves=%.1f "
+            "avg_time_slack=%.1fs band=%s..%s out_of_band=%.2f%%\n",
+            pacePercentile(paces.data(), solved, 0.1), pacePercentile(paces.data(), solved, 0.5),
+            pacePercentile(paces.data(), solved, 0.9), pacePercentile(paces.data(), solved, 0.99),
+            solved ? lightBound * 100.0 / solved : 0.0, solved ? moves / solved : 0.0, solved ? timeSlack / solved : 0.0,
+            ratingTierName(band.easiest), ratingTierName(band.hardest), (maps - inBand) * 100.0 / maps);
+    }
+    jobSystemStop(&jobs);
+    return 0;
+}
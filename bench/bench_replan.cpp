@@ -0,0 +1,154 @@
+// Incremental replanning on drifting asteroid fields: an agent walks to the
+// goal while asteroids move every tick. Each tick the D* Lite planner repairs
+// its plan and, for comparison, A* plans again from scratch. Reports nodes
+// touched per repair against A* expansions, time per tick and whether both
+// agree on the path cost.
+//
+// Build: g++ -O2 -I. bench/bench_replan.cpp dstar_lite.cpp pathfinding.cpp space_grid.cpp -o bench_replan
+// Usage: bench_replan [seed] [moves per tick]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "dstar_lite.h"
+#include "pathfinding.h"
+
+static unsigned int xorshiftState = 2463534242u;
+
+static inline unsigned int xorshift(void) {
+    xorshiftState ^= xorshiftState << 13;
+    xorshiftState ^= xorshiftState >> 17;
+    xorshiftState ^= xorshiftState << 5;
+    return xorshiftState;
+}
+
+static double elapsedUs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Every step is one of the eight moves, onto a free cell, obeying the corner rule
+static bool validPath(const SpaceGrid* grid, const Point* path, int length, float* cost) {
+    *cost = 0.0f;
+    for (int i = 0; i < length; i++) {
+        if (spaceGridBlocked(grid, path[i].x, path[i].y)) return false;
+        if (i == 0) continue;
+        int dx = path[i].x - path[i - 1].x, dy = path[i].y - path[i - 1].y;
+        if (abs(dx) > 1 || abs(dy) > 1 || (dx == 0 && dy == 0)) return false;
+        if (dx != 0 && dy != 0 && (spaceGridBlocked(grid, path[i - 1].x + dx, path[i - 1].y) ||
+            spaceGridBlocked(grid, path[i - 1].x, path[i - 1].y + dy))) return false;
+        *cost += dx != 0 && dy != 0 ? 1.414f : 1.0f;
+    }
+    return true;
+}
+
+// Round asteroid fields until the density is reached
+static void fillGrid(SpaceGrid* grid, int size, int density) {
+    long long target = (long long)size * size * density / 100, blocked = 0;
+    while (blocked < target) {
+        int cx = xorshift() % size, cy = xorshift() % size, r = 1 + xorshift() % 3;
+        for (int y = cy - r; y <= cy + r; y++)
+            for (int x = cx - r; x <= cx + r; x++)
+                if ((x - cx) * (x - cx) + (y - cy) * (y - cy) <= r * r && spaceGridInBounds(grid, x, y) && !spaceGridBlocked(grid, x, y)) {
+                    spaceGridSet(grid, x, y, true);
+                    blocked++;
+                }
+    }
+}
+
+// Moves one asteroid cell a step in a random direction, half the time near the
+// agent where it matters. Writes the changed cells and returns how many.
+static int driftAsteroid(SpaceGrid* grid, int size, int agentX, int agentY, int goalX, int goalY, int* changed) {
+    for (int tries = 0; tries < 64; tries++) {
+        int x, y;
+        if (xorshift() & 1) { x = agentX - 16 + (int)(xorshift() % 33); y = agentY - 16 + (int)(xorshift() % 33); }
+        else { x = xorshift() % size; y = xorshift() % size; }
+        int nx = x + (int)(xorshift() % 3) - 1, ny = y + (int)(xorshift() % 3) - 1;
+        if (!spaceGridInBounds(grid, x, y) || !spaceGridBlocked(grid, x, y) || spaceGridBlocked(grid, nx, ny)) continue;
+        if ((nx == agentX && ny == agentY) || (nx == goalX && ny == goalY)) continue;
+        spaceGridSet(grid, x, y, false);
+        spaceGridSet(grid, nx, ny, true);
+        changed[0] = x; changed[1] = y; changed[2] = nx; changed[3] = ny;
+        return 2;
+    }
+    return 0;
+}
+
+static void runSize(int size, int density, int movesPerTick) {
+    SpaceGrid grid;
+    spaceGridInit(&grid, size, size);
+    fillGrid(&grid, size, density);
+
+    // Corner to corner, on free cells
+    int startX = 1, startY = 1, goalX = size - 2, goalY = size - 2;
+    spaceGridSet(&grid, startX, startY, false);
+    spaceGridSet(&grid, goalX, goalY, false);
+
+    DStarPlanner planner;
+    dstarInit(&planner, size, size);
+    PathSearchContext ctx;
+    pathSearchInit(&ctx, size, size);
+    Point* path = (Point*)malloc((size_t)size * size * sizeof(Point));
+    int* changed = (int*)malloc(movesPerTick * 4 * sizeof(int));
+
+    dstarReset(&planner, startX, startY, goalX, goalY);
+    auto t0 = std::chrono::steady_clock::now();
+    dstarPlan(&planner, &grid);
+    double initialUs = elapsedUs(t0);
+    int initialTouched = planner.nodesTouched;
+
+    int agentX = startX, agentY = startY, ticks = 0, agree = 0, valid = 0;
+    long long touched = 0, expanded = 0, astarExpanded = 0;
+    double dstarUs = 0.0, astarUs = 0.0;
+    while ((agentX != goalX || agentY != goalY) && ticks < size * 4) {
+        // Step along the current plan
+        int length = dstarPath(&planner, &grid, path, 2);
+        if (length >= 2) { agentX = path[1].x; agentY = path[1].y; }
+
+        int changes = 0;
+        for (int m = 0; m < movesPerTick; m++)
+            changes += driftAsteroid(&grid, size, agentX, agentY, goalX, goalY, &changed[changes * 2]);
+
+        t0 = std::chrono::steady_clock::now();
+        dstarMoveStart(&planner, agentX, agentY);
+        for (int c = 0; c < changes; c++) dstarCellChanged(&planner, &grid, changed[c * 2], changed[c * 2 + 1]);
+        bool reachable = dstarPlan(&planner, &grid);
+        dstarUs += elapsedUs(t0);
+        touched += planner.nodesTouched;
+        expanded += planner.nodesExpanded;
+
+        t0 = std::chrono::steady_clock::now();
+        int astarLength = pathSearchFind(&ctx, &grid, agentX, agentY, goalX, goalY, NULL, 0);
+        astarUs += elapsedUs(t0);
+        astarExpanded += ctx.nodesExpanded;
+
+        float cost = dstarPathCost(&planner);
+        if ((astarLength >= 0) == reachable && (!reachable || fabsf(cost - ctx.pathCost) <= 1e-3f * (1.0f + cost))) agree++;
+        length = dstarPath(&planner, &grid, path, size * size);
+        float walked;
+        if (!reachable || (length > 0 && validPath(&grid, path, length, &walked) && fabsf(walked - cost) <= 1e-3f * (1.0f + cost))) valid++;
+        ticks++;
+    }
+
+    printf("grid=%dx%d density=%d moves_per_tick=%d ticks=%d reached=%d initial_touched=%d initial_us=%.1f "
+        "dstar_touched=%lld dstar_expanded=%lld astar_expanded=%lld dstar_us=%.1f astar_us=%.1f speedup=%.2fx agree=%d/%d valid=%d/%d\n",
+        size, size, density, movesPerTick, ticks, agentX == goalX && agentY == goalY, initialTouched, initialUs,
+        touched / ticks, expanded / ticks, astarExpanded / ticks, dstarUs / ticks, astarUs / ticks, astarUs / dstarUs,
+        agree, ticks, valid, ticks);
+
+    free(changed); free(path);
+    pathSearchFree(&ctx);
+    dstarFree(&planner);
+    spaceGridFree(&grid);
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) xorshiftState = (unsigned int)strtoul(argv[1], NULL, 10) | 1u;
+    int movesPerTick = argc > 2 ? atoi(argv[2]) : 4;
+    if (movesPerTick < 1) movesPerTick = 1;
+    runSize(15, 20, movesPerTick);
+    runSize(64, 20, movesPerTick);
+    runSize(256, 20, movesPerTick);
+    runSize(512, 20, movesPerTick);
+    return 0;
+}
@@ -0,0 +1,165 @@
+// Replay recording and verification. Bots play games through the normal
+// recording calls: they mostly walk A* paths to the nearest coin and then the
+// exit, sometimes wander, make zero to three moves per tick and idle for long
+// stretches. Every replay is encoded, decoded and verified headlessly against
+// its recording, first on one thread and then on all cores. Files given on
+// the command line (e.g. last_game.clwr from the game) are verified instead.
+//
+// Build: g++ -O2 -I. bench/bench_replay.cpp replay.cpp job_system.cpp game_world.cpp pathfinding.cpp bitboard.cpp space_grid.cpp spatial_hash.cpp -o bench_replay -pthread
+// Usage: bench_replay [games] [seed] | bench_replay file.clwr...
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "replay.h"
+#include "pathfinding.h"
+
+static double secondsSince(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static MoveDirection stepToward(int x, int y, const Point* next) {
+    if (next->x > x) return MOVE_RIGHT;
+    if (next->x < x) return MOVE_LEFT;
+    return next->y > y ? MOVE_DOWN : MOVE_UP;
+}
+
+// Next move along a 4-way path to the nearest active coin, or the exit once
+// all are collected; random when there is no path
+static MoveDirection botMove(const GameWorld* world, PathSearchContext* ctx, Point* path, RngStream* rng) {
+    if (rngRange(rng, 5) == 0) return (MoveDirection)(MOVE_UP + rngRange(rng, 4));
+    int x = (int)world->player.x, y = (int)world->player.y;
+    int goalX = (int)world->map.exitX, goalY = (int)world->map.exitY, best = -1;
+    for (int i = 0; i < world->map.totalCoins; i++) {
+        const Coin* coin = &world->map.coins[i];
+        if (!coin->active) continue;
+        int d = abs((int)coin->x - x) + abs((int)coin->y - y);
+        if (best < 0 || d < best) { best = d; goalX = (int)coin->x; goalY = (int)coin->y; }
+    }
+    int length = pathSearchFind(ctx, &world->map.grid, x, y, goalX, goalY, path, world->map.grid.width * world->map.grid.height);
+    if (length < 2) return (MoveDirection)(MOVE_UP + rngRange(rng, 4));
+    // Diagonal steps are taken as two straight moves; the first may be blocked
+    Point next = path[1];
+    if (next.x != x && next.y != y) {
+        Point across = { next.x, y };
+        if (!gameWorldIsValidMove(world, across.x + 0.5f, across.y + 0.5f)) across.x = x, across.y = next.y;
+        next = across;
+    }
+    return stepToward(x, y, &next);
+}
+
+static void recordGame(GameWorld* world, Replay* replay, DifficultyLevel difficulty, PathSearchContext* ctx, Point* path, RngStream* rng) {
+    gameWorldNewGame(world, difficulty);
+    replayBegin(replay, world);
+    while (world->state == GAME_PLAYING) {
+        int moves = rngRange(rng, 8) == 0 ? 0 : 1 + rngRange(rng, 3);
+        for (int m = 0; m < moves && world->state == GAME_PLAYING; m++) {
+            GameInput input = { botMove(world, ctx, path, rng) };
+            replayRecordInput(replay, world, input.move);
+            gameWorldStep(world, &input, 0.0f);
+        }
+        // Occasionally idle for a while
+        int idle = rngRange(rng, 40) == 0 ? 5 + rngRange(rng, 80) : 1;
+        for (int t = 0; t < idle && world->state == GAME_PLAYING; t++) gameWorldStep(world, NULL, SIM_TICK_SECONDS);
+    }
+    replayFinish(replay, world);
+}
+
+static const char* resultNames[] = { "menu", "playing", "win", "lose" };
+
+static int verifyFiles(int count, char** paths) {
+    int failures = 0;
+    GameWorld world;
+    gameWorldInit(&world, DIFFICULTY_MEDIUM, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, 0);
+    for (int i = 0; i < count; i++) {
+        Replay replay;
+        replayInit(&replay);
+        if (!replayLoad(&replay, paths[i])) {
+            printf("file=%s status=unreadable\n", paths[i]);
+            failures++;
+            continue;
+        }
+        ReplayCheck check = replaySimulate(&world, &replay);
+        printf("file=%s seed=%llu difficulty=%d grid=%dx%d inputs=%d recorded=%s/%ds/%dc replayed=%s/%ds/%dc status=%s\n",
+            paths[i], (unsigned long long)replay.mapSeed, replay.difficulty, replay.width, replay.height, replay.inputCount,
+            resultNames[replay.result], replay.gameTime, replay.coinsCollected, resultNames[check.result], check.gameTime,
+            check.coinsCollected, check.matches ? "match" : "MISMATCH");
+        failures += !check.matches;
+        replayFree(&replay);
+    }
+    gameWorldFree(&world);
+    return failures ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strstr(argv[1], ".clwr")) return verifyFiles(argc - 1, argv + 1);
+    int games = argc > 1 ? atoi(argv[1]) : 4000;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+
+    // Record
+    RngStream rng;
+    rngSeed(&rng, seed);
+    GameWorld world;
+    gameWorldInit(&world, DIFFICULTY_MEDIUM, DEFAULT_GRID_WIDTH, DEFAULT_GRID_HEIGHT, seed);
+    PathSearchContext ctx;
+    pathSearchInit(&ctx, world.map.grid.width, world.map.grid.height);
+    Point* path = (Point*)malloc(world.map.grid.width * world.map.grid.height * sizeof(Point));
+    Replay* replays = (Replay*)malloc(games * sizeof(Replay));
+    int wins = 0;
+    long long inputs = 0, ticks = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < games; g++) {
+        replayInit(&replays[g]);
+        recordGame(&world, &replays[g], (DifficultyLevel)(g % 3), &ctx, path, &rng);
+        wins += replays[g].result == GAME_WIN;
+        inputs += replays[g].inputCount;
+        ticks += replays[g].ticks;
+    }
+    double recordSeconds = secondsSince(start);
+
+    // Round trip through the file format
+    size_t bytes = 0;
+    int roundTripFailures = 0;
+    for (int g = 0; g < games; g++) {
+        size_t size = replayEncodedSize(&replays[g]);
+        uint8_t* data = (uint8_t*)malloc(size);
+        bool ok = replayEncode(&replays[g], data) == size;
+        Replay decoded;
+        replayInit(&decoded);
+        ok = ok && replayDecode(&decoded, data, size) && decoded.inputCount == replays[g].inputCount &&
+            decoded.mapSeed == replays[g].mapSeed && decoded.ticks == replays[g].ticks &&
+            memcmp(decoded.inputs, replays[g].inputs, decoded.inputCount * sizeof(ReplayInput)) == 0;
+        roundTripFailures += !ok;
+        bytes += size;
+        replayFree(&decoded);
+        free(data);
+    }
+    printf("games=%d seed=%llu grid=%dx%d wins=%d inputs_per_game=%.1f ticks_per_game=%.1f bytes_per_game=%.1f "
+        "round_trip_failures=%d record_seconds=%.3f\n",
+        games, (unsigned long long)seed, world.map.grid.width, world.map.grid.height, wins, (double)inputs / games,
+        (double)ticks / games, (double)bytes / games, roundTripFailures, recordSeconds);
+
+    // Verify, single-threaded and then on all cores
+    ReplayCheck* checks = (ReplayCheck*)malloc(games * sizeof(ReplayCheck));
+    const int threadCounts[] = { 1, 0 };
+    for (int t = 0; t < 2; t++) {
+        JobSystem jobs;
+        jobSystemStart(&jobs, threadCounts[t]);
+        start = std::chrono::steady_clock::now();
+        replayVerifyBatch(&jobs, replays, games, checks);
+        double seconds = secondsSince(start);
+        int mismatches = 0;
+        for (int g = 0; g < games; g++) mismatches += !checks[g].matches;
+        // Game time covered per wall second against playing at SIM_TICKS_PER_SECOND
+        printf("threads=%d verify_seconds=%.3f replays_per_sec=%.0f realtime_factor=%.0fx mismatches=%d\n",
+            jobs.threadCount, seconds, games / seconds, ticks / (double)SIM_TICKS_PER_SECOND / seconds, mismatches);
+        jobSystemStop(&jobs);
+    }
+
+    for (int g = 0; g < games; g++) replayFree(&replays[g]);
+    free(checks); free(replays); free(path);
+    pathSearchFree(&ctx);
+    gameWorldFree(&world);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Run history store. Appends a large number of random runs and times the
+// append call the game thread makes against the old best-score save (rewrite
+// the whole file on every new best), then times best and top-10 queries,
+// reopening with the mapped index and rebuilding without it, and recovery
+// from a torn tail and a corrupted record. Query answers are checked against
+// a sort of the same runs after every step.
+//
+// Build: g++ -O2 -I. bench/bench_run_history.cpp run_history.cpp -o bench_run_history -pthread
+// Usage: bench_run_history [runs] [dir]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "run_history.h"
+#include "rng.h"
+
+#define TOP_N 10
+#define QUERY_ROUNDS 100000
+#define LEGACY_SAVES 2000
+
+static double secondsSince(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static bool ranksBefore(const RunIndexEntry& a, const RunIndexEntry& b) {
+    return a.gameTime != b.gameTime ? a.gameTime < b.gameTime : a.sequence < b.sequence;
+}
+
+// Every difficulty's best and top-N against the sorted reference
+static int countWrongAnswers(RunHistory* history, std::vector<RunIndexEntry>* expected) {
+    int wrong = 0;
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        RunIndexEntry top[TOP_N];
+        int n = runHistoryTop(history, (DifficultyLevel)d, top, TOP_N);
+        int want = std::min<int>(TOP_N, (int)expected[d].size());
+        wrong += n != want;
+        for (int i = 0; i < n && i < want; i++)
+            wrong += top[i].gameTime != expected[d][i].gameTime || top[i].sequence != expected[d][i].sequence;
+        int best = runHistoryBest(history, (DifficultyLevel)d);
+        wrong += best != (expected[d].empty() ? -1 : expected[d][0].gameTime);
+    }
+    return wrong;
+}
+
+static double percentile(std::vector<float>* samples, double p) {
+    size_t at = (size_t)(p * (samples->size() - 1));
+    std::nth_element(samples->begin(), samples->begin() + at, samples->end());
+    return (*samples)[at];
+}
+
+static void printOpen(const char* label, RunHistory* history, double seconds, int wrong) {
+    RunHistoryStats stats = runHistoryGetStats(history);
+    printf("%s open_ms=%.2f runs=%d rebuilt=%d skipped=%d truncated_bytes=%d wrong_answers=%d\n", label, seconds * 1000.0,
+        stats.runs, stats.rebuiltRecords, stats.skipped, stats.truncatedBytes, wrong);
+}
+
+int main(int argc, char** argv) {
+    int runs = argc > 1 ? atoi(argv[1]) : 1000000;
+    const char* dir = argc > 2 ? argv[2] : ".";
+    char logPath[RUN_HISTORY_PATH_MAX], indexPath[RUN_HISTORY_PATH_MAX], legacyPath[RUN_HISTORY_PATH_MAX];
+    snprintf(logPath, sizeof(logPath), "%s/bench_runs.runs", dir);
+    snprintf(indexPath, sizeof(indexPath), "%s/bench_runs.idx", dir);
+    snprintf(legacyPath, sizeof(legacyPath), "%s/bench_runs.dat", dir);
+    remove(logPath); remove(indexPath);
+
+    // Old save: rewrite header and three ints on the calling thread
+    int legacy[3] = { 100, 100, 100 };
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < LEGACY_SAVES; i++) {
+        legacy[i % 3]--;
+        FILE* file = fopen(legacyPath, "wb");
+        if (!file) break;
+        fwrite("CLWSAV01", 1, 8, file);
+        fwrite(legacy, sizeof(int), 3, file);
+        fclose(file);
+    }
+    double legacyUs = secondsSince(start) * 1e6 / LEGACY_SAVES;
+    remove(legacyPath);
+
+    RunHistory history;
+    if (!runHistoryOpen(&history, logPath, indexPath)) {
+        printf("cannot open %s\n", logPath);
+        return 1;
+    }
+
+    // Append, keeping a reference copy of the wins; every eighth game is a loss
+    RngStream rng;
+    rngSeed(&rng, 1);
+    std::vector<RunIndexEntry> expected[RUN_HISTORY_DIFFICULTIES];
+    std::vector<float> appendUs(runs);
+    uint32_t lossSequence = UINT32_MAX;     // First loss, corrupted later
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; i++) {
+        RunRecord run = { 0, (uint32_t)i, rngNext(&rng), 20 + (int)rngRange(&rng, 100), 0, (DifficultyLevel)rngRange(&rng, 3),
+            rngRange(&rng, 8) == 0 ? GAME_LOSE : GAME_WIN, 7, 10 };
+        run.ticks = run.gameTime * 10;
+        auto call = std::chrono::steady_clock::now();
+        uint32_t sequence = runHistoryAppend(&history, &run);
+        appendUs[i] = (float)(secondsSince(call) * 1e6);
+        if (run.result == GAME_WIN) expected[run.difficulty].push_back({ run.gameTime, sequence });
+        else if (lossSequence == UINT32_MAX) lossSequence = sequence;
+    }
+    double appendSeconds = secondsSince(start);
+    runHistoryFlush(&history);
+    double flushedSeconds = secondsSince(start);
+    RunHistoryStats stats = runHistoryGetStats(&history);
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) std::sort(expected[d].begin(), expected[d].end(), ranksBefore);
+    printf("runs=%d legacy_save_us=%.1f append_us_p50=%.2f append_us_p99=%.2f append_us_max=%.1f append_seconds=%.3f "
+        "durable_seconds=%.3f commits=%d records_per_commit=%.1f commit_ms=%.3f index_writes=%d\n",
+        runs, legacyUs, percentile(&appendUs, 0.5), percentile(&appendUs, 0.99), percentile(&appendUs, 1.0), appendSeconds,
+        flushedSeconds, stats.commits, stats.commits ? (double)stats.committed / stats.commits : 0.0,
+        stats.commits ? stats.commitSeconds * 1000.0 / stats.commits : 0.0, stats.indexWrites);
+
+    // Queries over the mapped index and the recent wins
+    RunIndexEntry top[TOP_N];
+    long long sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < QUERY_ROUNDS; i++) sink += runHistoryBest(&history, (DifficultyLevel)(i % 3));
+    double bestNs = secondsSince(start) * 1e9 / QUERY_ROUNDS;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < QUERY_ROUNDS; i++) sink += runHistoryTop(&history, (DifficultyLevel)(i % 3), top, TOP_N);
+    double topNs = secondsSince(start) * 1e9 / QUERY_ROUNDS;
+    printf("best_ns=%.0f top%d_ns=%.0f wrong_answers=%d (sink %lld)\n", bestNs, TOP_N, topNs,
+        countWrongAnswers(&history, expected), sink % 10);
+    runHistoryClose(&history);
+
+    // Reopen through the index, then without it
+    start = std::chrono::steady_clock::now();
+    runHistoryOpen(&history, logPath, indexPath);
+    double seconds = secondsSince(start);
+    printOpen("indexed", &history, seconds, countWrongAnswers(&history, expected));
+    runHistoryClose(&history);
+    remove(indexPath);
+    start = std::chrono::steady_clock::now();
+    runHistoryOpen(&history, logPath, indexPath);
+    seconds = secondsSince(start);
+    printOpen("rebuilt", &history, seconds, countWrongAnswers(&history, expected));
+    runHistoryClose(&history);
+
+    // Crash damage: a half-written record at the end and a flipped byte in a loss
+    FILE* file = fopen(logPath, "r+b");
+    if (file) {
+        fseek(file, 0, SEEK_END);
+        fwrite("half a record", 1, 13, file);
+        if (lossSequence != UINT32_MAX) {
+            fseek(file, 16 + (long)lossSequence * 32 + 8, SEEK_SET);
+            fputc(0x5A, file);
+        }
+        fclose(file);
+    }
+    start = std::chrono::steady_clock::now();
+    runHistoryOpen(&history, logPath, indexPath);
+    seconds = secondsSince(start);
+    printOpen("damaged", &history, seconds, countWrongAnswers(&history, expected));
+    runHistoryClose(&history);
+    // The index vouches for the records it covers; without it the bad one is found
+    remove(indexPath);
+    start = std::chrono::steady_clock::now();
+    runHistoryOpen(&history, logPath, indexPath);
+    seconds = secondsSince(start);
+    printOpen("damaged_rebuilt", &history, seconds, countWrongAnswers(&history, expected));
+    runHistoryClose(&history);
+
+    remove(logPath); remove(indexPath);
+    return 0;
+}
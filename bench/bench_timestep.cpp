@@ -0,0 +1,104 @@
+// Fixed-timestep loop against the timer-driven one it replaced. A model of
+// late callbacks (every callback a few ms late, now and then a long stall)
+// runs ten minutes of play at several frame rates: the old loop ran one tick
+// per 100 ms timer callback, so every late callback slowed the game down; the
+// accumulator pays out every tick the clock has banked. Then the real clock:
+// a few seconds of frames paced with sleeps, ticks counted against elapsed
+// time, and the cost of reading the clock.
+//
+// Build: g++ -O2 -I. bench/bench_timestep.cpp -o bench_timestep -pthread
+// Usage: bench_timestep [seconds of real pacing] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "frame_clock.h"
+#include "game_world.h"
+
+#define MODEL_SECONDS 600
+#define LATE_MAX_MS 8           // Every callback fires up to this late
+#define STALL_PERCENT 1         // Callbacks that hit a long stall instead
+#define STALL_MS 250
+#define CLOCK_READS 1000000
+
+static int64_t lateness(RngStream* rng) {
+    int64_t ms = rngRange(rng, 100) < STALL_PERCENT ? STALL_MS : rngRange(rng, LATE_MAX_MS + 1);
+    return ms * 1000000;
+}
+
+// Old loop: glutTimerFunc(100) re-armed after each tick
+static double modelTimerLoop(uint64_t seed) {
+    RngStream rng;
+    rngSeed(&rng, seed);
+    int64_t now = 0, end = (int64_t)MODEL_SECONDS * 1000000000;
+    long long ticks = 0;
+    while (now < end) {
+        now += 100000000 + lateness(&rng);
+        ticks++;
+    }
+    return ticks * (double)SIM_TICK_SECONDS;
+}
+
+// New loop at a frame rate; returns simulated seconds and the worst lag in ticks
+static double modelFixedStep(uint64_t seed, int fps, long long* worstLag, long long* lateFrames) {
+    RngStream rng;
+    rngSeed(&rng, seed);
+    FixedTimestep clock;
+    fixedStepStart(&clock, SIM_TICKS_PER_SECOND, 0);
+    int64_t now = 0, next = 0, period = 1000000000ll / fps, end = (int64_t)MODEL_SECONDS * 1000000000;
+    *worstLag = 0;
+    while (now < end) {
+        // The timer is armed for the next frame boundary and fires late
+        next += period;
+        if (next < now) next = now + period;
+        now = next + lateness(&rng);
+        fixedStepAdvance(&clock, now);
+        *worstLag = std::max(*worstLag, now / clock.stepNs - clock.ticks);
+    }
+    *lateFrames = clock.lateFrames;
+    return clock.ticks * (double)SIM_TICK_SECONDS;
+}
+
+int main(int argc, char** argv) {
+    double realSeconds = argc > 1 ? atof(argv[1]) : 3.0;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+
+    double old = modelTimerLoop(seed);
+    printf("model=timer_loop wall_s=%d sim_s=%.1f game_speed=%.3f\n", MODEL_SECONDS, old, old / MODEL_SECONDS);
+    const int rates[] = { 30, 60, 144 };
+    for (int i = 0; i < 3; i++) {
+        long long lag, late;
+        double sim = modelFixedStep(seed, rates[i], &lag, &late);
+        printf("model=fixed_step fps=%d wall_s=%d sim_s=%.1f game_speed=%.3f worst_lag_ticks=%lld late_frames=%lld\n",
+            rates[i], MODEL_SECONDS, sim, sim / MODEL_SECONDS, lag, late);
+    }
+
+    // Real clock, frames paced with millisecond sleeps like glutTimerFunc
+    FixedTimestep clock;
+    int64_t start = clockNowNs();
+    fixedStepStart(&clock, SIM_TICKS_PER_SECOND, start);
+    int64_t next = start, period = 1000000000ll / 60, last = start;
+    std::vector<double> frameMs;
+    while (clockNowNs() - start < (int64_t)(realSeconds * 1e9)) {
+        int64_t now = clockNowNs();
+        next += period;
+        if (next < now) next = now + period;
+        std::this_thread::sleep_for(std::chrono::milliseconds((next - now) / 1000000));
+        now = clockNowNs();
+        fixedStepAdvance(&clock, now);
+        frameMs.push_back((now - last) * 1e-6);
+        last = now;
+    }
+    double elapsed = (clockNowNs() - start) * 1e-9;
+    std::sort(frameMs.begin(), frameMs.end());
+    printf("real fps_target=60 seconds=%.2f frames=%d fps=%.1f frame_ms_p50=%.2f frame_ms_p99=%.2f ticks=%lld expected=%.1f\n",
+        elapsed, (int)frameMs.size(), frameMs.size() / elapsed, frameMs[frameMs.size() / 2],
+        frameMs[(size_t)(frameMs.size() * 0.99)], clock.ticks, elapsed * SIM_TICKS_PER_SECOND);
+
+    int64_t sink = 0, t0 = clockNowNs();
+    for (int i = 0; i < CLOCK_READS; i++) sink += clockNowNs() & 1;
+    printf("clock_read_ns=%.1f (sink %lld)\n", (clockNowNs() - t0) / (double)CLOCK_READS, (long long)sink);
+    return 0;
+}
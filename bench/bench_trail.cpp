@@ -0,0 +1,70 @@
+// Trail upkeep per tick: the ring buffer against the old array, which shifted
+// every point down on a full trail and once per faded point. The player lays
+// a point every tick; lifetimes from a few ticks up to ones longer than the
+// capacity, so both the full-trail and the expiry paths are exercised.
+//
+// Build: g++ -O2 -I. bench/bench_trail.cpp -o bench_trail
+// Usage: bench_trail [ticks]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include "trail.h"
+
+typedef struct { float x, y; float intensity; } ArrayPoint;
+
+static ArrayPoint arrayTrail[TRAIL_CAPACITY];
+static int arrayLength;
+static Trail ring;
+
+static double elapsedNs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - since).count();
+}
+
+// The removed implementation, kept here as the baseline
+static void arrayTick(float x, float y, float fade) {
+    if (arrayLength >= TRAIL_CAPACITY) {
+        memmove(&arrayTrail[0], &arrayTrail[1], (TRAIL_CAPACITY - 1) * sizeof(ArrayPoint));
+        arrayLength--;
+    }
+    arrayTrail[arrayLength].x = x; arrayTrail[arrayLength].y = y; arrayTrail[arrayLength].intensity = TRAIL_INTENSITY;
+    arrayLength++;
+    for (int i = 0; i < arrayLength; i++) arrayTrail[i].intensity -= fade;
+    int i = 0;
+    while (i < arrayLength) {
+        if (arrayTrail[i].intensity <= 0) {
+            memmove(&arrayTrail[i], &arrayTrail[i + 1], (arrayLength - i - 1) * sizeof(ArrayPoint));
+            arrayLength--;
+        }
+        else i++;
+    }
+}
+
+static void runLifetime(int lifetime, int ticks) {
+    // The ring's lifetime is fixed, so scale the array's fade to match
+    float fade = TRAIL_INTENSITY / lifetime;
+    arrayLength = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; t++) arrayTick((float)(t & 15), (float)(t >> 4 & 15), fade);
+    double arrayNs = elapsedNs(t0);
+
+    // Expiring against a shifted tick gives the ring the same lifetime
+    trailClear(&ring);
+    t0 = std::chrono::steady_clock::now();
+    for (int t = 0; t < ticks; t++) {
+        trailPush(&ring, (float)(t & 15), (float)(t >> 4 & 15), t);
+        trailExpire(&ring, t + 1 - lifetime + TRAIL_LIFETIME_TICKS);
+    }
+    double ringNs = elapsedNs(t0);
+
+    printf("lifetime=%d capacity=%d ticks=%d array_length=%d ring_length=%d array_ns_per_tick=%.1f ring_ns_per_tick=%.1f speedup=%.1fx\n",
+        lifetime, TRAIL_CAPACITY, ticks, arrayLength, ring.length, arrayNs / ticks, ringNs / ticks, arrayNs / ringNs);
+}
+
+int main(int argc, char** argv) {
+    int ticks = argc > 1 ? atoi(argv[1]) : 200000;
+    const int lifetimes[] = { TRAIL_LIFETIME_TICKS, 250, TRAIL_CAPACITY, 100000 };
+    for (int i = 0; i < (int)(sizeof(lifetimes) / sizeof(lifetimes[0])); i++) runLifetime(lifetimes[i], ticks);
+    return 0;
+}
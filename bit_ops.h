@@ -0,0 +1,54 @@
+#ifndef BIT_OPS_H
+#define BIT_OPS_H
+
+#include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Bit counting and scanning for GCC, Clang and MSVC, with a plain fallback for anything else
+
+static inline int popCount64(uint64_t x) {
+#if defined(__GNUC__)
+    return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return (int)__popcnt64(x);
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+    return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+}
+
+// Index of the lowest and highest set bit; x must not be zero
+
+static inline int lowestBit32(uint32_t x) {
+#if defined(__GNUC__)
+    return __builtin_ctz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, x);
+    return (int)index;
+#else
+    int index = 0;
+    while (!(x & 1)) { x >>= 1; index++; }
+    return index;
+#endif
+}
+
+static inline int highestBit32(uint32_t x) {
+#if defined(__GNUC__)
+    return 31 - __builtin_clz(x);
+#elif defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse(&index, x);
+    return (int)index;
+#else
+    int index = 0;
+    while (x >>= 1) index++;
+    return index;
+#endif
+}
+
+#endif
@@ -0,0 +1,246 @@
+#include "bitboard.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bit_ops.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Packed layout masks: drop bits shifted across a 16-bit row boundary
+#define PACKED_NOT_FIRST_COLUMN 0xFFFEFFFEFFFEFFFEull
+#define PACKED_NOT_LAST_COLUMN 0x7FFF7FFF7FFF7FFFull
+
+// Direction vectors, same order as the game's
+static const int dxDir[4] = { 0, 1, 0, -1 }, dyDir[4] = { -1, 0, 1, 0 };
+
+void bitboardInit(Bitboard* board, int width, int height) {
+    memset(board, 0, sizeof(*board));
+    board->width = width; board->height = height;
+    board->packed = width <= BITBOARD_PACKED_SIZE && height <= BITBOARD_PACKED_SIZE;
+    board->wordsPerRow = (width + 63) >> 6;
+    board->wordCount = board->packed ? 4 : board->wordsPerRow * height;
+    board->open = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->reached = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->depthLo = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->depthHi = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->frontier = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->spread = (uint64_t*)calloc(board->wordCount, sizeof(uint64_t));
+    board->active = (int*)malloc(board->wordCount * sizeof(int));
+    board->nextActive = (int*)malloc(board->wordCount * sizeof(int));
+    board->mark = (unsigned int*)calloc(board->wordCount, sizeof(unsigned int));
+    board->sourceX = board->sourceY = -1;
+}
+
+void bitboardFree(Bitboard* board) {
+    free(board->open); free(board->reached); free(board->depthLo); free(board->depthHi);
+    free(board->frontier); free(board->spread);
+    free(board->active); free(board->nextActive); free(board->mark);
+    memset(board, 0, sizeof(*board));
+}
+
+void bitboardLoad(Bitboard* board, const SpaceGrid* grid) {
+    if (board->width != grid->width || board->height != grid->height || !board->open) {
+        if (board->open) bitboardFree(board);
+        bitboardInit(board, grid->width, grid->height);
+    }
+    const int width = board->width, height = board->height;
+    memset(board->open, 0, board->wordCount * sizeof(uint64_t));
+
+    // Eight cells per read; both layouts keep tile-aligned bytes inside one word
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x += GRID_TILE_SIZE) {
+            uint64_t bits = (uint8_t)~spaceGridRowByte(grid, x, y);
+            if (width - x < GRID_TILE_SIZE) bits &= (1u << (width - x)) - 1;
+            board->open[bitboardWordIndex(board, x, y)] |= bits << bitboardBitIndex(board, x, y);
+        }
+    }
+    board->gridId = grid->id;
+    board->gridVersion = grid->version;
+    board->sourceX = board->sourceY = -1;
+}
+
+// One layer at a time over the 256-bit board; depth cycles 0, 1, 2
+static void floodPacked(Bitboard* board, uint64_t source[4]) {
+#ifdef __AVX2__
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i open = _mm256_loadu_si256((const __m256i*)board->open);
+    __m256i frontier = _mm256_loadu_si256((const __m256i*)source);
+    __m256i reached = frontier, lo = zero, hi = zero;
+    int depth = 0;
+
+    while (!_mm256_testz_si256(frontier, frontier)) {
+        depth = depth == 2 ? 0 : depth + 1;
+        // Neighbouring words for the rows that cross a 64-bit lane
+        __m256i prev = _mm256_blend_epi32(_mm256_permute4x64_epi64(frontier, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x03);
+        __m256i next = _mm256_blend_epi32(_mm256_permute4x64_epi64(frontier, _MM_SHUFFLE(3, 3, 2, 1)), zero, 0xC0);
+        // 16-bit lanes are rows, so left and right shifts cannot leak into the next row
+        __m256i spread = _mm256_or_si256(_mm256_slli_epi16(frontier, 1), _mm256_srli_epi16(frontier, 1));
+        spread = _mm256_or_si256(spread, _mm256_or_si256(_mm256_slli_epi64(frontier, 16), _mm256_srli_epi64(prev, 48)));
+        spread = _mm256_or_si256(spread, _mm256_or_si256(_mm256_srli_epi64(frontier, 16), _mm256_slli_epi64(next, 48)));
+
+        frontier = _mm256_andnot_si256(reached, _mm256_and_si256(spread, open));
+        reached = _mm256_or_si256(reached, frontier);
+        if (depth == 1) lo = _mm256_or_si256(lo, frontier);
+        else if (depth == 2) hi = _mm256_or_si256(hi, frontier);
+    }
+    _mm256_storeu_si256((__m256i*)board->reached, reached);
+    _mm256_storeu_si256((__m256i*)board->depthLo, lo);
+    _mm256_storeu_si256((__m256i*)board->depthHi, hi);
+#else
+    uint64_t frontier[4], reached[4], lo[4] = { 0 }, hi[4] = { 0 };
+    const uint64_t* open = board->open;
+    memcpy(frontier, source, sizeof(frontier));
+    memcpy(reached, source, sizeof(reached));
+    int depth = 0;
+
+    while (frontier[0] | frontier[1] | frontier[2] | frontier[3]) {
+        depth = depth == 2 ? 0 : depth + 1;
+        uint64_t spread[4];
+        for (int i = 0; i < 4; i++) {
+            uint64_t w = frontier[i];
+            uint64_t s = ((w << 1) & PACKED_NOT_FIRST_COLUMN) | ((w >> 1) & PACKED_NOT_LAST_COLUMN) | (w << 16) | (w >> 16);
+            if (i > 0) s |= frontier[i - 1] >> 48;
+            if (i < 3) s |= frontier[i + 1] << 48;
+            spread[i] = s;
+        }
+        for (int i = 0; i < 4; i++) {
+            frontier[i] = spread[i] & open[i] & ~reached[i];
+            reached[i] |= frontier[i];
+            if (depth == 1) lo[i] |= frontier[i];
+            else if (depth == 2) hi[i] |= frontier[i];
+        }
+    }
+    memcpy(board->reached, reached, sizeof(reached));
+    memcpy(board->depthLo, lo, sizeof(lo));
+    memcpy(board->depthHi, hi, sizeof(hi));
+#endif
+}
+
+// Row layout; each layer touches only the frontier words and their four neighbours
+static void floodRows(Bitboard* board, int sourceWord) {
+    const int wordsPerRow = board->wordsPerRow, height = board->height;
+    uint64_t *frontier = board->frontier, *spread = board->spread, *reached = board->reached;
+    const uint64_t* open = board->open;
+    int *active = board->active, *nextActive = board->nextActive;
+    int activeCount = 1, depth = 0;
+    active[0] = sourceWord;
+
+    while (activeCount > 0) {
+        depth = depth == 2 ? 0 : depth + 1;
+        uint64_t* plane = depth == 1 ? board->depthLo : depth == 2 ? board->depthHi : NULL;
+        if (++board->markStamp == 0) {
+            memset(board->mark, 0, board->wordCount * sizeof(unsigned int));
+            board->markStamp = 1;
+        }
+        const unsigned int stamp = board->markStamp;
+
+        // Expand into every word the current layer can touch
+        int nextCount = 0;
+        for (int a = 0; a < activeCount; a++) {
+            int word = active[a], y = word / wordsPerRow, i = word - y * wordsPerRow;
+            int candidates[5], candidateCount = 0;
+            candidates[candidateCount++] = word;
+            if (i > 0) candidates[candidateCount++] = word - 1;
+            if (i < wordsPerRow - 1) candidates[candidateCount++] = word + 1;
+            if (y > 0) candidates[candidateCount++] = word - wordsPerRow;
+            if (y < height - 1) candidates[candidateCount++] = word + wordsPerRow;
+
+            for (int c = 0; c < candidateCount; c++) {
+                int target = candidates[c];
+                if (board->mark[target] == stamp) continue;
+                board->mark[target] = stamp;
+
+                int ty = target / wordsPerRow, ti = target - ty * wordsPerRow;
+                uint64_t w = frontier[target];
+                uint64_t s = (w << 1) | (w >> 1);
+                if (ti > 0) s |= frontier[target - 1] >> 63;
+                if (ti < wordsPerRow - 1) s |= frontier[target + 1] << 63;
+                if (ty > 0) s |= frontier[target - wordsPerRow];
+                if (ty < height - 1) s |= frontier[target + wordsPerRow];
+                s &= open[target] & ~reached[target];
+                if (s) { spread[target] = s; nextActive[nextCount++] = target; }
+            }
+        }
+
+        // Swap layers
+        for (int a = 0; a < activeCount; a++) frontier[active[a]] = 0;
+        for (int a = 0; a < nextCount; a++) {
+            int word = nextActive[a];
+            frontier[word] = spread[word];
+            reached[word] |= spread[word];
+            if (plane) plane[word] |= spread[word];
+        }
+        int* swap = active; active = nextActive; nextActive = swap;
+        activeCount = nextCount;
+    }
+}
+
+int bitboardFlood(Bitboard* board, int sourceX, int sourceY) {
+    board->floods++;
+    board->sourceX = sourceX; board->sourceY = sourceY;
+    size_t bytes = board->wordCount * sizeof(uint64_t);
+    memset(board->reached, 0, bytes);
+    memset(board->depthLo, 0, bytes);
+    memset(board->depthHi, 0, bytes);
+    if (!bitboardTest(board, board->open, sourceX, sourceY)) return 0;
+
+    int word = bitboardWordIndex(board, sourceX, sourceY);
+    uint64_t bit = (uint64_t)1 << bitboardBitIndex(board, sourceX, sourceY);
+    if (board->packed) {
+        uint64_t source[4] = { 0 };
+        source[word] = bit;
+        floodPacked(board, source);
+    }
+    else {
+        board->frontier[word] = board->reached[word] = bit;
+        floodRows(board, word);
+    }
+
+    int count = 0;
+    for (int i = 0; i < board->wordCount; i++) count += popCount64(board->reached[i]);
+    return count;
+}
+
+bool bitboardUpdate(Bitboard* board, const SpaceGrid* grid, int sourceX, int sourceY) {
+    bool sameGrid = board->open && board->width == grid->width && board->height == grid->height &&
+        board->gridId == grid->id && board->gridVersion == grid->version;
+    if (!sameGrid) bitboardLoad(board, grid);
+    else if (board->sourceX == sourceX && board->sourceY == sourceY) return false;
+    bitboardFlood(board, sourceX, sourceY);
+    return true;
+}
+
+static int depthCode(const Bitboard* board, int x, int y) {
+    if (bitboardTest(board, board->depthLo, x, y)) return 1;
+    return bitboardTest(board, board->depthHi, x, y) ? 2 : 0;
+}
+
+// Neighbours of a reached cell are one layer up, level or one layer down, so
+// the one whose depth is one less modulo 3 is always a layer closer to the source
+static bool stepTowardSource(const Bitboard* board, int* x, int* y) {
+    int want = (depthCode(board, *x, *y) + 2) % 3;
+    for (int i = 0; i < 4; i++) {
+        int nx = *x + dxDir[i], ny = *y + dyDir[i];
+        if (bitboardReached(board, nx, ny) && depthCode(board, nx, ny) == want) {
+            *x = nx; *y = ny; return true;
+        }
+    }
+    return false;
+}
+
+int bitboardRoute(const Bitboard* board, int goalX, int goalY, Point* path, int maxPath) {
+    if (!bitboardReached(board, goalX, goalY)) return -1;
+
+    // Count first so the route can be written source first
+    int length = 1;
+    for (int x = goalX, y = goalY; x != board->sourceX || y != board->sourceY; length++) {
+        if (!stepTowardSource(board, &x, &y)) return -1;
+    }
+
+    int x = goalX, y = goalY;
+    for (int i = length - 1; i >= 0; i--) {
+        if (i < maxPath) { path[i].x = x; path[i].y = y; }
+        if (i > 0) stepTowardSource(board, &x, &y);
+    }
+    return length;
+}
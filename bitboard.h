@@ -0,0 +1,81 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "game_world.h"
+#include "space_grid.h"
+
+// Bit-parallel flood fill over the free cells of a SpaceGrid. A whole BFS
+// layer is expanded with shifts and masks, 64 cells per word. Maps up to 16x16
+// use a packed layout, four 16-bit rows per word, so the whole board is one
+// 256-bit vector (a single AVX2 register when __AVX2__ is defined). Larger
+// maps use one row of words per map row and only visit the words next to the
+// current layer, so the cost follows the frontier rather than the map. The
+// fill is 4-connected: under the corner rule a diagonal move is only possible
+// when a two-step cardinal detour exists, so it reaches the same cells as
+// 8-direction moves.
+//
+// Every flood also keeps each reached cell's BFS depth modulo 3 in two bit
+// planes. That is enough to walk a shortest route back from any reached cell
+// without storing the layers.
+
+#define BITBOARD_PACKED_SIZE 16 // Largest side that fits the 256-bit layout
+
+typedef struct {
+    int width, height;
+    bool packed;            // 16x16 layout: row y in word y / 4, bits 16 * (y % 4) + x
+    int wordsPerRow;        // Row layout: row y starts at word y * wordsPerRow
+    int wordCount;
+    uint64_t* open;         // Free cells
+    uint64_t* reached;      // Cells connected to the flood source
+    uint64_t* depthLo;      // Set where depth % 3 == 1
+    uint64_t* depthHi;      // Set where depth % 3 == 2
+    uint64_t* frontier;     // Row layout scratch: current layer and the next one
+    uint64_t* spread;
+    int* active;            // Words holding the current layer, then the next one
+    int* nextActive;
+    unsigned int* mark;     // Layer that last visited each word
+    unsigned int markStamp;
+    unsigned int gridId, gridVersion;
+    int sourceX, sourceY;   // Source of the last flood, -1 if none
+    int floods;             // Floods run since init, for benchmarks
+} Bitboard;
+
+void bitboardInit(Bitboard* board, int width, int height);
+void bitboardFree(Bitboard* board);
+
+// Copies the free cells of the grid and forgets the last flood
+void bitboardLoad(Bitboard* board, const SpaceGrid* grid);
+
+// Marks every cell connected to the source. Returns the number of cells
+// reached, 0 if the source is blocked or off the map.
+int bitboardFlood(Bitboard* board, int sourceX, int sourceY);
+
+// Reloads and refloods only if the grid or the source changed since the last
+// call. Returns true if a flood ran.
+bool bitboardUpdate(Bitboard* board, const SpaceGrid* grid, int sourceX, int sourceY);
+
+// Shortest route from the flood source to (goalX, goalY). Returns its length,
+// both ends included, or -1 if the goal was not reached. Up to maxPath points
+// are written to path, source first.
+int bitboardRoute(const Bitboard* board, int goalX, int goalY, Point* path, int maxPath);
+
+static inline int bitboardWordIndex(const Bitboard* board, int x, int y) {
+    return board->packed ? (y >> 2) : y * board->wordsPerRow + (x >> 6);
+}
+
+static inline int bitboardBitIndex(const Bitboard* board, int x, int y) {
+    return board->packed ? (((y & 3) << 4) | x) : (x & 63);
+}
+
+static inline bool bitboardTest(const Bitboard* board, const uint64_t* plane, int x, int y) {
+    if (x < 0 || x >= board->width || y < 0 || y >= board->height) return false;
+    return (plane[bitboardWordIndex(board, x, y)] >> bitboardBitIndex(board, x, y)) & 1;
+}
+
+static inline bool bitboardReached(const Bitboard* board, int x, int y) {
+    return bitboardTest(board, board->reached, x, y);
+}
+
+#endif
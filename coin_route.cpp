@@ -0,0 +1,312 @@
+#include "coin_route.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include "bit_ops.h"
+
+#define ROUTE_INFINITY (INT_MAX / 2)
+#define CELL_BLOCKED -2         // dist of asteroids and the border
+#define CELL_UNSEEN -1
+
+static void allocateGrid(CoinRouteSolver* solver, int width, int height) {
+    int cells = (width + 2) * (height + 2);
+    solver->width = width; solver->height = height;
+    solver->dist = (int*)malloc(cells * sizeof(int));
+    solver->queue = (int*)malloc(cells * sizeof(int));
+    solver->target = (int*)calloc(cells, sizeof(int));
+    for (int i = 0; i < cells; i++) solver->dist[i] = CELL_BLOCKED;
+}
+
+static void freeGrid(CoinRouteSolver* solver) {
+    free(solver->dist); free(solver->queue); free(solver->target);
+}
+
+void coinRouteInit(CoinRouteSolver* solver, int width, int height) {
+    memset(solver, 0, sizeof(*solver));
+    solver->exactMax = COIN_ROUTE_EXACT_MAX;
+    allocateGrid(solver, width, height);
+}
+
+void coinRouteFree(CoinRouteSolver* solver) {
+    freeGrid(solver);
+    free(solver->stops); free(solver->matrix); free(solver->table); free(solver->scratch);
+    free(solver->route);
+    memset(solver, 0, sizeof(*solver));
+}
+
+static inline int paddedCell(const CoinRouteSolver* solver, Point p) {
+    return (p.y + 1) * (solver->width + 2) + p.x + 1;
+}
+
+// Breadth-first from a padded cell until `remaining` stops (counted in
+// target) have been reached or the region runs out. dist keeps the steps of
+// every queued cell until clearSearch. Returns the stops still unreached.
+// Blocked cells are never CELL_UNSEEN, so one load decides each neighbour.
+static int search(CoinRouteSolver* solver, int source, int remaining, int* queued) {
+    const int stride = solver->width + 2;
+    const int offsets[4] = { -stride, 1, stride, -1 };
+    int* dist = solver->dist;
+    int* queue = solver->queue;
+    const int* target = solver->target;
+    int front = 0, back = 0;
+    dist[source] = 0;
+    queue[back++] = source;
+    remaining -= target[source];
+    solver->searches++;
+    while (front < back && remaining > 0) {
+        int cell = queue[front++], next = dist[cell] + 1;
+        for (int i = 0; i < 4; i++) {
+            int neighbor = cell + offsets[i];
+            if (dist[neighbor] != CELL_UNSEEN) continue;
+            dist[neighbor] = next;
+            queue[back++] = neighbor;
+            remaining -= target[neighbor];
+        }
+    }
+    *queued = back;
+    return remaining;
+}
+
+static void clearSearch(CoinRouteSolver* solver, int queued) {
+    for (int i = 0; i < queued; i++) solver->dist[solver->queue[i]] = CELL_UNSEEN;
+}
+
+static void reserveStops(CoinRouteSolver* solver, int stops) {
+    if (stops <= solver->stopCapacity) return;
+    solver->stopCapacity = stops;
+    solver->stops = (Point*)realloc(solver->stops, stops * sizeof(Point));
+    solver->matrix = (int*)realloc(solver->matrix, (size_t)stops * stops * sizeof(int));
+    solver->scratch = (int*)realloc(solver->scratch, stops * sizeof(int));
+    solver->route = (int*)realloc(solver->route, stops * sizeof(int));
+}
+
+// Fills the stop matrix; false if the start cannot reach every other stop.
+// Paths are undirected, so the search from stop i only looks for stops after it.
+static bool fillMatrix(CoinRouteSolver* solver) {
+    const int n = solver->stopCount;
+    int* matrix = solver->matrix;
+    for (int j = 1; j < n; j++) solver->target[paddedCell(solver, solver->stops[j])]++;
+    bool reachable = true;
+    for (int i = 0; i < n - 1 && reachable; i++) {
+        int source = paddedCell(solver, solver->stops[i]);
+        if (i > 0) solver->target[source]--;
+        int queued;
+        reachable = search(solver, source, n - 1 - i, &queued) == 0;
+        matrix[i * n + i] = 0;
+        for (int j = i + 1; j < n; j++)
+            matrix[i * n + j] = matrix[j * n + i] = solver->dist[paddedCell(solver, solver->stops[j])];
+        clearSearch(solver, queued);
+    }
+    matrix[(n - 1) * n + n - 1] = 0;
+    // Whatever is still counted belongs to the stops after a failed search
+    for (int j = 1; j < n; j++) solver->target[paddedCell(solver, solver->stops[j])] = 0;
+    return reachable;
+}
+
+// Held-Karp: table[mask * c + last] is the cheapest walk from the start over
+// the coins in mask that ends on coin last. Each entry pulls from the subset
+// without last, looking only at the coins in it, so 10 coins take about
+// 23,000 steps. The order is read back by finding which predecessor produced
+// each entry.
+static int solveExact(CoinRouteSolver* solver, int coinCount) {
+    const int c = coinCount, n = solver->stopCount, full = (1 << c) - 1;
+    const int* matrix = solver->matrix;
+    size_t entries = (size_t)(full + 1) * c;
+    if (entries > solver->tableSize) {
+        solver->table = (int*)realloc(solver->table, entries * sizeof(int));
+        solver->tableSize = entries;
+    }
+    int* table = solver->table;
+
+    // Coin-to-coin steps, into[next][last] so a pull reads one row
+    int into[COIN_ROUTE_EXACT_MAX][COIN_ROUTE_EXACT_MAX];
+    for (int a = 0; a < c; a++)
+        for (int b = 0; b < c; b++) into[a][b] = matrix[(b + 1) * n + a + 1];
+
+    for (int mask = 1; mask <= full; mask++) {
+        int* row = &table[mask * c];
+        for (int bits = mask; bits; bits &= bits - 1) {
+            int next = lowestBit32(bits), rest = mask ^ (1 << next);
+            if (!rest) { row[next] = matrix[next + 1]; continue; }
+            const int* from = &table[rest * c];
+            const int* steps = into[next];
+            int best = ROUTE_INFINITY;
+            for (int left = rest; left; left &= left - 1) {
+                int last = lowestBit32(left);
+                best = std::min(best, from[last] + steps[last]);
+            }
+            row[next] = best;
+        }
+    }
+
+    int best = ROUTE_INFINITY, last = 0;
+    for (int k = 0; k < c; k++) {
+        int cost = table[full * c + k] + matrix[(k + 1) * n + n - 1];
+        if (cost < best) { best = cost; last = k; }
+    }
+    int mask = full;
+    for (int i = c - 1; i >= 0; i--) {
+        solver->route[i] = last;
+        int cost = table[mask * c + last];
+        mask ^= 1 << last;
+        for (int left = mask; left; left &= left - 1) {
+            int k = lowestBit32(left);
+            if (table[mask * c + k] + into[last][k] == cost) { last = k; break; }
+        }
+    }
+    return best;
+}
+
+// Nearest neighbour, then 2-opt and single-stop moves until neither helps.
+// seq holds stops: the start, every coin once, the exit.
+static int solveHeuristic(CoinRouteSolver* solver, int coinCount) {
+    const int c = coinCount, n = solver->stopCount;
+    const int* matrix = solver->matrix;
+    int* seq = solver->scratch;
+#define D(a, b) matrix[(a) * n + (b)]
+
+    // Nearest neighbour: the closest coin left is swapped into place
+    for (int i = 0; i < n; i++) seq[i] = i;
+    for (int i = 1; i <= c; i++) {
+        int best = i;
+        for (int k = i + 1; k <= c; k++)
+            if (D(seq[i - 1], seq[k]) < D(seq[i - 1], seq[best])) best = k;
+        int t = seq[i]; seq[i] = seq[best]; seq[best] = t;
+    }
+
+    bool improved = true;
+    while (improved) {
+        improved = false;
+        // 2-opt: reverse seq[i..j]; steps are symmetric, so only the two ends change
+        for (int i = 1; i < c; i++) {
+            for (int j = i + 1; j <= c; j++) {
+                int delta = D(seq[i - 1], seq[j]) + D(seq[i], seq[j + 1]) - D(seq[i - 1], seq[i]) - D(seq[j], seq[j + 1]);
+                if (delta >= 0) continue;
+                for (int a = i, b = j; a < b; a++, b--) { int t = seq[a]; seq[a] = seq[b]; seq[b] = t; }
+                improved = true;
+            }
+        }
+        // Move one coin between two others
+        for (int i = 1; i <= c; i++) {
+            int stop = seq[i];
+            int gain = D(seq[i - 1], stop) + D(stop, seq[i + 1]) - D(seq[i - 1], seq[i + 1]);
+            int bestK = -1, bestDelta = 0;
+            for (int k = 0; k <= c; k++) {
+                if (k == i - 1 || k == i) continue;
+                int delta = D(seq[k], stop) + D(stop, seq[k + 1]) - D(seq[k], seq[k + 1]) - gain;
+                if (delta < bestDelta) { bestDelta = delta; bestK = k; }
+            }
+            if (bestK < 0) continue;
+            // Take the coin out, then put it after seq[bestK] as it was before removal
+            if (bestK > i) {
+                memmove(seq + i, seq + i + 1, (bestK - i) * sizeof(int));
+                seq[bestK] = stop;
+            }
+            else {
+                memmove(seq + bestK + 2, seq + bestK + 1, (i - bestK - 1) * sizeof(int));
+                seq[bestK + 1] = stop;
+            }
+            improved = true;
+        }
+    }
+
+    int moves = 0;
+    for (int i = 0; i <= c; i++) moves += D(seq[i], seq[i + 1]);
+#undef D
+    for (int i = 0; i < c; i++) solver->route[i] = seq[i + 1] - 1;
+    return moves;
+}
+
+int coinRouteSolve(CoinRouteSolver* solver, const SpaceGrid* grid, Point start,
+    const Point* coins, int coinCount, Point exit, int* order) {
+    if (solver->width != grid->width || solver->height != grid->height) {
+        freeGrid(solver);
+        allocateGrid(solver, grid->width, grid->height);
+    }
+    const int width = grid->width, height = grid->height, stride = width + 2;
+    // A tile row at a time into the padded field
+    for (int y = 0; y < height; y++) {
+        int* row = &solver->dist[(y + 1) * stride + 1];
+        for (int x = 0; x < width; x += GRID_TILE_SIZE) {
+            unsigned int blocked = spaceGridRowByte(grid, x, y);
+            int end = x + GRID_TILE_SIZE < width ? x + GRID_TILE_SIZE : width;
+            for (int i = x; i < end; i++, blocked >>= 1) row[i] = blocked & 1 ? CELL_BLOCKED : CELL_UNSEEN;
+        }
+    }
+
+    reserveStops(solver, coinCount + 2);
+    solver->stopCount = 0;
+    solver->stops[0] = start;
+    for (int i = 0; i < coinCount; i++) solver->stops[i + 1] = coins[i];
+    solver->stops[coinCount + 1] = exit;
+    solver->exact = coinCount <= solver->exactMax && coinCount <= COIN_ROUTE_EXACT_MAX;
+    for (int i = 0; i < coinCount + 2; i++) {
+        Point p = solver->stops[i];
+        if (!spaceGridInBounds(grid, p.x, p.y) || spaceGridBlocked(grid, p.x, p.y)) return -1;
+    }
+    solver->stopCount = coinCount + 2;
+    if (!fillMatrix(solver)) {
+        solver->stopCount = 0;
+        return -1;
+    }
+
+    int moves = coinCount == 0 ? solver->matrix[1] :
+        solver->exact ? solveExact(solver, coinCount) : solveHeuristic(solver, coinCount);
+    if (order)
+        for (int i = 0; i < coinCount; i++) order[i] = solver->route[i];
+    return moves;
+}
+
+int coinRouteSolveMap(CoinRouteSolver* solver, const MapLayout* map, int* order) {
+    Point coins[MAX_COINS] = {};
+    int index[MAX_COINS], count = 0;
+    for (int i = 0; i < map->totalCoins; i++) {
+        if (!map->coins[i].active) continue;
+        coins[count].x = (int)map->coins[i].x;
+        coins[count].y = (int)map->coins[i].y;
+        index[count++] = i;
+    }
+    Point start = { PLAYER_START_X, PLAYER_START_Y };
+    Point exit = { (int)map->exitX, (int)map->exitY };
+    int visit[MAX_COINS];
+    int moves = coinRouteSolve(solver, &map->grid, start, coins, count, exit, visit);
+    if (order && moves >= 0)
+        for (int i = 0; i < count; i++) order[i] = index[visit[i]];
+    return moves;
+}
+
+int coinRoutePath(CoinRouteSolver* solver, Point* path, int maxPath) {
+    const int stride = solver->width + 2, coinCount = solver->stopCount - 2;
+    if (solver->stopCount < 2) return -1;
+    int length = 0;
+    for (int leg = 0; leg <= coinCount; leg++) {
+        Point from = leg == 0 ? solver->stops[0] : solver->stops[solver->route[leg - 1] + 1];
+        Point to = leg == coinCount ? solver->stops[coinCount + 1] : solver->stops[solver->route[leg] + 1];
+        // Search back from the leg's end, then walk down the steps from its start
+        int source = paddedCell(solver, to), cell = paddedCell(solver, from), queued;
+        solver->target[cell]++;
+        int missed = search(solver, source, 1, &queued);
+        solver->target[cell]--;
+        if (missed) {
+            clearSearch(solver, queued);
+            return -1;
+        }
+        const int offsets[4] = { -stride, 1, stride, -1 };
+        for (;;) {
+            // Each leg starts where the last one ended, so only the first writes its start
+            if (leg == 0 || cell != paddedCell(solver, from)) {
+                if (length < maxPath) { path[length].x = cell % stride - 1; path[length].y = cell / stride - 1; }
+                length++;
+            }
+            int steps = solver->dist[cell];
+            if (steps == 0) break;
+            for (int i = 0; i < 4; i++) {
+                int neighbor = cell + offsets[i];
+                if (solver->dist[neighbor] == steps - 1) { cell = neighbor; break; }
+            }
+        }
+        clearSearch(solver, queued);
+    }
+    return length;
+}
@@ -0,0 +1,53 @@
+#ifndef COIN_ROUTE_H
+#define COIN_ROUTE_H
+
+#include <stdbool.h>
+#include "game_world.h"
+#include "space_grid.h"
+
+// Fewest moves that collect every coin and then reach the exit. One BFS per
+// stop (the start and each coin) fills a matrix of step distances between
+// start, coins and exit; a BFS stops as soon as it has found every stop.
+// Up to COIN_ROUTE_EXACT_MAX coins the best visiting order comes from a
+// Held-Karp dynamic program over subsets of coins, beyond that from nearest
+// neighbour followed by 2-opt and single-coin moves until nothing improves.
+// Moves are the game's: one cardinal step onto a free cell, and a coin counts
+// as soon as the player stands on it.
+
+#define COIN_ROUTE_EXACT_MAX 12 // 2^12 * 12 table entries
+
+typedef struct {
+    int width, height;
+    int* dist;              // Steps per cell of the running search, -1 unseen, -2 blocked;
+                            // padded with a blocked border, (width + 2) * (height + 2)
+    int* queue;
+    int* target;            // Stops on each padded cell that the running search still wants
+    Point* stops;           // Start, coins, exit of the last solve
+    int* matrix;            // Steps between stops, -1 if unreachable
+    int stopCount, stopCapacity;
+    int* table;             // Held-Karp costs per (coin subset, last coin)
+    size_t tableSize;
+    int* scratch;           // Heuristic stop sequence
+    int* route;             // Coins of the last solve in visiting order, by stop
+    int exactMax;           // Coins solved exactly, at most COIN_ROUTE_EXACT_MAX
+    bool exact;             // Last solve was optimal rather than heuristic
+    int searches;           // BFS runs since init, for benchmarks
+} CoinRouteSolver;
+
+void coinRouteInit(CoinRouteSolver* solver, int width, int height);
+void coinRouteFree(CoinRouteSolver* solver);
+
+// Moves from start over every coin to the exit, or -1 if any of them cannot be
+// reached. Writes the coins' indices in visiting order to order, which may be
+// NULL. The solver adopts the grid's size if it differs.
+int coinRouteSolve(CoinRouteSolver* solver, const SpaceGrid* grid, Point start,
+    const Point* coins, int coinCount, Point exit, int* order);
+
+// The map's active coins, from the player's start cell
+int coinRouteSolveMap(CoinRouteSolver* solver, const MapLayout* map, int* order);
+
+// Cells of the last solve's route, start and exit included. Returns its
+// length, or -1 if there is no route; up to maxPath points are written to path.
+int coinRoutePath(CoinRouteSolver* solver, Point* path, int maxPath);
+
+#endif
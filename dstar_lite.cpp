@@ -0,0 +1,292 @@
+#include "dstar_lite.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Costs in thousandths of a step. Integer keys keep the heuristic exactly
+// consistent; with float sums a key can round just past the start's key and
+// leave a stale cell unexpanded.
+#define DSTAR_STRAIGHT 1000
+#define DSTAR_DIAGONAL 1414
+#define DSTAR_INF 0x3FFFFFFF
+
+// Direction vectors (cardinals first, then diagonals)
+static const int dxDir[8] = { 0, 1, 0, -1, 1, 1, -1, -1 }, dyDir[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+void dstarInit(DStarPlanner* planner, int width, int height) {
+    int cells = width * height;
+    planner->width = width; planner->height = height;
+    planner->g = (int*)malloc(cells * sizeof(int));
+    planner->rhs = (int*)malloc(cells * sizeof(int));
+    planner->heapPos = (int*)malloc(cells * sizeof(int));
+    planner->stamp = (unsigned int*)calloc(cells, sizeof(unsigned int));
+    planner->heap = (DStarEntry*)malloc(cells * sizeof(DStarEntry));
+    planner->currentStamp = 0;
+    dstarReset(planner, 0, 0, 0, 0);
+}
+
+void dstarFree(DStarPlanner* planner) {
+    free(planner->g); free(planner->rhs); free(planner->heapPos);
+    free(planner->stamp); free(planner->heap);
+    memset(planner, 0, sizeof(*planner));
+}
+
+// Cells not touched since the last reset read as g = rhs = infinity
+static inline void touchCell(DStarPlanner* planner, int cell) {
+    if (planner->stamp[cell] == planner->currentStamp) return;
+    planner->stamp[cell] = planner->currentStamp;
+    planner->g[cell] = planner->rhs[cell] = DSTAR_INF;
+    planner->heapPos[cell] = -1;
+}
+
+static inline int cellG(const DStarPlanner* planner, int cell) {
+    return planner->stamp[cell] == planner->currentStamp ? planner->g[cell] : DSTAR_INF;
+}
+
+static inline int cellRhs(const DStarPlanner* planner, int cell) {
+    return planner->stamp[cell] == planner->currentStamp ? planner->rhs[cell] : DSTAR_INF;
+}
+
+// Cost of stepping between neighbouring cells; infinite onto asteroids or across a blocked corner
+static inline int stepCost(const SpaceGrid* grid, int ax, int ay, int bx, int by) {
+    if (spaceGridBlocked(grid, ax, ay) || spaceGridBlocked(grid, bx, by)) return DSTAR_INF;
+    if (ax == bx || ay == by) return DSTAR_STRAIGHT;
+    if (spaceGridBlocked(grid, bx, ay) || spaceGridBlocked(grid, ax, by)) return DSTAR_INF;
+    return DSTAR_DIAGONAL;
+}
+
+// Octile distance in the same units
+static inline int heuristic(int x1, int y1, int x2, int y2) {
+    int ax = abs(x1 - x2), ay = abs(y1 - y2);
+    int lo = ax < ay ? ax : ay, hi = ax < ay ? ay : ax;
+    return (hi - lo) * DSTAR_STRAIGHT + lo * DSTAR_DIAGONAL;
+}
+
+// Heap helpers; keys compare lexicographically
+static inline bool entryLess(const DStarEntry* a, const DStarEntry* b) {
+    return a->k1 < b->k1 || (a->k1 == b->k1 && a->k2 < b->k2);
+}
+
+static void heapSiftUp(DStarPlanner* planner, int pos) {
+    DStarEntry entry = planner->heap[pos];
+    while (pos > 0) {
+        int parentPos = (pos - 1) / 2;
+        if (!entryLess(&entry, &planner->heap[parentPos])) break;
+        planner->heap[pos] = planner->heap[parentPos];
+        planner->heapPos[planner->heap[pos].cell] = pos;
+        pos = parentPos;
+    }
+    planner->heap[pos] = entry;
+    planner->heapPos[entry.cell] = pos;
+}
+
+static void heapSiftDown(DStarPlanner* planner, int pos) {
+    DStarEntry entry = planner->heap[pos];
+    for (;;) {
+        int child = pos * 2 + 1;
+        if (child >= planner->heapSize) break;
+        if (child + 1 < planner->heapSize && entryLess(&planner->heap[child + 1], &planner->heap[child])) child++;
+        if (!entryLess(&planner->heap[child], &entry)) break;
+        planner->heap[pos] = planner->heap[child];
+        planner->heapPos[planner->heap[pos].cell] = pos;
+        pos = child;
+    }
+    planner->heap[pos] = entry;
+    planner->heapPos[entry.cell] = pos;
+}
+
+// Inserts the cell or moves it to its new key
+static void heapSet(DStarPlanner* planner, int cell, int k1, int k2) {
+    int pos = planner->heapPos[cell];
+    if (pos < 0) pos = planner->heapSize++;
+    planner->heap[pos].cell = cell;
+    planner->heap[pos].k1 = k1;
+    planner->heap[pos].k2 = k2;
+    heapSiftUp(planner, pos);
+    heapSiftDown(planner, planner->heapPos[cell]);
+}
+
+static void heapRemove(DStarPlanner* planner, int cell) {
+    int pos = planner->heapPos[cell];
+    planner->heapPos[cell] = -1;
+    if (--planner->heapSize == pos) return;
+    planner->heap[pos] = planner->heap[planner->heapSize];
+    int moved = planner->heap[pos].cell;
+    planner->heapPos[moved] = pos;
+    heapSiftUp(planner, pos);
+    heapSiftDown(planner, planner->heapPos[moved]);
+}
+
+static void calculateKey(const DStarPlanner* planner, int cell, int* k1, int* k2) {
+    int g = cellG(planner, cell), rhs = cellRhs(planner, cell);
+    int best = g < rhs ? g : rhs;
+    *k1 = best >= DSTAR_INF ? DSTAR_INF :
+        best + heuristic(planner->startX, planner->startY, cell % planner->width, cell / planner->width) + planner->km;
+    *k2 = best;
+}
+
+// Queues the cell while it is inconsistent
+static void updateVertex(DStarPlanner* planner, int cell) {
+    planner->touched++;
+    touchCell(planner, cell);
+    if (planner->g[cell] != planner->rhs[cell]) {
+        int k1, k2;
+        calculateKey(planner, cell, &k1, &k2);
+        heapSet(planner, cell, k1, k2);
+    }
+    else if (planner->heapPos[cell] >= 0) {
+        heapRemove(planner, cell);
+    }
+}
+
+// Best one-step lookahead: min over neighbours of step cost plus their g
+static int bestSuccessor(const DStarPlanner* planner, const SpaceGrid* grid, int x, int y) {
+    int best = DSTAR_INF;
+    for (int i = 0; i < 8; i++) {
+        int nx = x + dxDir[i], ny = y + dyDir[i];
+        int cost = stepCost(grid, x, y, nx, ny);
+        if (cost >= DSTAR_INF) continue;
+        int g = cellG(planner, ny * planner->width + nx);
+        if (g < DSTAR_INF && cost + g < best) best = cost + g;
+    }
+    return best;
+}
+
+void dstarReset(DStarPlanner* planner, int startX, int startY, int goalX, int goalY) {
+    if (++planner->currentStamp == 0) {
+        memset(planner->stamp, 0, planner->width * planner->height * sizeof(unsigned int));
+        planner->currentStamp = 1;
+    }
+    planner->heapSize = 0;
+    planner->startX = planner->lastX = startX; planner->startY = planner->lastY = startY;
+    planner->goalX = goalX; planner->goalY = goalY;
+    planner->km = 0;
+    planner->touched = planner->nodesTouched = planner->nodesExpanded = 0;
+
+    if (goalX < 0 || goalX >= planner->width || goalY < 0 || goalY >= planner->height) return;
+    int goal = goalY * planner->width + goalX;
+    touchCell(planner, goal);
+    planner->rhs[goal] = 0;
+    heapSet(planner, goal, heuristic(startX, startY, goalX, goalY), 0);
+}
+
+void dstarMoveStart(DStarPlanner* planner, int x, int y) {
+    planner->startX = x; planner->startY = y;
+}
+
+// Queued keys were computed against the old start; keep them lower bounds
+static void syncStart(DStarPlanner* planner) {
+    if (planner->startX == planner->lastX && planner->startY == planner->lastY) return;
+    planner->km += heuristic(planner->lastX, planner->lastY, planner->startX, planner->startY);
+    planner->lastX = planner->startX; planner->lastY = planner->startY;
+}
+
+void dstarCellChanged(DStarPlanner* planner, const SpaceGrid* grid, int x, int y) {
+    syncStart(planner);
+    // The cell's own edges and the diagonals cutting past it all lie within its 3x3 block
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int cx = x + dx, cy = y + dy;
+            if (!spaceGridInBounds(grid, cx, cy) || (cx == planner->goalX && cy == planner->goalY)) continue;
+            int cell = cy * planner->width + cx;
+            touchCell(planner, cell);
+            planner->rhs[cell] = bestSuccessor(planner, grid, cx, cy);
+            updateVertex(planner, cell);
+        }
+    }
+}
+
+bool dstarPlan(DStarPlanner* planner, const SpaceGrid* grid) {
+    const int width = planner->width;
+    planner->nodesExpanded = 0;
+    if (grid->width != planner->width || grid->height != planner->height ||
+        !spaceGridInBounds(grid, planner->startX, planner->startY) || !spaceGridInBounds(grid, planner->goalX, planner->goalY)) {
+        planner->nodesTouched = planner->touched;
+        planner->touched = 0;
+        return false;
+    }
+    syncStart(planner);
+    int start = planner->startY * width + planner->startX, goal = planner->goalY * width + planner->goalX;
+
+    while (planner->heapSize > 0) {
+        DStarEntry top = planner->heap[0], startKey;
+        calculateKey(planner, start, &startKey.k1, &startKey.k2);
+        if (!entryLess(&top, &startKey) && cellRhs(planner, start) == cellG(planner, start)) break;
+
+        int u = top.cell, ux = u % width, uy = u / width;
+        planner->nodesExpanded++;
+        planner->touched++;
+        DStarEntry fresh;
+        fresh.cell = u;
+        calculateKey(planner, u, &fresh.k1, &fresh.k2);
+
+        if (entryLess(&top, &fresh)) {
+            // Key went stale as the agent moved; requeue
+            heapSet(planner, u, fresh.k1, fresh.k2);
+        }
+        else if (planner->g[u] > planner->rhs[u]) {
+            // Overconsistent: settle it and offer it to the neighbours
+            planner->g[u] = planner->rhs[u];
+            heapRemove(planner, u);
+            for (int i = 0; i < 8; i++) {
+                int nx = ux + dxDir[i], ny = uy + dyDir[i];
+                int cost = stepCost(grid, nx, ny, ux, uy);
+                if (cost >= DSTAR_INF || (nx == planner->goalX && ny == planner->goalY)) continue;
+                int s = ny * width + nx;
+                touchCell(planner, s);
+                if (cost + planner->g[u] < planner->rhs[s]) planner->rhs[s] = cost + planner->g[u];
+                updateVertex(planner, s);
+            }
+        }
+        else {
+            // Underconsistent: raise it, and re-derive every neighbour that leaned on it
+            int oldG = planner->g[u];
+            planner->g[u] = DSTAR_INF;
+            for (int i = 0; i < 8; i++) {
+                int nx = ux + dxDir[i], ny = uy + dyDir[i];
+                int cost = stepCost(grid, nx, ny, ux, uy);
+                if (cost >= DSTAR_INF || (nx == planner->goalX && ny == planner->goalY)) continue;
+                int s = ny * width + nx;
+                touchCell(planner, s);
+                if (planner->rhs[s] == cost + oldG) planner->rhs[s] = bestSuccessor(planner, grid, nx, ny);
+                updateVertex(planner, s);
+            }
+            if (u != goal) planner->rhs[u] = bestSuccessor(planner, grid, ux, uy);
+            updateVertex(planner, u);
+        }
+    }
+    planner->nodesTouched = planner->touched;
+    planner->touched = 0;
+    return cellG(planner, start) < DSTAR_INF;
+}
+
+float dstarPathCost(const DStarPlanner* planner) {
+    if (!(planner->startX >= 0 && planner->startX < planner->width && planner->startY >= 0 && planner->startY < planner->height))
+        return -1.0f;
+    int g = cellG(planner, planner->startY * planner->width + planner->startX);
+    return g < DSTAR_INF ? g / (float)DSTAR_STRAIGHT : -1.0f;
+}
+
+int dstarPath(const DStarPlanner* planner, const SpaceGrid* grid, Point* path, int maxPath) {
+    if (dstarPathCost(planner) < 0.0f) return -1;
+    const int width = planner->width;
+    int x = planner->startX, y = planner->startY, length = 0;
+    for (;;) {
+        if (path && length < maxPath) { path[length].x = x; path[length].y = y; }
+        length++;
+        if (x == planner->goalX && y == planner->goalY) return length;
+        if (length > planner->width * planner->height) return -1; // Plan out of date with the grid
+
+        // Step to the neighbour with the lowest cost through it
+        int bestX = -1, bestY = -1;
+        int best = DSTAR_INF;
+        for (int i = 0; i < 8; i++) {
+            int nx = x + dxDir[i], ny = y + dyDir[i];
+            int cost = stepCost(grid, x, y, nx, ny);
+            if (cost >= DSTAR_INF) continue;
+            int value = cost + cellG(planner, ny * width + nx);
+            if (value < best) { best = value; bestX = nx; bestY = ny; }
+        }
+        if (best >= DSTAR_INF) return -1;
+        x = bestX; y = bestY;
+    }
+}
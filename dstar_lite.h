@@ -0,0 +1,61 @@
+#ifndef DSTAR_LITE_H
+#define DSTAR_LITE_H
+
+#include <stdbool.h>
+#include "game_world.h"
+#include "space_grid.h"
+
+// Incremental replanning (D* Lite) for maps whose asteroids move during play.
+// The search runs from the goal towards the agent and keeps its g / rhs
+// values between calls, so after cells change or the agent steps only the
+// part of the search the change invalidated is redone. Moves, corner rule and
+// costs match pathSearchFind.
+//
+// Typical use per tick: dstarMoveStart when the agent moved, dstarCellChanged
+// for every cell that changed, then dstarPlan and dstarPath.
+
+typedef struct {
+    int cell;
+    int k1, k2;             // Priority, compared lexicographically
+} DStarEntry;
+
+typedef struct {
+    int width, height;
+    int* g;                 // Cost-to-goal estimate, thousandths of a step
+    int* rhs;               // One-step lookahead of g
+    int* heapPos;           // Position in the queue, -1 if not queued
+    unsigned int* stamp;    // Plan that last touched the cell; others read as unseen
+    unsigned int currentStamp;
+    DStarEntry* heap;       // Binary min-heap of inconsistent cells
+    int heapSize;
+    int startX, startY, goalX, goalY;
+    int lastX, lastY;       // Start when the key modifier was last updated
+    int km;                 // Key modifier accumulated from agent moves
+    int touched;            // Cells updated or expanded since the last dstarPlan
+    int nodesTouched;       // Stats for the last repair: changes plus replanning
+    int nodesExpanded;
+} DStarPlanner;
+
+void dstarInit(DStarPlanner* planner, int width, int height);
+void dstarFree(DStarPlanner* planner);
+
+// Forgets all search state and plans from scratch on the next dstarPlan
+void dstarReset(DStarPlanner* planner, int startX, int startY, int goalX, int goalY);
+
+// The agent now stands on (x, y)
+void dstarMoveStart(DStarPlanner* planner, int x, int y);
+
+// Cell (x, y) of grid was blocked or cleared since the last plan
+void dstarCellChanged(DStarPlanner* planner, const SpaceGrid* grid, int x, int y);
+
+// Repairs the search; returns true if the goal is reachable from the start
+bool dstarPlan(DStarPlanner* planner, const SpaceGrid* grid);
+
+// Cost of the current plan from the start, or a negative value if unreachable
+float dstarPathCost(const DStarPlanner* planner);
+
+// Follows the plan from the start to the goal. Returns the number of cells,
+// start and goal included, or -1 if unreachable; up to maxPath are written.
+int dstarPath(const DStarPlanner* planner, const SpaceGrid* grid, Point* path, int maxPath);
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef FAST_TRIG_H
+#define FAST_TRIG_H
+
+#include <math.h>
+
+// Trigonometry for drawing. fastSin and fastCos are accurate to about 1e-3
+// without libm, plenty for wobbles, pulses and positions in pixels.
+// UnitCircle<N> holds the cosine and sine of 2 * pi * j / N for j = 0..N,
+// worked out by the compiler, so an N-sided fan or loop reads its directions
+// from a table; one turned by an angle costs a single rotation per shape.
+
+#define TRIG_TWO_PI 6.28318531f
+#define TRIG_INV_TWO_PI 0.159154943f
+#define TRIG_HALF_PI 1.57079633f
+
+// Sine to about 1e-3 without branches or libm. Reduces to [-pi, pi) by whole
+// turns, then a parabola refined by its own square.
+static inline float fastSin(float x) {
+    float t = x * TRIG_INV_TWO_PI + 0.5f;
+    int turns = (int)t;
+    turns -= t < (float)turns;
+    float r = x - (float)turns * TRIG_TWO_PI;
+    float y = 1.27323954f * r - 0.405284735f * r * fabsf(r);
+    return 0.225f * (y * fabsf(y) - y) + y;
+}
+
+static inline float fastCos(float x) {
+    return fastSin(x + TRIG_HALF_PI);
+}
+
+// The last entry repeats the first, so a closed fan runs j = 0..N
+template <int N> struct UnitCircle { float cos[N + 1], sin[N + 1]; };
+
+// Taylor series after folding into [-pi, pi], for tables only
+constexpr double seriesSin(double x) {
+    const double pi = 3.14159265358979323846;
+    while (x > pi) x -= 2.0 * pi;
+    while (x < -pi) x += 2.0 * pi;
+    double term = x, sum = x;
+    for (int k = 1; k < 14; k++) {
+        term *= -x * x / ((2.0 * k) * (2.0 * k + 1.0));
+        sum += term;
+    }
+    return sum;
+}
+
+template <int N> constexpr UnitCircle<N> makeUnitCircle() {
+    UnitCircle<N> circle = {};
+    for (int j = 0; j <= N; j++) {
+        double angle = 2.0 * 3.14159265358979323846 * (j % N) / N;
+        circle.cos[j] = (float)seriesSin(angle + 1.57079632679489661923);
+        circle.sin[j] = (float)seriesSin(angle);
+    }
+    return circle;
+}
+
+static_assert(makeUnitCircle<4>().cos[2] == -1.0f && makeUnitCircle<4>().sin[1] == 1.0f, "unit circle series is off");
+
+template <int N> static inline const UnitCircle<N>& unitCircle(void) {
+    static constexpr UnitCircle<N> circle = makeUnitCircle<N>();
+    return circle;
+}
+
+// Direction j of a table turned by an angle, given as that angle's cosine and sine
+template <int N> static inline void unitCircleTurned(const UnitCircle<N>& circle, int j, float turnCos, float turnSin,
+    float* x, float* y) {
+    *x = circle.cos[j] * turnCos - circle.sin[j] * turnSin;
+    *y = circle.sin[j] * turnCos + circle.cos[j] * turnSin;
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef FRAME_CLOCK_H
+#define FRAME_CLOCK_H
+
+#include <stdint.h>
+#include <chrono>
+
+// Monotonic nanosecond clock and a fixed-timestep accumulator. Elapsed time
+// is banked in whole nanoseconds and paid out as ticks of exactly stepNs, so
+// the simulation runs at its own rate however often or late the caller gets
+// to run: a slow frame is followed by several ticks, a fast one by none, and
+// the fraction of a tick left over says how far to blend between the last two
+// simulated states when drawing.
+
+#define FRAME_CLOCK_MAX_CATCH_UP 8 // Ticks run per advance; the rest waits for the next frame
+
+static inline int64_t clockNowNs(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+typedef struct {
+    int64_t stepNs;         // Length of one tick
+    int64_t lastNs;         // Clock reading of the previous advance
+    int64_t bankedNs;       // Time not yet paid out as ticks
+    long long ticks;        // Ticks paid out since start
+    long long lateFrames;   // Advances that could not pay out every tick due
+} FixedTimestep;
+
+static inline void fixedStepStart(FixedTimestep* fs, int ticksPerSecond, int64_t nowNs) {
+    fs->stepNs = 1000000000ll / ticksPerSecond;
+    fs->lastNs = nowNs;
+    fs->bankedNs = 0;
+    fs->ticks = fs->lateFrames = 0;
+}
+
+// Banks the time since the last call and returns the ticks to run now. At
+// most FRAME_CLOCK_MAX_CATCH_UP are paid out at once so a long stall cannot
+// freeze drawing; the remainder stays banked, never dropped.
+static inline int fixedStepAdvance(FixedTimestep* fs, int64_t nowNs) {
+    fs->bankedNs += nowNs - fs->lastNs;
+    fs->lastNs = nowNs;
+    int64_t due = fs->bankedNs / fs->stepNs;
+    if (due > FRAME_CLOCK_MAX_CATCH_UP) { due = FRAME_CLOCK_MAX_CATCH_UP; fs->lateFrames++; }
+    fs->bankedNs -= due * fs->stepNs;
+    fs->ticks += due;
+    return (int)due;
+}
+
+// How far (0 to 1) the clock has moved past the last tick paid out
+static inline float fixedStepBlend(const FixedTimestep* fs) {
+    float blend = (float)fs->bankedNs / (float)fs->stepNs;
+    return blend < 1.0f ? blend : 1.0f;
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "frame_profiler.h"
+#include <string.h>
+#include <algorithm>
+
+void frameProfilerInit(FrameProfiler* profiler, const char* const* names, int passCount) {
+    memset(profiler, 0, sizeof(*profiler));
+    profiler->passCount = passCount < PROFILER_MAX_PASSES ? passCount : PROFILER_MAX_PASSES;
+    for (int i = 0; i < profiler->passCount; i++) profiler->names[i] = names[i];
+    profiler->lastEndNs = clockNowNs();
+}
+
+void frameProfilerFree(FrameProfiler* profiler) {
+    frameProfilerStopCsv(profiler);
+}
+
+void frameProfilerEndFrame(FrameProfiler* profiler) {
+    int64_t now = clockNowNs();
+    int slot = profiler->head;
+    int64_t workNs = 0;
+    for (int i = 0; i < profiler->passCount; i++) {
+        profiler->passUs[i][slot] = profiler->passNs[i] * 1e-3f;
+        workNs += profiler->passNs[i];
+    }
+    profiler->intervalUs[slot] = (now - profiler->lastEndNs) * 1e-3f;
+    profiler->workUs[slot] = workNs * 1e-3f;
+    profiler->drawHistory[slot] = (float)profiler->draws;
+    profiler->shapeHistory[slot] = (float)profiler->shapes;
+    profiler->vertexHistory[slot] = (float)profiler->vertices;
+
+    if (profiler->csv) {
+        FILE* csv = profiler->csv;
+        fprintf(csv, "%lld,%.1f,%.1f", profiler->frames, profiler->intervalUs[slot], profiler->workUs[slot]);
+        for (int i = 0; i < profiler->passCount; i++) fprintf(csv, ",%.1f", profiler->passUs[i][slot]);
+        fprintf(csv, ",%d,%d,%d\n", profiler->draws, profiler->shapes, profiler->vertices);
+        profiler->csvRows++;
+    }
+
+    profiler->head = (slot + 1) % PROFILER_HISTORY;
+    if (profiler->filled < PROFILER_HISTORY) profiler->filled++;
+    profiler->frames++;
+    profiler->lastEndNs = now;
+    memset(profiler->passNs, 0, sizeof(profiler->passNs));
+    profiler->draws = profiler->shapes = profiler->vertices = 0;
+}
+
+static ProfilePercentiles percentiles(const float* history, int count) {
+    ProfilePercentiles result = { 0.0f, 0.0f, 0.0f, 0.0f };
+    if (count == 0) return result;
+    float sorted[PROFILER_HISTORY];
+    memcpy(sorted, history, count * sizeof(float));
+    std::sort(sorted, sorted + count);
+    result.p50 = sorted[(count - 1) / 2];
+    result.p95 = sorted[(int)((count - 1) * 0.95f)];
+    result.p99 = sorted[(int)((count - 1) * 0.99f)];
+    result.max = sorted[count - 1];
+    return result;
+}
+
+void frameProfilerSummarize(const FrameProfiler* profiler, ProfileSummary* summary) {
+    // Until the ring wraps, the filled slots are the first ones
+    int count = profiler->filled;
+    summary->frames = count;
+    summary->interval = percentiles(profiler->intervalUs, count);
+    summary->work = percentiles(profiler->workUs, count);
+    for (int i = 0; i < profiler->passCount; i++) summary->pass[i] = percentiles(profiler->passUs[i], count);
+    summary->draws = percentiles(profiler->drawHistory, count);
+    summary->shapes = percentiles(profiler->shapeHistory, count);
+    summary->vertices = percentiles(profiler->vertexHistory, count);
+}
+
+bool frameProfilerStartCsv(FrameProfiler* profiler, const char* path) {
+    frameProfilerStopCsv(profiler);
+    profiler->csv = fopen(path, "w");
+    if (!profiler->csv) return false;
+    fprintf(profiler->csv, "frame,interval_us,work_us");
+    for (int i = 0; i < profiler->passCount; i++) fprintf(profiler->csv, ",%s_us", profiler->names[i]);
+    fprintf(profiler->csv, ",draws,shapes,vertices\n");
+    profiler->csvRows = 0;
+    return true;
+}
+
+void frameProfilerStopCsv(FrameProfiler* profiler) {
+    if (!profiler->csv) return;
+    fclose(profiler->csv);
+    profiler->csv = NULL;
+}
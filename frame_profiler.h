@@ -0,0 +1,79 @@
+#ifndef FRAME_PROFILER_H
+#define FRAME_PROFILER_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include "frame_clock.h"
+
+// Per-frame time of named passes, plus draw call, shape and vertex counts. The last
+// PROFILER_HISTORY frames are kept for rolling percentiles, and every frame
+// can be written as one CSV row. A timer is two clock reads and an add,
+// cheap enough to leave on all the time.
+//
+// A frame ends at frameProfilerEndFrame. Passes timed between two ends, such
+// as simulation ticks run before a frame is drawn, count towards the frame
+// that ends next.
+
+#define PROFILER_MAX_PASSES 16
+#define PROFILER_HISTORY 256    // Frames kept for percentiles
+
+typedef struct { float p50, p95, p99, max; } ProfilePercentiles;
+
+typedef struct {
+    int frames;                         // Frames the percentiles cover
+    ProfilePercentiles interval;        // Microseconds from one frame end to the next
+    ProfilePercentiles work;            // Microseconds in all passes of a frame
+    ProfilePercentiles pass[PROFILER_MAX_PASSES];
+    ProfilePercentiles draws, shapes, vertices;
+} ProfileSummary;
+
+typedef struct {
+    int passCount;
+    const char* names[PROFILER_MAX_PASSES];
+    int64_t passNs[PROFILER_MAX_PASSES];    // Current frame so far
+    int draws, vertices;                    // Current frame so far; counted by the renderer
+    int shapes;                             // Shapes the draws were batched from
+    int64_t lastEndNs;
+
+    // Ring of finished frames, in microseconds
+    float intervalUs[PROFILER_HISTORY], workUs[PROFILER_HISTORY];
+    float passUs[PROFILER_MAX_PASSES][PROFILER_HISTORY];
+    float drawHistory[PROFILER_HISTORY], shapeHistory[PROFILER_HISTORY], vertexHistory[PROFILER_HISTORY];
+    int head, filled;
+    long long frames;       // Frames ended since init
+
+    FILE* csv;              // Open while recording
+    long long csvRows;
+} FrameProfiler;
+
+// names must outlive the profiler (string literals)
+void frameProfilerInit(FrameProfiler* profiler, const char* const* names, int passCount);
+void frameProfilerFree(FrameProfiler* profiler);
+
+static inline void frameProfilerAdd(FrameProfiler* profiler, int pass, int64_t ns) {
+    profiler->passNs[pass] += ns;
+}
+
+// Adds the time until the end of the enclosing block to a pass
+struct ProfileScope {
+    FrameProfiler* profiler;
+    int pass;
+    int64_t start;
+    ProfileScope(FrameProfiler* p, int passIndex) : profiler(p), pass(passIndex), start(clockNowNs()) {}
+    ~ProfileScope() { frameProfilerAdd(profiler, pass, clockNowNs() - start); }
+};
+
+// Closes the frame: moves its times and counters into the history and the CSV
+void frameProfilerEndFrame(FrameProfiler* profiler);
+
+// Percentiles over the history; takes a few tens of microseconds, so callers
+// drawing an overlay refresh it every few frames
+void frameProfilerSummarize(const FrameProfiler* profiler, ProfileSummary* summary);
+
+// Starts writing one row per frame to path, replacing the file; false if it
+// cannot be created
+bool frameProfilerStartCsv(FrameProfiler* profiler, const char* path);
+void frameProfilerStopCsv(FrameProfiler* profiler);
+
+#endif
@@ -0,0 +1,614 @@
+#include "game_world.h"
+#include "pathfinding.h"
+#include "bitboard.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+// Utility macro
+#define min(a,b) ((a) < (b) ? (a) : (b))
+
+// Per-thread scratch, released when the thread exits so generation workers don't leak
+struct ThreadScratch {
+    PathSearchContext search;
+    Bitboard flood;
+    ~ThreadScratch() {
+        if (search.heap) pathSearchFree(&search);
+        if (flood.open) bitboardFree(&flood);
+    }
+};
+static thread_local ThreadScratch threadScratch;
+
+// Path finding and map generation
+bool pathfindAStar(const MapLayout* map, int startX, int startY, int goalX, int goalY) {
+    // One reusable search context per thread, resized with the playfield
+    PathSearchContext* searchContext = &threadScratch.search;
+    if (searchContext->width != map->grid.width || searchContext->height != map->grid.height) {
+        if (searchContext->heap) pathSearchFree(searchContext);
+        pathSearchInit(searchContext, map->grid.width, map->grid.height);
+    }
+    return pathSearchFind(searchContext, &map->grid, startX, startY, goalX, goalY, NULL, 0) >= 0;
+}
+
+// Flood from the start for the map, one per thread, redone only when the grid
+// has changed since the last call. The player moves between neighbouring free
+// cells both ways, so anything in the start's flood can also reach the exit
+// whenever the exit is in it.
+static const Bitboard* mapFlood(const MapLayout* map) {
+    bitboardUpdate(&threadScratch.flood, &map->grid, PLAYER_START_X, PLAYER_START_Y);
+    return &threadScratch.flood;
+}
+
+void generateRandomMap(MapLayout* map, DifficultyLevel difficulty, RngStream* rng) {
+    const int width = map->grid.width, height = map->grid.height;
+    // Initialize all cells as safe
+    spaceGridClear(&map->grid);
+
+    // Create asteroid fields based on difficulty
+    int numAsteroidFields;
+    switch (difficulty) {
+    case DIFFICULTY_EASY: numAsteroidFields = width * height / 8; break;
+    case DIFFICULTY_MEDIUM: numAsteroidFields = width * height / 6; break;
+    case DIFFICULTY_HARD: numAsteroidFields = width * height / 4; break;
+    default: numAsteroidFields = width * height / 6;
+    }
+
+    // Create large asteroid clusters
+    for (int i = 0; i < numAsteroidFields / 4; i++) {
+        int centerX = 3 + rngRange(rng, width - 6);
+        int centerY = 3 + rngRange(rng, height - 6);
+        int radius = 1 + rngRange(rng, 2);
+
+        for (int y = centerY - radius; y <= centerY + radius; y++) {
+            for (int x = centerX - radius; x <= centerX + radius; x++) {
+                if (x >= 0 && x < width && y >= 0 && y < height) {
+                    // Don't block starting area or exit area
+                    if (!(x <= 3 && y <= 3) && !(x >= width - 4 && y >= height - 4)) {
+                        if (rngRange(rng, 100) < 60) spaceGridSet(&map->grid, x, y, true);
+                    }
+                }
+            }
+        }
+    }
+
+    // Add some scattered smaller asteroids
+    for (int i = 0; i < numAsteroidFields * 3 / 4; i++) {
+        int x = rngRange(rng, width), y = rngRange(rng, height);
+        // Don't block starting area or exit area
+        if (!(x <= 3 && y <= 3) && !(x >= width - 4 && y >= height - 4)) {
+            spaceGridSet(&map->grid, x, y, true);
+        }
+    }
+
+    // Ensure starting area is safe
+    for (int y = 0; y <= 3; y++) {
+        for (int x = 0; x <= 3; x++) {
+            spaceGridSet(&map->grid, x, y, false);
+        }
+    }
+}
+
+int coinsForDifficulty(DifficultyLevel difficulty) {
+    switch (difficulty) {
+    case DIFFICULTY_EASY: return MAX_COINS - 3;
+    case DIFFICULTY_MEDIUM: return MAX_COINS - 1;
+    case DIFFICULTY_HARD: return MAX_COINS;
+    default: return MAX_COINS - 1;
+    }
+}
+
+void placeCoins(MapLayout* map, DifficultyLevel difficulty, RngStream* rng) {
+    const int width = map->grid.width, height = map->grid.height;
+    // Adjust coin count based on difficulty
+    map->totalCoins = coinsForDifficulty(difficulty);
+
+    // Reset coins
+    for (int i = 0; i < MAX_COINS; i++) map->coins[i].active = false;
+
+    // One flood fill answers every "connected to start and exit" question below
+    const Bitboard* flood = mapFlood(map);
+    bool exitReachable = bitboardReached(flood, (int)map->exitX, (int)map->exitY);
+
+    // Try random placement
+    int coinsPlaced = 0, attempts = 0;
+    const int maxAttempts = 200;
+
+    while (coinsPlaced < map->totalCoins && attempts < maxAttempts) {
+        int x = rngRange(rng, width), y = rngRange(rng, height);
+
+        if (!spaceGridBlocked(&map->grid, x, y)) {
+            float distFromStart = sqrt(pow(x - 1, 2) + pow(y - 1, 2));
+            float distFromExit = sqrt(pow(x - (int)map->exitX, 2) + pow(y - (int)map->exitY, 2));
+
+            if (distFromStart > 2 && distFromExit > 2) {
+                if (exitReachable && bitboardReached(flood, x, y)) {
+                    // Check distance from other coins
+                    bool tooClose = false;
+                    for (int j = 0; j < coinsPlaced; j++) {
+                        if (map->coins[j].active) {
+                            float dist = sqrt(pow(x - (int)map->coins[j].x, 2) + pow(y - (int)map->coins[j].y, 2));
+                            if (dist < 3) { tooClose = true; break; }
+                        }
+                    }
+
+                    if (!tooClose) {
+                        map->coins[coinsPlaced].x = x + 0.5f;
+                        map->coins[coinsPlaced].y = y + 0.5f;
+                        map->coins[coinsPlaced].active = true;
+                        coinsPlaced++;
+                    }
+                }
+            }
+        }
+        attempts++;
+    }
+
+    // If not all coins placed, try along the shortest route to the exit
+    if (coinsPlaced < map->totalCoins) {
+        Point* path = (Point*)malloc(width * height * sizeof(Point));
+        int pathLength = bitboardRoute(flood, (int)map->exitX, (int)map->exitY, path, width * height);
+
+        // Use path to place remaining coins
+        if (pathLength > 0) {
+            // Place coins evenly
+            int coinsLeft = map->totalCoins - coinsPlaced;
+            if (coinsLeft > 0 && pathLength > 4) {
+                int interval = pathLength / (coinsLeft + 1);
+                if (interval < 1) interval = 1;
+
+                for (int i = 1; i <= coinsLeft && coinsPlaced < map->totalCoins; i++) {
+                    int pathIndex = i * interval;
+                    if (pathIndex < pathLength) {
+                        int x = path[pathIndex].x, y = path[pathIndex].y;
+
+                        // Check if spot is available
+                        bool isFree = true;
+                        for (int j = 0; j < coinsPlaced; j++) {
+                            if (map->coins[j].active && (int)map->coins[j].x == x && (int)map->coins[j].y == y) {
+                                isFree = false; break;
+                            }
+                        }
+
+                        if (isFree) {
+                            map->coins[coinsPlaced].x = x + 0.5f;
+                            map->coins[coinsPlaced].y = y + 0.5f;
+                            map->coins[coinsPlaced].active = true;
+                            coinsPlaced++;
+                        }
+                    }
+                }
+            }
+        }
+        free(path);
+    }
+    // Update actual count
+    map->totalCoins = coinsPlaced;
+}
+
+void findValidExit(MapLayout* map, DifficultyLevel difficulty, RngStream* rng) {
+    const int width = map->grid.width, height = map->grid.height;
+    int attempts = 0;
+    const int maxAttempts = 100;
+
+    // Set minimum distance based on difficulty
+    float minDistance;
+    switch (difficulty) {
+    case DIFFICULTY_EASY: minDistance = width / 3; break;
+    case DIFFICULTY_MEDIUM: minDistance = width / 2.5; break;
+    case DIFFICULTY_HARD: minDistance = width / 2; break;
+    default: minDistance = width / 2.5;
+    }
+
+    // Try to place exit
+    while (attempts < maxAttempts) {
+        int x = width / 2 + rngRange(rng, width / 2 - 2);
+        int y = height / 2 + rngRange(rng, height / 2 - 2);
+        float distFromStart = sqrt(pow(x - 1, 2) + pow(y - 1, 2));
+
+        if (!spaceGridBlocked(&map->grid, x, y) && distFromStart > minDistance) {
+            map->exitX = x + 0.5f; map->exitY = y + 0.5f; return;
+        }
+        attempts++;
+    }
+
+    // Fallback - try on the far side from start
+    map->exitX = width - 3 + 0.5f; map->exitY = height - 3 + 0.5f;
+
+    // Make sure exit area is safe
+    int exitGridX = (int)map->exitX, exitGridY = (int)map->exitY;
+    for (int y = exitGridY - 1; y <= exitGridY + 1; y++) {
+        for (int x = exitGridX - 1; x <= exitGridX + 1; x++) {
+            if (x >= 0 && x < width && y >= 0 && y < height) {
+                spaceGridSet(&map->grid, x, y, false);
+            }
+        }
+    }
+}
+
+void createGuaranteedPath(MapLayout* map, RngStream* rng) {
+    const int width = map->grid.width, height = map->grid.height;
+    // Clear the map
+    spaceGridClear(&map->grid);
+
+    // Set exit position
+    map->exitX = width - 3 + 0.5f; map->exitY = height - 3 + 0.5f;
+
+    // Create a path from start to exit
+    int currentX = 1, currentY = 1, exitGridX = (int)map->exitX, exitGridY = (int)map->exitY;
+    // Every segment advances x or y, so width + height points always suffice
+    int (*pathPoints)[2] = (int(*)[2])malloc((width + height + 2) * sizeof(*pathPoints));
+    int pathLength = 0;
+
+    // Add start point
+    pathPoints[pathLength][0] = currentX; pathPoints[pathLength][1] = currentY; pathLength++;
+
+    // Create path segments
+    while (currentX < exitGridX || currentY < exitGridY) {
+        bool moveHorizontalFirst = (rngRange(rng, 2) == 0);
+
+        if (moveHorizontalFirst) {
+            if (currentX < exitGridX) currentX += 1 + rngRange(rng, 2);
+            if (currentY < exitGridY) currentY += 1 + rngRange(rng, 2);
+        }
+        else {
+            if (currentY < exitGridY) currentY += 1 + rngRange(rng, 2);
+            if (currentX < exitGridX) currentX += 1 + rngRange(rng, 2);
+        }
+
+        // Keep in bounds
+        currentX = min(currentX, width - 2);
+        currentY = min(currentY, height - 2);
+
+        // Add point to path
+        pathPoints[pathLength][0] = currentX; pathPoints[pathLength][1] = currentY; pathLength++;
+
+        // Add random obstacles near the path
+        if (rngRange(rng, 3) == 0) {
+            for (int y = currentY - 3; y <= currentY + 3; y++) {
+                for (int x = currentX - 3; x <= currentX + 3; x++) {
+                    if (x >= 0 && x < width && y >= 0 && y < height) {
+                        if (abs(x - currentX) > 1 || abs(y - currentY) > 1) {
+                            if (rngRange(rng, 100) < 30) spaceGridSet(&map->grid, x, y, true);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Add exit point
+    pathPoints[pathLength][0] = exitGridX; pathPoints[pathLength][1] = exitGridY; pathLength++;
+
+    // Clear the path for passability
+    for (int i = 0; i < pathLength; i++) {
+        int x = pathPoints[i][0], y = pathPoints[i][1];
+        for (int ny = y - 1; ny <= y + 1; ny++) {
+            for (int nx = x - 1; nx <= x + 1; nx++) {
+                if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
+                    spaceGridSet(&map->grid, nx, ny, false);
+                }
+            }
+        }
+    }
+
+    // Place coins along the path
+    map->totalCoins = min(pathLength - 2, MAX_COINS);
+
+    for (int i = 0; i < MAX_COINS; i++) map->coins[i].active = false;
+
+    for (int i = 0; i < map->totalCoins; i++) {
+        int pathIndex = 1 + i * (pathLength - 2) / map->totalCoins;
+        if (pathIndex >= pathLength - 1) pathIndex = pathLength - 2;
+
+        map->coins[i].x = pathPoints[pathIndex][0] + 0.5f;
+        map->coins[i].y = pathPoints[pathIndex][1] + 0.5f;
+        map->coins[i].active = true;
+    }
+    free(pathPoints);
+    map->pathExists = verifyAllPathsExist(map);
+}
+
+bool verifyAllPathsExist(const MapLayout* map) {
+    const Bitboard* flood = mapFlood(map);
+
+    // Check if exit is reachable from start
+    if (!bitboardReached(flood, (int)map->exitX, (int)map->exitY)) return false;
+
+    // Check if all coins are reachable
+    for (int i = 0; i < map->totalCoins; i++) {
+        if (map->coins[i].active && !bitboardReached(flood, (int)map->coins[i].x, (int)map->coins[i].y)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// One random attempt; every attempt draws from its own stream, so a seed always
+// yields the same layout whichever thread runs it
+static bool generateAttempt(MapLayout* map, DifficultyLevel difficulty, uint64_t seed, int attempt) {
+    RngStream rng;
+    rngSeed(&rng, rngDeriveSeed(seed, attempt));
+    generateRandomMap(map, difficulty, &rng);
+    findValidExit(map, difficulty, &rng);
+    placeCoins(map, difficulty, &rng);
+    map->attempt = attempt;
+    return verifyAllPathsExist(map);
+}
+
+// Speculative attempts on all cores. Workers claim attempt indices in order
+// and stop once a lower index has succeeded, so the winner is always the
+// lowest valid index, the same layout a sequential loop would return.
+static int generateParallel(MapLayout* map, DifficultyLevel difficulty, uint64_t seed) {
+    int threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > MAP_GEN_MAX_THREADS) threadCount = MAP_GEN_MAX_THREADS;
+    if (threadCount > MAP_GEN_MAX_ATTEMPTS) threadCount = MAP_GEN_MAX_ATTEMPTS;
+
+    std::atomic<int> nextAttempt(0), winner(MAP_GEN_MAX_ATTEMPTS);
+    MapLayout scratch[MAP_GEN_MAX_THREADS];
+    int found[MAP_GEN_MAX_THREADS];
+
+    auto worker = [&](int index) {
+        found[index] = -1;
+        mapLayoutInit(&scratch[index], map->grid.width, map->grid.height);
+        for (;;) {
+            int attempt = nextAttempt.fetch_add(1);
+            if (attempt >= winner.load()) break; // Also covers the attempt budget
+            if (generateAttempt(&scratch[index], difficulty, seed, attempt)) {
+                found[index] = attempt;
+                int best = winner.load();
+                while (attempt < best && !winner.compare_exchange_weak(best, attempt)) {}
+                break; // Later claims from this worker can only be higher
+            }
+        }
+    };
+
+    // The calling thread works too
+    std::thread threads[MAP_GEN_MAX_THREADS];
+    for (int i = 1; i < threadCount; i++) threads[i] = std::thread(worker, i);
+    worker(0);
+    for (int i = 1; i < threadCount; i++) threads[i].join();
+
+    int best = winner.load();
+    for (int i = 0; i < threadCount; i++) {
+        if (found[i] == best) mapLayoutCopy(map, &scratch[i]);
+        mapLayoutFree(&scratch[i]);
+    }
+    return best < MAP_GEN_MAX_ATTEMPTS ? best : -1;
+}
+
+void generateEnvironment(MapLayout* map, DifficultyLevel difficulty, bool guaranteePath, uint64_t seed) {
+    RngStream rng;
+    map->seed = seed;
+    if (guaranteePath) {
+        rngSeed(&rng, seed);
+        createGuaranteedPath(map, &rng);
+        map->attempt = -1;
+        return;
+    }
+
+    // Small maps take microseconds per attempt, less than waking a thread
+    int winner = -1;
+    if (map->grid.width * map->grid.height >= MAP_GEN_PARALLEL_CELLS) {
+        winner = generateParallel(map, difficulty, seed);
+    }
+    else {
+        for (int attempt = 0; attempt < MAP_GEN_MAX_ATTEMPTS && winner < 0; attempt++) {
+            if (generateAttempt(map, difficulty, seed, attempt)) winner = attempt;
+        }
+    }
+    if (winner >= 0) {
+        map->pathExists = true;
+        map->seed = seed;
+        return;
+    }
+
+    // If all attempts failed, create a guaranteed path
+    rngSeed(&rng, rngDeriveSeed(seed, MAP_GEN_MAX_ATTEMPTS));
+    createGuaranteedPath(map, &rng);
+    map->attempt = -1;
+}
+
+// World lifecycle
+DifficultyRules difficultyRules(DifficultyLevel difficulty) {
+    DifficultyRules rules;
+    switch (difficulty) {
+    case DIFFICULTY_EASY:
+        rules.timeLimit = 60;
+        rules.lightDecayRate = LIGHT_DECAY_RATE * 0.6f; // Much slower light depletion
+        rules.coinLightBoost = MAX_LIGHT_DURATION * 0.25f;
+        break;
+    case DIFFICULTY_HARD:
+        rules.timeLimit = 30;
+        rules.lightDecayRate = LIGHT_DECAY_RATE * 1.5f; // Faster light depletion
+        rules.coinLightBoost = MAX_LIGHT_DURATION * 0.15f;
+        break;
+    default:
+        rules.timeLimit = 45;
+        rules.lightDecayRate = LIGHT_DECAY_RATE * 1.0f; // Medium light depletion
+        rules.coinLightBoost = MAX_LIGHT_DURATION * 0.2f;
+        break;
+    }
+    return rules;
+}
+
+void gameWorldApplyDifficulty(GameWorld* world, DifficultyLevel difficulty) {
+    DifficultyRules rules = difficultyRules(difficulty);
+    world->difficulty = difficulty;
+    world->timeLimit = rules.timeLimit;
+    world->lightDecayRate = rules.lightDecayRate;
+}
+
+static void resetPlayer(GameWorld* world) {
+    world->gameTime = 0;
+    trailClear(&world->trail);
+    world->tickAccumulator = 0.0f;
+    world->tickCount = 0;
+    world->player.x = PLAYER_START_X + 0.5f;
+    world->player.y = PLAYER_START_Y + 0.5f;
+    world->player.light = MAX_LIGHT_DURATION;
+    world->player.coinsCollected = 0;
+    world->player.moves = 0;
+    gameWorldAddTrailPoint(world, world->player.x, world->player.y);
+}
+
+// Files the map's coins and exit for collision queries
+static void registerEntities(GameWorld* world) {
+    spatialHashClear(&world->entities);
+    for (int i = 0; i < world->map.totalCoins; i++) {
+        const Coin* coin = &world->map.coins[i];
+        if (coin->active) spatialHashInsert(&world->entities, ENTITY_COIN, i, coin->x, coin->y, 0.0f);
+    }
+    spatialHashInsert(&world->entities, ENTITY_EXIT, 0, world->map.exitX, world->map.exitY, 0.0f);
+}
+
+void mapLayoutInit(MapLayout* map, int width, int height) {
+    memset(map, 0, sizeof(*map));
+    if (width < MIN_GRID_SIZE) width = MIN_GRID_SIZE;
+    if (height < MIN_GRID_SIZE) height = MIN_GRID_SIZE;
+    spaceGridInit(&map->grid, width, height);
+}
+
+void mapLayoutFree(MapLayout* map) {
+    spaceGridFree(&map->grid);
+}
+
+void mapLayoutCopy(MapLayout* dst, const MapLayout* src) {
+    SpaceGrid grid = dst->grid;
+    *dst = *src;
+    dst->grid = grid;
+    spaceGridCopy(&dst->grid, &src->grid);
+}
+
+void gameWorldInit(GameWorld* world, DifficultyLevel difficulty, int width, int height, uint64_t seed) {
+    memset(world, 0, sizeof(*world));
+    mapLayoutInit(&world->map, width, height);
+    spatialHashInit(&world->entities, MAX_COINS + 1, 1.0f);
+    world->seed = seed;
+    rngSeed(&world->mapSeeds, rngDeriveSeed(seed, RNG_STREAM_MAPGEN));
+    world->state = GAME_MENU;
+    gameWorldApplyDifficulty(world, difficulty);
+    generateEnvironment(&world->map, difficulty, false, rngNext(&world->mapSeeds));
+    resetPlayer(world);
+    registerEntities(world);
+}
+
+void gameWorldFree(GameWorld* world) {
+    spatialHashFree(&world->entities);
+    mapLayoutFree(&world->map);
+}
+
+void gameWorldStartGame(GameWorld* world, DifficultyLevel difficulty) {
+    gameWorldApplyDifficulty(world, difficulty);
+    resetPlayer(world);
+    registerEntities(world);
+    world->state = GAME_PLAYING;
+}
+
+void gameWorldNewGame(GameWorld* world, DifficultyLevel difficulty) {
+    generateEnvironment(&world->map, difficulty, false, rngNext(&world->mapSeeds));
+    gameWorldStartGame(world, difficulty);
+}
+
+// Game mechanics
+void gameWorldAddTrailPoint(GameWorld* world, float x, float y) {
+    trailPush(&world->trail, x, y, world->tickCount);
+}
+
+bool gameWorldIsValidMove(const GameWorld* world, float x, float y) {
+    if (x < 0 || x >= world->map.grid.width || y < 0 || y >= world->map.grid.height) return false;
+    return !spaceGridBlocked(&world->map.grid, (int)x, (int)y);
+}
+
+#define NEARBY_MAX 32
+
+static int checkCoinCollision(GameWorld* world) {
+    int events = GAME_EVENT_NONE;
+    Player* player = &world->player;
+    int nearby[NEARBY_MAX], found;
+    do {
+        // Collected coins leave the hash, so a crowded spot drains over repeated queries
+        found = spatialHashQuery(&world->entities, player->x, player->y, PICKUP_RADIUS, nearby, NEARBY_MAX);
+        int collected = 0;
+        for (int i = 0; i < found && i < NEARBY_MAX; i++) {
+            const SpatialEntity* entity = spatialHashEntity(&world->entities, nearby[i]);
+            if (entity->kind != ENTITY_COIN) continue;
+            world->map.coins[entity->index].active = false;
+            spatialHashRemove(&world->entities, nearby[i]);
+            player->coinsCollected++;
+            collected++;
+            events |= GAME_EVENT_COIN_COLLECTED;
+
+            // Energy boost based on difficulty
+            player->light += difficultyRules(world->difficulty).coinLightBoost;
+            if (player->light > MAX_LIGHT_DURATION) player->light = MAX_LIGHT_DURATION;
+        }
+        if (collected == 0) break;
+    } while (found > NEARBY_MAX);
+    return events;
+}
+
+static int checkWinCondition(GameWorld* world) {
+    // A single known entity, no broadphase needed
+    float dx = world->player.x - world->map.exitX, dy = world->player.y - world->map.exitY;
+    if (dx * dx + dy * dy < PICKUP_RADIUS * PICKUP_RADIUS && world->player.coinsCollected == world->map.totalCoins) {
+        world->state = GAME_WIN;
+        return GAME_EVENT_WON;
+    }
+    return GAME_EVENT_NONE;
+}
+
+static int applyMove(GameWorld* world, MoveDirection move) {
+    float newX = world->player.x, newY = world->player.y;
+    switch (move) {
+    case MOVE_UP: newY -= 1.0f; break;
+    case MOVE_DOWN: newY += 1.0f; break;
+    case MOVE_LEFT: newX -= 1.0f; break;
+    case MOVE_RIGHT: newX += 1.0f; break;
+    default: return GAME_EVENT_NONE;
+    }
+
+    if (!gameWorldIsValidMove(world, newX, newY)) return GAME_EVENT_NONE;
+    world->player.x = newX; world->player.y = newY;
+    world->player.moves++;
+    gameWorldAddTrailPoint(world, newX, newY);
+    int events = GAME_EVENT_MOVED;
+    events |= checkCoinCollision(world);
+    events |= checkWinCondition(world);
+    return events;
+}
+
+static int simulateTick(GameWorld* world) {
+    // Whole seconds of mission time
+    world->tickCount++;
+    if (world->tickCount % SIM_TICKS_PER_SECOND == 0) world->gameTime++;
+
+    // Decrease player light
+    world->player.light -= world->lightDecayRate;
+
+    // Trail intensity follows from the tick count; only faded points need removing
+    trailExpire(&world->trail, world->tickCount);
+
+    // Check lose condition
+    if (world->player.light <= 0 || world->gameTime >= world->timeLimit) {
+        world->state = GAME_LOSE;
+        return GAME_EVENT_LOST;
+    }
+    return GAME_EVENT_NONE;
+}
+
+int gameWorldStep(GameWorld* world, const GameInput* input, float dt) {
+    if (world->state != GAME_PLAYING) return GAME_EVENT_NONE;
+
+    int events = GAME_EVENT_NONE;
+    if (input) events |= applyMove(world, input->move);
+
+    world->tickAccumulator += dt;
+    while (world->state == GAME_PLAYING && world->tickAccumulator >= SIM_TICK_SECONDS) {
+        world->tickAccumulator -= SIM_TICK_SECONDS;
+        events |= simulateTick(world);
+    }
+    return events;
+}
@@ -0,0 +1,116 @@
+#ifndef GAME_WORLD_H
+#define GAME_WORLD_H
+
+#include <stdbool.h>
+#include "space_grid.h"
+#include "spatial_hash.h"
+#include "trail.h"
+#include "rng.h"
+
+// Headless simulation core: map generation, player movement, light decay and
+// win/lose rules. Nothing in here touches GLUT or OpenGL, so it can be stepped
+// from the game window, a benchmark or a CI box without a GPU.
+
+// Constants
+#define DEFAULT_GRID_WIDTH 15
+#define DEFAULT_GRID_HEIGHT 15
+#define MIN_GRID_SIZE 8
+#define MAX_LIGHT_DURATION 100
+#define LIGHT_DECAY_RATE 0.5f
+#define MAX_COINS 10
+#define SIM_TICK_SECONDS 0.1f   // One light/trail decay step
+#define SIM_TICKS_PER_SECOND 10 // Ticks per gameTime second
+#define MAP_GEN_MAX_ATTEMPTS 64 // Random layouts tried before the guaranteed path
+#define MAP_GEN_PARALLEL_CELLS 4096 // Smallest map worth spreading attempts over threads
+#define MAP_GEN_MAX_THREADS 32
+#define PICKUP_RADIUS 0.7f      // Player reach for coins and the exit
+#define PLAYER_START_X 1        // Cell every game starts on
+#define PLAYER_START_Y 1
+
+// Events reported by gameWorldStep
+#define GAME_EVENT_NONE 0
+#define GAME_EVENT_MOVED 1
+#define GAME_EVENT_COIN_COLLECTED 2
+#define GAME_EVENT_WON 4
+#define GAME_EVENT_LOST 8
+
+// Enums
+typedef enum { GAME_MENU, GAME_PLAYING, GAME_WIN, GAME_LOSE } GameState;
+typedef enum { DIFFICULTY_EASY, DIFFICULTY_MEDIUM, DIFFICULTY_HARD } DifficultyLevel;
+typedef enum { MOVE_NONE, MOVE_UP, MOVE_DOWN, MOVE_LEFT, MOVE_RIGHT } MoveDirection;
+typedef enum { ENTITY_COIN, ENTITY_EXIT } EntityKind; // Kinds filed in GameWorld::entities
+
+// Structures
+typedef struct { int x, y; } Point;
+typedef struct { float x, y; float light; int coinsCollected; int moves; } Player;
+typedef struct { float x, y; bool active; } Coin;
+typedef struct { MoveDirection move; } GameInput;
+
+// What a difficulty changes once the map is made
+typedef struct {
+    int timeLimit;          // Seconds
+    float lightDecayRate;   // Light lost per tick
+    float coinLightBoost;   // Light a coin gives back, capped at MAX_LIGHT_DURATION
+} DifficultyRules;
+
+// Everything produced by map generation
+typedef struct {
+    SpaceGrid grid;
+    float exitX, exitY;
+    Coin coins[MAX_COINS];
+    int totalCoins;
+    bool pathExists;
+    uint64_t seed;          // Seed passed to generateEnvironment
+    int attempt;            // Attempt that produced the layout, -1 for the guaranteed path
+} MapLayout;
+
+typedef struct {
+    GameState state;
+    DifficultyLevel difficulty;
+    MapLayout map;
+    Player player;
+    SpatialHash entities;   // Collidable entities of the current game, tagged with EntityKind
+    Trail trail;            // Stamped with tickCount
+    int gameTime, timeLimit;
+    float lightDecayRate;   // Light lost per tick
+    float tickAccumulator;  // Unsimulated time carried between steps
+    int tickCount;          // Ticks simulated since the game started
+    uint64_t seed;          // Master seed from gameWorldInit
+    RngStream mapSeeds;     // Draws one map seed per new game
+} GameWorld;
+
+// Path finding and map generation
+bool pathfindAStar(const MapLayout* map, int startX, int startY, int goalX, int goalY);
+void generateRandomMap(MapLayout* map, DifficultyLevel difficulty, RngStream* rng);
+void findValidExit(MapLayout* map, DifficultyLevel difficulty, RngStream* rng);
+void placeCoins(MapLayout* map, DifficultyLevel difficulty, RngStream* rng);
+int coinsForDifficulty(DifficultyLevel difficulty); // Coins placeCoins aims for
+DifficultyRules difficultyRules(DifficultyLevel difficulty);
+void createGuaranteedPath(MapLayout* map, RngStream* rng);
+bool verifyAllPathsExist(const MapLayout* map);
+// The same seed, difficulty and grid size always give the same layout
+void generateEnvironment(MapLayout* map, DifficultyLevel difficulty, bool guaranteePath, uint64_t seed);
+
+// Map storage; layouts own their grid, so copy them with mapLayoutCopy
+void mapLayoutInit(MapLayout* map, int width, int height);
+void mapLayoutFree(MapLayout* map);
+void mapLayoutCopy(MapLayout* dst, const MapLayout* src);
+
+// World lifecycle
+// Map seeds for every game are drawn from the master seed's map generation stream
+void gameWorldInit(GameWorld* world, DifficultyLevel difficulty, int width, int height, uint64_t seed);
+void gameWorldFree(GameWorld* world);
+void gameWorldApplyDifficulty(GameWorld* world, DifficultyLevel difficulty);
+void gameWorldNewGame(GameWorld* world, DifficultyLevel difficulty);
+// Starts a game on the map already in world->map, e.g. one taken from a MapPool
+void gameWorldStartGame(GameWorld* world, DifficultyLevel difficulty);
+
+// Applies one input (may be NULL) and advances the simulation by dt seconds in
+// fixed SIM_TICK_SECONDS ticks. Returns a mask of GAME_EVENT_* flags.
+int gameWorldStep(GameWorld* world, const GameInput* input, float dt);
+
+// Game mechanics
+bool gameWorldIsValidMove(const GameWorld* world, float x, float y);
+void gameWorldAddTrailPoint(GameWorld* world, float x, float y);
+
+#endif
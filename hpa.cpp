@@ -0,0 +1,302 @@
+#include "hpa.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define DIAGONAL_COST 1.414f
+
+// Direction vectors (cardinals first, then diagonals)
+static const int dxDir[8] = { 0, 1, 0, -1, 1, 1, -1, -1 }, dyDir[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+static inline int clusterOf(const HpaGraph* hpa, int x, int y) {
+    return (y / HPA_CLUSTER_SIZE) * hpa->clustersX + x / HPA_CLUSTER_SIZE;
+}
+
+static void clusterBounds(const HpaGraph* hpa, int cluster, int* x0, int* y0, int* x1, int* y1) {
+    *x0 = (cluster % hpa->clustersX) * HPA_CLUSTER_SIZE;
+    *y0 = (cluster / hpa->clustersX) * HPA_CLUSTER_SIZE;
+    *x1 = (*x0 + HPA_CLUSTER_SIZE < hpa->width ? *x0 + HPA_CLUSTER_SIZE : hpa->width) - 1;
+    *y1 = (*y0 + HPA_CLUSTER_SIZE < hpa->height ? *y0 + HPA_CLUSTER_SIZE : hpa->height) - 1;
+}
+
+static inline int localIndex(int x, int y, int x0, int y0) {
+    return (y - y0) * HPA_CLUSTER_SIZE + (x - x0);
+}
+
+// Free cells of a cluster as row masks, bit i = column x0 + i; rows and
+// columns past the cluster's edge read as blocked
+static void loadClusterRows(const SpaceGrid* grid, int x0, int y0, int x1, int y1, uint32_t* rows) {
+    for (int ly = 0; ly < HPA_CLUSTER_SIZE; ly++) {
+        rows[ly] = 0;
+        if (y0 + ly > y1) continue;
+        for (int part = 0; part < HPA_CLUSTER_SIZE / GRID_TILE_SIZE; part++) {
+            int column = x0 + part * GRID_TILE_SIZE;
+            if (column > x1) break;
+            uint32_t bits = (uint8_t)~spaceGridRowByte(grid, column, y0 + ly);
+            if (x1 + 1 - column < GRID_TILE_SIZE) bits &= (1u << (x1 + 1 - column)) - 1;
+            rows[ly] |= bits << (part * GRID_TILE_SIZE);
+        }
+    }
+}
+
+static inline bool rowsOpen(const uint32_t* rows, int lx, int ly) {
+    return (unsigned)lx < HPA_CLUSTER_SIZE && (unsigned)ly < HPA_CLUSTER_SIZE && ((rows[ly] >> lx) & 1);
+}
+
+// Search confined to one cluster from cell: Dijkstra over the whole cluster
+// when goalCell is -1, otherwise A* that stops at goalCell
+static void localSearch(HpaGraph* hpa, const SpaceGrid* grid, int cluster, int fromCell, int goalCell) {
+    PathSearchContext* ctx = &hpa->local;
+    const int width = hpa->width;
+    int x0, y0, x1, y1;
+    clusterBounds(hpa, cluster, &x0, &y0, &x1, &y1);
+    uint32_t rows[HPA_CLUSTER_SIZE];
+    loadClusterRows(grid, x0, y0, x1, y1, rows);
+
+    // Local coordinates from here on
+    int goalX = goalCell % width - x0, goalY = goalCell / width - y0;
+    int goal = goalCell >= 0 ? localIndex(goalX, goalY, 0, 0) : -1;
+    int fromX = fromCell % width - x0, fromY = fromCell / width - y0;
+
+    pathSearchBegin(ctx);
+    pathSearchRelax(ctx, localIndex(fromX, fromY, 0, 0), -1, 0.0f,
+        goal >= 0 ? octileHeuristic(fromX, fromY, goalX, goalY) : 0.0f);
+    for (int current; (current = pathSearchPop(ctx)) >= 0;) {
+        if (current == goal) return;
+        int cx = current % HPA_CLUSTER_SIZE, cy = current / HPA_CLUSTER_SIZE;
+        for (int i = 0; i < 8; i++) {
+            int nx = cx + dxDir[i], ny = cy + dyDir[i];
+            if (!rowsOpen(rows, nx, ny)) continue;
+            if (i >= 4 && (!rowsOpen(rows, nx, cy) || !rowsOpen(rows, cx, ny))) continue;
+            pathSearchRelax(ctx, localIndex(nx, ny, 0, 0), current, ctx->g[current] + (i < 4 ? 1.0f : DIAGONAL_COST),
+                goal >= 0 ? octileHeuristic(nx, ny, goalX, goalY) : 0.0f);
+        }
+    }
+}
+
+// Distance to cell found by the last local search in cluster
+static float localCost(const HpaGraph* hpa, int cluster, int cell) {
+    const PathSearchContext* ctx = &hpa->local;
+    int x0, y0, x1, y1;
+    clusterBounds(hpa, cluster, &x0, &y0, &x1, &y1);
+    int i = localIndex(cell % hpa->width, cell / hpa->width, x0, y0);
+    return ctx->stamp[i] == ctx->currentStamp && ctx->state[i] == 2 ? ctx->g[i] : HPA_UNREACHABLE;
+}
+
+static int nodeSlot(const HpaCluster* cluster, int cell) {
+    for (int i = 0; i < cluster->count; i++)
+        if (cluster->cells[i] == cell) return i;
+    return -1;
+}
+
+static void addTransition(HpaCluster* cluster, int cell, int partner) {
+    int slot = nodeSlot(cluster, cell);
+    if (slot < 0) {
+        if (cluster->count == HPA_MAX_CLUSTER_NODES) return;
+        slot = cluster->count++;
+        cluster->cells[slot] = cell;
+        cluster->partners[slot][0] = cluster->partners[slot][1] = -1;
+    }
+    // A corner cell can border two neighbours
+    cluster->partners[slot][cluster->partners[slot][0] < 0 ? 0 : 1] = partner;
+}
+
+// Entrances along one side of length cells from (x, y), the neighbour lying
+// (acrossX, acrossY) away. Both clusters scan the border in the same order, so
+// they agree on where the transitions are.
+static void addSideEntrances(const HpaGraph* hpa, const SpaceGrid* grid, HpaCluster* cluster,
+    int x, int y, int stepX, int stepY, int length, int acrossX, int acrossY) {
+    const int width = hpa->width;
+    int runStart = -1;
+    for (int i = 0; i <= length; i++) {
+        int cx = x + i * stepX, cy = y + i * stepY;
+        bool open = i < length && !spaceGridBlocked(grid, cx, cy) && !spaceGridBlocked(grid, cx + acrossX, cy + acrossY);
+        if (open && runStart < 0) runStart = i;
+        if (open || runStart < 0) continue;
+
+        int run = i - runStart;
+        int ends[2] = { runStart + (run - 1) / 2, -1 };
+        if (run >= HPA_WIDE_ENTRANCE) { ends[0] = runStart; ends[1] = i - 1; }
+        for (int e = 0; e < 2 && ends[e] >= 0; e++) {
+            int ex = x + ends[e] * stepX, ey = y + ends[e] * stepY;
+            addTransition(cluster, ey * width + ex, (ey + acrossY) * width + ex + acrossX);
+        }
+        runStart = -1;
+    }
+}
+
+static void rebuildCluster(HpaGraph* hpa, const SpaceGrid* grid, int index) {
+    HpaCluster* cluster = &hpa->clusters[index];
+    int cx = index % hpa->clustersX, cy = index / hpa->clustersX;
+    int x0, y0, x1, y1;
+    clusterBounds(hpa, index, &x0, &y0, &x1, &y1);
+
+    cluster->count = 0;
+    if (cy > 0) addSideEntrances(hpa, grid, cluster, x0, y0, 1, 0, x1 - x0 + 1, 0, -1);
+    if (cx < hpa->clustersX - 1) addSideEntrances(hpa, grid, cluster, x1, y0, 0, 1, y1 - y0 + 1, 1, 0);
+    if (cy < hpa->clustersY - 1) addSideEntrances(hpa, grid, cluster, x0, y1, 1, 0, x1 - x0 + 1, 0, 1);
+    if (cx > 0) addSideEntrances(hpa, grid, cluster, x0, y0, 0, 1, y1 - y0 + 1, -1, 0);
+
+    // Distances are symmetric; one search per node fills its row and column
+    int n = cluster->count;
+    free(cluster->cost);
+    cluster->cost = n > 0 ? (float*)malloc(n * n * sizeof(float)) : NULL;
+    for (int i = 0; i < n; i++) {
+        cluster->cost[i * n + i] = 0.0f;
+        if (i == n - 1) break;
+        localSearch(hpa, grid, index, cluster->cells[i], -1);
+        for (int j = i + 1; j < n; j++)
+            cluster->cost[i * n + j] = cluster->cost[j * n + i] = localCost(hpa, index, cluster->cells[j]);
+    }
+    hpa->clustersRebuilt++;
+}
+
+void hpaInit(HpaGraph* hpa, const SpaceGrid* grid) {
+    hpa->width = grid->width; hpa->height = grid->height;
+    hpa->clustersX = (grid->width + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+    hpa->clustersY = (grid->height + HPA_CLUSTER_SIZE - 1) / HPA_CLUSTER_SIZE;
+    int clusterCount = hpa->clustersX * hpa->clustersY;
+    int nodes = clusterCount * HPA_MAX_CLUSTER_NODES + 2;
+    hpa->clusters = (HpaCluster*)calloc(clusterCount, sizeof(HpaCluster));
+    pathSearchInit(&hpa->abstract, nodes, 1);
+    pathSearchInit(&hpa->local, HPA_CLUSTER_SIZE, HPA_CLUSTER_SIZE);
+    hpa->route = (int*)malloc(nodes * sizeof(int));
+    hpa->routeLength = 0;
+    hpa->pathCost = 0.0f;
+    hpa->nodesExpanded = 0;
+    hpa->clustersRebuilt = 0;
+    for (int i = 0; i < clusterCount; i++) rebuildCluster(hpa, grid, i);
+}
+
+void hpaFree(HpaGraph* hpa) {
+    for (int i = 0; i < hpa->clustersX * hpa->clustersY; i++) free(hpa->clusters[i].cost);
+    free(hpa->clusters);
+    pathSearchFree(&hpa->abstract);
+    pathSearchFree(&hpa->local);
+    free(hpa->route);
+    memset(hpa, 0, sizeof(*hpa));
+}
+
+void hpaUpdateCell(HpaGraph* hpa, const SpaceGrid* grid, int x, int y) {
+    if (x < 0 || x >= hpa->width || y < 0 || y >= hpa->height) return;
+    int index = clusterOf(hpa, x, y);
+    int cx = index % hpa->clustersX, cy = index / hpa->clustersX;
+    rebuildCluster(hpa, grid, index);
+    // Entrances on a shared border belong to both sides
+    if (x % HPA_CLUSTER_SIZE == 0 && cx > 0) rebuildCluster(hpa, grid, index - 1);
+    if (x % HPA_CLUSTER_SIZE == HPA_CLUSTER_SIZE - 1 && cx < hpa->clustersX - 1) rebuildCluster(hpa, grid, index + 1);
+    if (y % HPA_CLUSTER_SIZE == 0 && cy > 0) rebuildCluster(hpa, grid, index - hpa->clustersX);
+    if (y % HPA_CLUSTER_SIZE == HPA_CLUSTER_SIZE - 1 && cy < hpa->clustersY - 1) rebuildCluster(hpa, grid, index + hpa->clustersX);
+}
+
+int hpaFindRoute(HpaGraph* hpa, const SpaceGrid* grid, int startX, int startY, int goalX, int goalY) {
+    const int width = hpa->width;
+    hpa->routeLength = 0;
+    hpa->pathCost = 0.0f;
+    hpa->nodesExpanded = 0;
+    if (grid->width != hpa->width || grid->height != hpa->height ||
+        !spaceGridInBounds(grid, startX, startY) || !spaceGridInBounds(grid, goalX, goalY) ||
+        spaceGridBlocked(grid, startX, startY) || spaceGridBlocked(grid, goalX, goalY))
+        return -1;
+
+    int start = startY * width + startX, goal = goalY * width + goalX;
+    int startCluster = clusterOf(hpa, startX, startY), goalCluster = clusterOf(hpa, goalX, goalY);
+    const HpaCluster* first = &hpa->clusters[startCluster];
+    const HpaCluster* last = &hpa->clusters[goalCluster];
+
+    // Temporary links from the start and the goal to the nodes of their clusters
+    float startCost[HPA_MAX_CLUSTER_NODES], goalCost[HPA_MAX_CLUSTER_NODES];
+    localSearch(hpa, grid, startCluster, start, -1);
+    for (int i = 0; i < first->count; i++) startCost[i] = localCost(hpa, startCluster, first->cells[i]);
+    float directCost = startCluster == goalCluster ? localCost(hpa, startCluster, goal) : HPA_UNREACHABLE;
+    localSearch(hpa, grid, goalCluster, goal, -1);
+    for (int i = 0; i < last->count; i++) goalCost[i] = localCost(hpa, goalCluster, last->cells[i]);
+
+    PathSearchContext* ctx = &hpa->abstract;
+    const int startNode = hpa->clustersX * hpa->clustersY * HPA_MAX_CLUSTER_NODES, goalNode = startNode + 1;
+    pathSearchBegin(ctx);
+    pathSearchRelax(ctx, startNode, -1, 0.0f, HPA_HEURISTIC_WEIGHT * octileHeuristic(startX, startY, goalX, goalY));
+
+    for (int current; (current = pathSearchPop(ctx)) >= 0 && current != goalNode;) {
+        float g = ctx->g[current];
+        if (current == startNode) {
+            for (int i = 0; i < first->count; i++) {
+                if (startCost[i] >= HPA_UNREACHABLE) continue;
+                int cell = first->cells[i];
+                pathSearchRelax(ctx, startCluster * HPA_MAX_CLUSTER_NODES + i, current, startCost[i],
+                    HPA_HEURISTIC_WEIGHT * octileHeuristic(cell % width, cell / width, goalX, goalY));
+            }
+            if (directCost < HPA_UNREACHABLE) pathSearchRelax(ctx, goalNode, current, directCost, 0.0f);
+            continue;
+        }
+
+        int index = current / HPA_MAX_CLUSTER_NODES, slot = current % HPA_MAX_CLUSTER_NODES;
+        const HpaCluster* cluster = &hpa->clusters[index];
+        const float* row = &cluster->cost[slot * cluster->count];
+        for (int j = 0; j < cluster->count; j++) {
+            if (j == slot || row[j] >= HPA_UNREACHABLE) continue;
+            int cell = cluster->cells[j];
+            pathSearchRelax(ctx, index * HPA_MAX_CLUSTER_NODES + j, current, g + row[j],
+                HPA_HEURISTIC_WEIGHT * octileHeuristic(cell % width, cell / width, goalX, goalY));
+        }
+        for (int p = 0; p < 2; p++) {
+            int cell = cluster->partners[slot][p];
+            if (cell < 0) continue;
+            int px = cell % width, py = cell / width, other = clusterOf(hpa, px, py);
+            int otherSlot = nodeSlot(&hpa->clusters[other], cell);
+            if (otherSlot >= 0)
+                pathSearchRelax(ctx, other * HPA_MAX_CLUSTER_NODES + otherSlot, current, g + 1.0f,
+                    HPA_HEURISTIC_WEIGHT * octileHeuristic(px, py, goalX, goalY));
+        }
+        if (index == goalCluster && goalCost[slot] < HPA_UNREACHABLE)
+            pathSearchRelax(ctx, goalNode, current, g + goalCost[slot], 0.0f);
+    }
+    hpa->nodesExpanded = ctx->nodesExpanded;
+    if (ctx->stamp[goalNode] != ctx->currentStamp || ctx->state[goalNode] != 2) return -1;
+
+    // Waypoint cells from the goal back to the start
+    int length = 0;
+    for (int node = goalNode; node != -1; node = ctx->parent[node]) length++;
+    int i = length - 1;
+    for (int node = goalNode; node != -1; node = ctx->parent[node], i--) {
+        hpa->route[i] = node == startNode ? start : node == goalNode ? goal :
+            hpa->clusters[node / HPA_MAX_CLUSTER_NODES].cells[node % HPA_MAX_CLUSTER_NODES];
+    }
+    hpa->routeLength = length;
+    hpa->pathCost = ctx->g[goalNode];
+    return length;
+}
+
+int hpaRefineRoute(HpaGraph* hpa, const SpaceGrid* grid, Point* path, int maxPath) {
+    const int width = hpa->width;
+    if (hpa->routeLength == 0) return -1;
+    if (path && maxPath > 0) { path[0].x = hpa->route[0] % width; path[0].y = hpa->route[0] / width; }
+    int length = 1;
+
+    for (int r = 1; r < hpa->routeLength; r++) {
+        int from = hpa->route[r - 1], to = hpa->route[r];
+        if (from == to) continue;
+        int toX = to % width, toY = to / width;
+        int cluster = clusterOf(hpa, toX, toY);
+
+        // Waypoints in different clusters are an entrance pair, one step apart
+        if (cluster != clusterOf(hpa, from % width, from / width)) {
+            if (path && length < maxPath) { path[length].x = toX; path[length].y = toY; }
+            length++;
+            continue;
+        }
+
+        // Otherwise search this cluster alone and write the leg back to front
+        localSearch(hpa, grid, cluster, from, to);
+        const PathSearchContext* ctx = &hpa->local;
+        int x0, y0, x1, y1;
+        clusterBounds(hpa, cluster, &x0, &y0, &x1, &y1);
+        int end = localIndex(toX, toY, x0, y0), steps = 0;
+        for (int c = end; ctx->parent[c] != -1; c = ctx->parent[c]) steps++;
+        int i = length + steps - 1;
+        for (int c = end; ctx->parent[c] != -1; c = ctx->parent[c], i--) {
+            if (path && i < maxPath) { path[i].x = x0 + c % HPA_CLUSTER_SIZE; path[i].y = y0 + c / HPA_CLUSTER_SIZE; }
+        }
+        length += steps;
+    }
+    return length;
+}
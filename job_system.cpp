@@ -0,0 +1,197 @@
+#include "job_system.h"
+#include <string.h>
+#include <chrono>
+
+struct JobBatch {
+    JobRangeFn fn;
+    void* data;
+    int grain;
+    std::atomic<int> pending;       // Jobs split off and not yet finished
+    std::atomic<long long> busyNs;
+    std::atomic<long long> chunks, steals;
+};
+
+// Deque index of the calling thread, 0 outside the pool
+static thread_local const JobSystem* workerSystem;
+static thread_local int workerIndex;
+
+static inline int selfIndex(const JobSystem* js) {
+    return workerSystem == js ? workerIndex : 0;
+}
+
+static long long nowNs(void) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static bool pushJob(JobSystem* js, int self, const Job* job) {
+    JobDeque* deque = &js->deques[self];
+    {
+        std::lock_guard<std::mutex> guard(deque->lock);
+        if (deque->count == JOB_DEQUE_CAPACITY) return false;
+        deque->jobs[(deque->top + deque->count) % JOB_DEQUE_CAPACITY] = *job;
+        deque->count++;
+    }
+    // Pairs with the sleeping check in workerLoop: either the worker sees the
+    // job or we see the worker and wake it
+    js->queued.fetch_add(1);
+    if (js->sleeping.load() > 0) {
+        std::lock_guard<std::mutex> guard(js->lock);
+        js->wake.notify_one();
+    }
+    return true;
+}
+
+// Newest job from our own deque, else the oldest from someone else's
+static bool takeJob(JobSystem* js, int self, Job* job, bool* stolen) {
+    if (js->queued.load() == 0) return false;
+    for (int i = 0; i < js->threadCount; i++) {
+        int victim = (self + i) % js->threadCount;
+        JobDeque* deque = &js->deques[victim];
+        std::lock_guard<std::mutex> guard(deque->lock);
+        if (deque->count == 0) continue;
+        if (victim == self) {
+            *job = deque->jobs[(deque->top + deque->count - 1) % JOB_DEQUE_CAPACITY];
+        }
+        else {
+            *job = deque->jobs[deque->top];
+            deque->top = (deque->top + 1) % JOB_DEQUE_CAPACITY;
+        }
+        deque->count--;
+        js->queued.fetch_sub(1);
+        *stolen = victim != self;
+        return true;
+    }
+    return false;
+}
+
+static void runJob(JobSystem* js, int self, Job job, bool stolen) {
+    JobBatch* batch = job.batch;
+    // Halve until the grain, leaving the upper halves for thieves
+    while (job.end - job.begin > batch->grain) {
+        int mid = job.begin + (job.end - job.begin) / 2;
+        Job upper = { batch, mid, job.end };
+        batch->pending.fetch_add(1);
+        if (!pushJob(js, self, &upper)) {
+            batch->pending.fetch_sub(1);
+            break;
+        }
+        job.end = mid;
+    }
+    long long start = nowNs();
+    batch->fn(batch->data, job.begin, job.end);
+    batch->busyNs.fetch_add(nowNs() - start, std::memory_order_relaxed);
+    batch->chunks.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) batch->steals.fetch_add(1, std::memory_order_relaxed);
+    batch->pending.fetch_sub(1, std::memory_order_release);
+}
+
+static void workerLoop(JobSystem* js, int index) {
+    workerSystem = js;
+    workerIndex = index;
+    for (;;) {
+        Job job;
+        bool stolen;
+        if (takeJob(js, index, &job, &stolen)) {
+            runJob(js, index, job, stolen);
+            continue;
+        }
+        std::unique_lock<std::mutex> guard(js->lock);
+        js->sleeping.fetch_add(1);
+        js->wake.wait(guard, [&] { return js->stopping || js->queued.load() > 0; });
+        js->sleeping.fetch_sub(1);
+        if (js->stopping) break;
+    }
+}
+
+void jobSystemStart(JobSystem* js, int threadCount) {
+    if (threadCount <= 0) threadCount = (int)std::thread::hardware_concurrency();
+    if (threadCount < 1) threadCount = 1;
+    if (threadCount > JOB_MAX_THREADS) threadCount = JOB_MAX_THREADS;
+    js->threadCount = threadCount;
+    js->deques = new JobDeque[threadCount];
+    for (int i = 0; i < threadCount; i++) js->deques[i].top = js->deques[i].count = 0;
+    js->queued = 0;
+    js->sleeping = 0;
+    js->stopping = false;
+    js->timingCount = 0;
+    for (int i = 1; i < threadCount; i++) js->workers[i] = std::thread(workerLoop, js, i);
+}
+
+void jobSystemStop(JobSystem* js) {
+    {
+        std::lock_guard<std::mutex> guard(js->lock);
+        js->stopping = true;
+    }
+    js->wake.notify_all();
+    for (int i = 1; i < js->threadCount; i++)
+        if (js->workers[i].joinable()) js->workers[i].join();
+    delete[] js->deques;
+    js->deques = NULL;
+    js->threadCount = 0;
+}
+
+static void recordTiming(JobSystem* js, const char* name, int count, long long wallNs, long long busyNs, long long chunks, long long steals) {
+    std::lock_guard<std::mutex> guard(js->timingLock);
+    JobTiming* timing = NULL;
+    for (int i = 0; i < js->timingCount && !timing; i++)
+        if (js->timings[i].name == name || strcmp(js->timings[i].name, name) == 0) timing = &js->timings[i];
+    if (!timing) {
+        if (js->timingCount == JOB_MAX_TIMINGS) return;
+        timing = &js->timings[js->timingCount++];
+        memset(timing, 0, sizeof(*timing));
+        timing->name = name;
+    }
+    timing->calls++;
+    timing->items += count;
+    timing->chunks += chunks;
+    timing->steals += steals;
+    timing->lastWallMs = wallNs * 1e-6;
+    timing->lastBusyMs = busyNs * 1e-6;
+    timing->wallMs += timing->lastWallMs;
+    timing->busyMs += timing->lastBusyMs;
+}
+
+void jobParallelFor(JobSystem* js, const char* name, int count, int grain, JobRangeFn fn, void* data) {
+    if (count <= 0) return;
+    if (grain < 1) grain = 1;
+    long long start = nowNs();
+
+    // Nothing to spread: skip the deques entirely
+    if (!js || js->threadCount <= 1 || count <= grain) {
+        fn(data, 0, count);
+        if (js) {
+            long long ns = nowNs() - start;
+            recordTiming(js, name, count, ns, ns, 1, 0);
+        }
+        return;
+    }
+
+    JobBatch batch;
+    batch.fn = fn; batch.data = data; batch.grain = grain;
+    batch.pending = 1;
+    batch.busyNs = 0;
+    batch.chunks = 0; batch.steals = 0;
+    int self = selfIndex(js);
+    Job whole = { &batch, 0, count };
+    runJob(js, self, whole, false);
+
+    // Help with whatever is queued, ours or not, until our batch is done
+    while (batch.pending.load(std::memory_order_acquire) > 0) {
+        Job job;
+        bool stolen;
+        if (takeJob(js, self, &job, &stolen)) runJob(js, self, job, stolen);
+        else std::this_thread::yield();
+    }
+    recordTiming(js, name, count, nowNs() - start, batch.busyNs.load(), batch.chunks.load(), batch.steals.load());
+}
+
+int jobSystemTimings(JobSystem* js, JobTiming* out, int maxOut) {
+    std::lock_guard<std::mutex> guard(js->timingLock);
+    for (int i = 0; i < js->timingCount && i < maxOut; i++) out[i] = js->timings[i];
+    return js->timingCount;
+}
+
+void jobSystemResetTimings(JobSystem* js) {
+    std::lock_guard<std::mutex> guard(js->timingLock);
+    js->timingCount = 0;
+}
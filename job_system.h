@@ -0,0 +1,75 @@
+#ifndef JOB_SYSTEM_H
+#define JOB_SYSTEM_H
+
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Small work-stealing scheduler for fanning per-tick and per-frame work out
+// over the cores. Every thread owns a deque of range jobs: a job larger than
+// its grain pushes its upper half onto the owner's deque and keeps the lower
+// half, so idle threads steal big pieces from the far end while the owner
+// works through small ones from the near end. The thread that calls
+// jobParallelFor works too and returns once the whole range is done.
+//
+// Every jobParallelFor is timed under its name: wall time against the time
+// spent inside the job function on all threads, which gives the speedup.
+
+#define JOB_MAX_THREADS 64
+#define JOB_DEQUE_CAPACITY 1024 // Jobs waiting per thread; a full deque runs jobs unsplit
+#define JOB_MAX_TIMINGS 32      // Distinct job names tracked
+
+typedef void (*JobRangeFn)(void* data, int begin, int end);
+
+struct JobBatch;
+typedef struct { JobBatch* batch; int begin, end; } Job;
+
+typedef struct {
+    std::mutex lock;
+    Job jobs[JOB_DEQUE_CAPACITY];  // Ring; the owner pushes and pops at the bottom, thieves take the top
+    int top, count;
+} JobDeque;
+
+typedef struct {
+    const char* name;
+    int calls;
+    long long items;        // Range elements processed
+    long long chunks;       // Job function calls
+    long long steals;       // Chunks run by a thread other than the one that split them off
+    double wallMs;          // Caller's time from start to the last chunk finishing
+    double busyMs;          // Time inside the job function, summed over threads
+    double lastWallMs, lastBusyMs;
+} JobTiming;
+
+typedef struct {
+    int threadCount;        // Workers plus the calling thread
+    JobDeque* deques;       // One per thread; 0 belongs to threads outside the pool
+    std::thread workers[JOB_MAX_THREADS];
+    std::atomic<int> queued;    // Jobs sitting in deques
+    std::atomic<int> sleeping;  // Workers waiting for work
+    bool stopping;
+    std::mutex lock;
+    std::condition_variable wake;
+    JobTiming timings[JOB_MAX_TIMINGS];
+    int timingCount;
+    std::mutex timingLock;
+} JobSystem;
+
+// Starts threadCount - 1 workers; 0 picks one thread per core
+void jobSystemStart(JobSystem* js, int threadCount);
+void jobSystemStop(JobSystem* js);
+
+// Calls fn over [0, count) in ranges of at most grain elements, spread over
+// all threads, and returns when every range is done. Ranges never overlap, so
+// fn may write to its own elements without locking. js may be NULL, which
+// runs fn over the whole range on the calling thread. name keys the timing
+// and must outlive the system (a string literal).
+void jobParallelFor(JobSystem* js, const char* name, int count, int grain, JobRangeFn fn, void* data);
+
+// Copies up to maxOut timings to out and returns how many there are
+int jobSystemTimings(JobSystem* js, JobTiming* out, int maxOut);
+void jobSystemResetTimings(JobSystem* js);
+
+#endif
@@ -0,0 +1,139 @@
+#include "map_pool.h"
+#include <chrono>
+
+static double secondsSince(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+// Hands the contents of src to dst; layouts of the same size just trade buffers
+static void moveLayout(MapLayout* dst, MapLayout* src) {
+    if (dst->grid.width == src->grid.width && dst->grid.height == src->grid.height) {
+        MapLayout swap = *dst; *dst = *src; *src = swap;
+    }
+    else {
+        mapLayoutCopy(dst, src);
+    }
+}
+
+// Difficulty with the fewest ready maps, or -1 when every ring is full
+static int neediestDifficulty(const MapPool* pool) {
+    int best = -1;
+    for (int d = 0; d < MAP_POOL_DIFFICULTIES; d++) {
+        if (pool->count[d] + (pool->pending[d] ? 1 : 0) >= MAP_POOL_CAPACITY) continue;
+        if (best < 0 || pool->count[d] < pool->count[best]) best = d;
+    }
+    return best;
+}
+
+// Generates from seed, then from seeds derived from it, until a map rates
+// within the difficulty's band. The kept map's rating goes to rating; returns
+// the maps thrown away.
+static int generateInBand(MapLayout* map, MapRater* rater, DifficultyLevel difficulty, uint64_t seed, MapRating* rating) {
+    RatingBand band = ratingBandForDifficulty(difficulty);
+    for (int rejected = 0;; rejected++) {
+        generateEnvironment(map, difficulty, false, rejected ? rngDeriveSeed(seed, rejected) : seed);
+        *rating = mapRate(rater, map, difficulty);
+        if (ratingInBand(rating, band) || rejected == MAP_POOL_MAX_REJECTS) return rejected;
+    }
+}
+
+static void producerLoop(MapPool* pool) {
+    MapLayout scratch;
+    mapLayoutInit(&scratch, pool->width, pool->height);
+    MapRater rater;
+    mapRaterInit(&rater, pool->width, pool->height);
+
+    std::unique_lock<std::mutex> guard(pool->lock);
+    for (;;) {
+        int difficulty = -1;
+        pool->wake.wait(guard, [&] { return pool->stopping || (difficulty = neediestDifficulty(pool)) >= 0; });
+        if (pool->stopping) break;
+
+        // Draw the seed under the lock so maps keep their order within a difficulty
+        uint64_t seed = rngNext(&pool->seeds[difficulty]);
+        pool->pending[difficulty] = true;
+        guard.unlock();
+
+        auto start = std::chrono::steady_clock::now();
+        MapRating rating;
+        int rejected = generateInBand(&scratch, &rater, (DifficultyLevel)difficulty, seed, &rating);
+        double seconds = secondsSince(start);
+
+        guard.lock();
+        int slot = (pool->head[difficulty] + pool->count[difficulty]) % MAP_POOL_CAPACITY;
+        moveLayout(&pool->ready[difficulty][slot], &scratch);
+        pool->ratings[difficulty][slot] = rating;
+        pool->count[difficulty]++;
+        pool->pending[difficulty] = false;
+        pool->stats.generated += rejected + 1;
+        pool->stats.rejected += rejected;
+        pool->stats.refillSeconds += seconds;
+        pool->wake.notify_all();
+    }
+    guard.unlock();
+    mapRaterFree(&rater);
+    mapLayoutFree(&scratch);
+}
+
+void mapPoolStart(MapPool* pool, int width, int height, uint64_t seed) {
+    pool->width = width; pool->height = height;
+    uint64_t poolSeed = rngDeriveSeed(seed, RNG_STREAM_MAPGEN);
+    for (int d = 0; d < MAP_POOL_DIFFICULTIES; d++) {
+        for (int i = 0; i < MAP_POOL_CAPACITY; i++) mapLayoutInit(&pool->ready[d][i], width, height);
+        pool->head[d] = pool->count[d] = 0;
+        pool->pending[d] = false;
+        rngSeed(&pool->seeds[d], rngDeriveSeed(poolSeed, d + 1));
+    }
+    pool->stats = MapPoolStats();
+    pool->stopping = false;
+    pool->producer = std::thread(producerLoop, pool);
+}
+
+void mapPoolStop(MapPool* pool) {
+    {
+        std::lock_guard<std::mutex> guard(pool->lock);
+        pool->stopping = true;
+    }
+    pool->wake.notify_all();
+    if (pool->producer.joinable()) pool->producer.join();
+    for (int d = 0; d < MAP_POOL_DIFFICULTIES; d++)
+        for (int i = 0; i < MAP_POOL_CAPACITY; i++) mapLayoutFree(&pool->ready[d][i]);
+}
+
+bool mapPoolTake(MapPool* pool, DifficultyLevel difficulty, MapLayout* map, MapRating* rating) {
+    std::unique_lock<std::mutex> guard(pool->lock);
+    // A map already in the making is the next one in seed order; wait for it
+    pool->wake.wait(guard, [&] { return pool->count[difficulty] > 0 || !pool->pending[difficulty]; });
+
+    if (pool->count[difficulty] > 0) {
+        moveLayout(map, &pool->ready[difficulty][pool->head[difficulty]]);
+        if (rating) *rating = pool->ratings[difficulty][pool->head[difficulty]];
+        pool->head[difficulty] = (pool->head[difficulty] + 1) % MAP_POOL_CAPACITY;
+        pool->count[difficulty]--;
+        pool->stats.hits++;
+        pool->wake.notify_all(); // Room to refill
+        return true;
+    }
+
+    // Empty and nothing in flight: generate here with the next seed
+    uint64_t seed = rngNext(&pool->seeds[difficulty]);
+    pool->stats.misses++;
+    guard.unlock();
+    auto start = std::chrono::steady_clock::now();
+    MapRater rater;
+    mapRaterInit(&rater, map->grid.width, map->grid.height);
+    MapRating kept;
+    int rejected = generateInBand(map, &rater, difficulty, seed, &kept);
+    if (rating) *rating = kept;
+    mapRaterFree(&rater);
+    double seconds = secondsSince(start);
+    guard.lock();
+    pool->stats.missSeconds += seconds;
+    pool->stats.rejected += rejected;
+    return false;
+}
+
+MapPoolStats mapPoolGetStats(MapPool* pool) {
+    std::lock_guard<std::mutex> guard(pool->lock);
+    return pool->stats;
+}
@@ -0,0 +1,59 @@
+#ifndef MAP_POOL_H
+#define MAP_POOL_H
+
+#include <stdint.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "game_world.h"
+#include "map_rating.h"
+
+// Background producer that keeps a few validated maps ready for every
+// difficulty, so starting a game is a buffer swap instead of a generation
+// stall. Each difficulty has its own seed stream and its maps are handed out
+// in seed order, so a master seed still gives the same sequence of maps.
+// Maps are rated before they are kept; one that falls outside its difficulty's
+// rating band is replaced by a map from the next seed derived from the same
+// draw, so the sequence stays reproducible.
+
+#define MAP_POOL_CAPACITY 3     // Ready maps kept per difficulty
+#define MAP_POOL_DIFFICULTIES 3
+#define MAP_POOL_MAX_REJECTS 8  // Out-of-band maps thrown away before one is kept anyway
+
+typedef struct {
+    int hits;               // Takes served from the pool
+    int misses;             // Takes that had to generate on the spot
+    int generated;          // Maps made by the producer
+    int rejected;           // Maps thrown away for rating outside their band
+    double refillSeconds;   // Producer time spent generating
+    double missSeconds;     // Time callers spent generating after a miss
+} MapPoolStats;
+
+typedef struct {
+    int width, height;
+    MapLayout ready[MAP_POOL_DIFFICULTIES][MAP_POOL_CAPACITY]; // FIFO ring per difficulty
+    MapRating ratings[MAP_POOL_DIFFICULTIES][MAP_POOL_CAPACITY]; // Rating of each ready map
+    int head[MAP_POOL_DIFFICULTIES], count[MAP_POOL_DIFFICULTIES];
+    bool pending[MAP_POOL_DIFFICULTIES];        // Producer is generating the next map
+    RngStream seeds[MAP_POOL_DIFFICULTIES];     // Next map seed per difficulty
+    MapPoolStats stats;
+    bool stopping;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread producer;
+} MapPool;
+
+// Starts the producer; seed is the game's master seed
+void mapPoolStart(MapPool* pool, int width, int height, uint64_t seed);
+void mapPoolStop(MapPool* pool);
+
+// Swaps the oldest ready map for the difficulty into map, which must have the
+// pool's size. Waits if that map is being generated, and generates on the
+// calling thread if none is ready. The map's rating, which includes its
+// shortest winning route, is written to rating unless that is NULL. Returns
+// true on a pool hit.
+bool mapPoolTake(MapPool* pool, DifficultyLevel difficulty, MapLayout* map, MapRating* rating);
+
+MapPoolStats mapPoolGetStats(MapPool* pool);
+
+#endif
@@ -0,0 +1,181 @@
+#include "map_rating.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define PACE_SEARCH_MAX 100.0f  // Fastest pace tried; a route that loses even here is unbeatable
+#define PACE_SEARCH_STEPS 24
+
+// Upper bounds in moves per second of every tier below RATING_UNBEATABLE
+static const float tierPaces[RATING_TIER_COUNT - 1] = { 1.0f, 2.0f, 3.5f, RATING_MAX_PACE };
+static const char* tierNames[RATING_TIER_COUNT] = { "relaxed", "steady", "brisk", "frantic", "unbeatable" };
+
+const char* ratingTierName(RatingTier tier) {
+    return tierNames[tier];
+}
+
+RatingTier ratingTierForPace(float pace) {
+    int tier = 0;
+    while (tier < RATING_TIER_COUNT - 1 && !(pace <= tierPaces[tier])) tier++;
+    return (RatingTier)tier;
+}
+
+RatingBand ratingBandForDifficulty(DifficultyLevel difficulty) {
+    switch (difficulty) {
+    case DIFFICULTY_EASY: { RatingBand band = { RATING_RELAXED, RATING_STEADY }; return band; }
+    case DIFFICULTY_HARD: { RatingBand band = { RATING_BRISK, RATING_FRANTIC }; return band; }
+    default: { RatingBand band = { RATING_STEADY, RATING_BRISK }; return band; }
+    }
+}
+
+// The route as the clock sees it: moves in total and the move that reaches
+// each coin, in visiting order
+typedef struct {
+    int moves, coinCount;
+    int pickups[MAX_COINS];
+} RatedRoute;
+
+// Ticks the game runs before the player, moving every 1 / pace seconds,
+// makes the move; a tick due at the same instant goes first
+static int ticksBefore(int move, float pace) {
+    return (int)floorf(move * (float)SIM_TICKS_PER_SECOND / pace);
+}
+
+// Lowest light just before each coin and the final move
+static float lowestLight(const RatedRoute* route, const DifficultyRules* rules, float pace) {
+    float light = MAX_LIGHT_DURATION, lowest = MAX_LIGHT_DURATION;
+    int tick = 0;
+    for (int i = 0; i <= route->coinCount; i++) {
+        int at = ticksBefore(i < route->coinCount ? route->pickups[i] : route->moves, pace);
+        light -= rules->lightDecayRate * (at - tick);
+        tick = at;
+        if (light < lowest) lowest = light;
+        if (i < route->coinCount) light = fminf(light + rules->coinLightBoost, MAX_LIGHT_DURATION);
+    }
+    return lowest;
+}
+
+static bool outOfTime(const RatedRoute* route, const DifficultyRules* rules, float pace) {
+    return ticksBefore(route->moves, pace) >= rules->timeLimit * SIM_TICKS_PER_SECOND;
+}
+
+static bool winsAt(const RatedRoute* route, const DifficultyRules* rules, float pace) {
+    return !outOfTime(route, rules, pace) && lowestLight(route, rules, pace) > 0.0f;
+}
+
+void mapRaterInit(MapRater* rater, int width, int height) {
+    coinRouteInit(&rater->solver, width, height);
+    rater->path = NULL;
+    rater->maxPath = 0;
+    rater->walks = 0;
+}
+
+void mapRaterFree(MapRater* rater) {
+    coinRouteFree(&rater->solver);
+    free(rater->path);
+    rater->path = NULL;
+    rater->maxPath = 0;
+}
+
+MapRating mapRate(MapRater* rater, const MapLayout* map, DifficultyLevel difficulty) {
+    MapRating rating;
+    DifficultyRules rules = difficultyRules(difficulty);
+    RatedRoute route;
+    route.moves = coinRouteSolveMap(&rater->solver, map, NULL);
+    rating.moves = route.moves;
+    if (route.moves < 0) {
+        rating.requiredPace = INFINITY;
+        rating.timeSlack = rating.lightSlack = -INFINITY;
+        rating.lightBound = false;
+        rating.tier = RATING_UNBEATABLE;
+        return rating;
+    }
+
+    // Pickups from the stop matrix, unless a later coin could lie on a
+    // shortest leg; then the route's cells decide, a coin counting the first
+    // time the route stands on it
+    const CoinRouteSolver* solver = &rater->solver;
+    const int n = solver->stopCount;
+    route.coinCount = n - 2;
+    bool crossesCoin = false;
+    for (int i = 0, from = 0, moves = 0; i <= route.coinCount; i++) {
+        int to = i < route.coinCount ? solver->route[i] + 1 : n - 1;
+        int leg = solver->matrix[from * n + to];
+        for (int k = i + 1; k < route.coinCount && !crossesCoin; k++) {
+            int coin = solver->route[k] + 1;
+            crossesCoin = solver->matrix[from * n + coin] + solver->matrix[coin * n + to] == leg;
+        }
+        moves += leg;
+        if (i < route.coinCount) route.pickups[i] = moves;
+        from = to;
+    }
+    if (crossesCoin) {
+        // The route is moves + 1 cells; the buffer only grows to the longest walked so far
+        if (route.moves + 1 > rater->maxPath) {
+            rater->maxPath = route.moves + 1;
+            rater->path = (Point*)realloc(rater->path, rater->maxPath * sizeof(Point));
+        }
+        int length = coinRoutePath(&rater->solver, rater->path, rater->maxPath);
+        rater->walks++;
+        int left = route.coinCount, count = 0;
+        Point coins[MAX_COINS];
+        for (int i = 0; i < left; i++) coins[i] = solver->stops[i + 1];
+        for (int move = 1; move < length && left > 0; move++) {
+            Point cell = rater->path[move];
+            for (int i = 0; i < left; i++) {
+                if (coins[i].x != cell.x || coins[i].y != cell.y) continue;
+                route.pickups[count++] = move;
+                coins[i--] = coins[--left];
+            }
+        }
+    }
+
+    rating.timeSlack = rules.timeLimit - route.moves / RATING_REFERENCE_PACE;
+    rating.lightSlack = lowestLight(&route, &rules, RATING_REFERENCE_PACE);
+
+    // Light before every pickup only grows with pace, so wins are monotonic in
+    // it up to whole ticks
+    float slow = 0.0f, fast = PACE_SEARCH_MAX;
+    if (!winsAt(&route, &rules, fast)) {
+        rating.requiredPace = INFINITY;
+        rating.lightBound = !outOfTime(&route, &rules, fast);
+    }
+    else {
+        for (int i = 0; i < PACE_SEARCH_STEPS; i++) {
+            float pace = 0.5f * (slow + fast);
+            if (winsAt(&route, &rules, pace)) fast = pace;
+            else slow = pace;
+        }
+        rating.requiredPace = fast;
+        rating.lightBound = slow > 0.0f && !outOfTime(&route, &rules, slow);
+    }
+    rating.tier = ratingTierForPace(rating.requiredPace);
+    return rating;
+}
+
+typedef struct {
+    DifficultyLevel difficulty;
+    int width, height;
+    uint64_t seed;
+    int64_t first;
+    MapRating* out;
+} RateBatch;
+
+static void rateRange(void* data, int begin, int end) {
+    RateBatch* batch = (RateBatch*)data;
+    MapLayout map;
+    mapLayoutInit(&map, batch->width, batch->height);
+    MapRater rater;
+    mapRaterInit(&rater, batch->width, batch->height);
+    for (int i = begin; i < end; i++) {
+        generateEnvironment(&map, batch->difficulty, false, rngDeriveSeed(batch->seed, (uint64_t)(batch->first + i)));
+        batch->out[i] = mapRate(&rater, &map, batch->difficulty);
+    }
+    mapRaterFree(&rater);
+    mapLayoutFree(&map);
+}
+
+void mapRateSeeds(JobSystem* jobs, DifficultyLevel difficulty, int width, int height, uint64_t seed,
+    int64_t first, int count, MapRating* out) {
+    RateBatch batch = { difficulty, width, height, seed, first, out };
+    jobParallelFor(jobs, "map.rate", count, 256, rateRange, &batch);
+}
@@ -0,0 +1,64 @@
+#ifndef MAP_RATING_H
+#define MAP_RATING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "coin_route.h"
+#include "game_world.h"
+#include "job_system.h"
+
+// Measured difficulty of a generated map. The shortest coin route is played
+// at a constant pace against the difficulty's time limit and light drain,
+// coins topping the light up as they are reached; the slowest pace that still
+// wins says how hard the map really is, whatever difficulty it was made for.
+
+#define RATING_REFERENCE_PACE 2.0f  // Moves per second of an unhurried player, for slack
+#define RATING_MAX_PACE 8.0f        // Fastest key rate a player keeps up for a whole map
+
+// Tiers by required pace in moves per second; beyond RATING_MAX_PACE or
+// without a route a map is unbeatable
+typedef enum { RATING_RELAXED, RATING_STEADY, RATING_BRISK, RATING_FRANTIC, RATING_UNBEATABLE } RatingTier;
+#define RATING_TIER_COUNT 5
+
+typedef struct {
+    int moves;              // Shortest winning route, -1 if there is none
+    float requiredPace;     // Slowest constant moves per second that wins, INFINITY if none does
+    float timeSlack;        // Seconds left at RATING_REFERENCE_PACE, negative once the clock runs out
+    float lightSlack;       // Lowest light along the route at that pace, at or below zero is a loss
+    bool lightBound;        // Light rather than the clock sets requiredPace
+    RatingTier tier;
+} MapRating;
+
+// Tiers a difficulty accepts, both ends included
+typedef struct { RatingTier easiest, hardest; } RatingBand;
+
+// Scratch space for rating maps of one size; the solver keeps the last route
+typedef struct {
+    CoinRouteSolver solver;
+    Point* path;            // Cells of the last route, when the rating needed them
+    int maxPath;            // Points path holds, grown on first need
+    int walks;              // Ratings that had to walk the cells, for benchmarks
+} MapRater;
+
+const char* ratingTierName(RatingTier tier);
+RatingTier ratingTierForPace(float pace);
+RatingBand ratingBandForDifficulty(DifficultyLevel difficulty);
+
+void mapRaterInit(MapRater* rater, int width, int height);
+void mapRaterFree(MapRater* rater);
+
+// Rates the map's active coins under the difficulty's rules. Coins count when
+// the route's cells first touch them, which can be on the way to another coin.
+MapRating mapRate(MapRater* rater, const MapLayout* map, DifficultyLevel difficulty);
+
+static inline bool ratingInBand(const MapRating* rating, RatingBand band) {
+    return rating->tier >= band.easiest && rating->tier <= band.hardest;
+}
+
+// Generates and rates count maps with the seeds rngDeriveSeed(seed, first + i),
+// spread over the job system (which may be NULL). Each range of maps has its
+// own layout and rater, so results do not depend on the thread count.
+void mapRateSeeds(JobSystem* jobs, DifficultyLevel difficulty, int width, int height, uint64_t seed,
+    int64_t first, int count, MapRating* out);
+
+#endif
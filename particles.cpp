@@ -0,0 +1,273 @@
+#include "particles.h"
+#include "fast_trig.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PARTICLES_SSE2
+#endif
+
+#ifdef PARTICLES_SSE2
+// fastSin on four lanes
+static inline __m128 fastSin4(__m128 x) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    __m128 t = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(TRIG_INV_TWO_PI)), _mm_set1_ps(0.5f));
+    __m128 turns = _mm_cvtepi32_ps(_mm_cvttps_epi32(t));
+    turns = _mm_sub_ps(turns, _mm_and_ps(_mm_cmplt_ps(t, turns), one));
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(turns, _mm_set1_ps(TRIG_TWO_PI)));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(_mm_set1_ps(1.27323954f), r),
+        _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.405284735f), r), _mm_andnot_ps(signMask, r)));
+    __m128 refine = _mm_sub_ps(_mm_mul_ps(y, _mm_andnot_ps(signMask, y)), y);
+    return _mm_add_ps(_mm_mul_ps(_mm_set1_ps(0.225f), refine), y);
+}
+#endif
+
+static float* allocField(int capacity) {
+    return (float*)calloc(capacity, sizeof(float));
+}
+
+// Fresh look and lifetime; position and velocity are up to the caller
+static void spawnLook(ParticleSystem* ps, int i) {
+    RngStream* rng = &ps->rng;
+    ps->size[i] = 1.0f + rngRange(rng, 30) / 10.0f;
+    ps->r[i] = 0.1f + rngRange(rng, 30) / 100.0f;
+    ps->g[i] = 0.2f + rngRange(rng, 40) / 100.0f;
+    ps->b[i] = 0.5f + rngRange(rng, 50) / 100.0f;
+    ps->alpha[i] = 0.1f + rngRange(rng, 40) / 100.0f;
+    ps->lifespan[i] = 50.0f + rngRange(rng, 100);
+}
+
+// Enters from a random window edge, heading inwards
+static void spawnAtEdge(ParticleSystem* ps, int i) {
+    RngStream* rng = &ps->rng;
+    float inward = 0.2f + rngRange(rng, 20) / 100.0f;
+    float drift = (float)(rngRange(rng, 60) - 30) / 300.0f;
+    if (rngRange(rng, 2) == 0) {
+        // Left or right
+        bool left = rngRange(rng, 2) == 0;
+        ps->x[i] = left ? 0.0f : ps->width;
+        ps->y[i] = (float)rngRange(rng, (int)ps->height);
+        ps->vx[i] = left ? inward : -inward;
+        ps->vy[i] = drift;
+    }
+    else {
+        // Top or bottom
+        bool top = rngRange(rng, 2) == 0;
+        ps->y[i] = top ? 0.0f : ps->height;
+        ps->x[i] = (float)rngRange(rng, (int)ps->width);
+        ps->vy[i] = top ? inward : -inward;
+        ps->vx[i] = drift;
+    }
+    ps->prevX[i] = ps->x[i]; ps->prevY[i] = ps->y[i];
+    spawnLook(ps, i);
+    ps->age[i] = 0.0f;
+}
+
+void particleSystemInit(ParticleSystem* ps, int count, float width, float height, uint64_t seed) {
+    memset(ps, 0, sizeof(*ps));
+    ps->count = count;
+    ps->capacity = (count + PARTICLE_LANES - 1) / PARTICLE_LANES * PARTICLE_LANES;
+    ps->width = width; ps->height = height;
+    rngSeed(&ps->rng, seed);
+    float** fields[] = { &ps->x, &ps->y, &ps->prevX, &ps->prevY, &ps->vx, &ps->vy, &ps->age, &ps->lifespan,
+        &ps->size, &ps->alpha, &ps->r, &ps->g, &ps->b };
+    for (int f = 0; f < (int)(sizeof(fields) / sizeof(fields[0])); f++) *fields[f] = allocField(ps->capacity);
+    ps->chunkCount = (ps->capacity + PARTICLE_CHUNK - 1) / PARTICLE_CHUNK;
+    ps->dead = (int*)malloc(ps->capacity * sizeof(int));
+    ps->chunkDead = (int*)calloc(ps->chunkCount, sizeof(int));
+    ps->bin = (unsigned char*)malloc(ps->capacity);
+    ps->chunkBins = (int*)malloc((size_t)ps->chunkCount * PARTICLE_SIZE_BINS * sizeof(int));
+    ps->vertices = (ParticleVertex*)malloc((size_t)ps->capacity * 2 * sizeof(ParticleVertex));
+
+    // Scattered over the window at random points of their lives
+    RngStream* rng = &ps->rng;
+    for (int i = 0; i < count; i++) {
+        ps->x[i] = (float)rngRange(rng, (int)width);
+        ps->y[i] = (float)rngRange(rng, (int)height);
+        ps->prevX[i] = ps->x[i]; ps->prevY[i] = ps->y[i];
+        ps->vx[i] = (float)(rngRange(rng, 100) - 50) / 200.0f;
+        ps->vy[i] = (float)(rngRange(rng, 100) - 50) / 200.0f;
+        spawnLook(ps, i);
+        ps->age[i] = (float)rngRange(rng, (int)ps->lifespan[i]);
+    }
+    // Padding lanes are updated with the rest but never die
+    for (int i = count; i < ps->capacity; i++) ps->lifespan[i] = INFINITY;
+    for (int i = 0; i < PARTICLE_SIZE_BINS; i++)
+        ps->binPoint[i] = PARTICLE_MIN_POINT + (i + 0.5f) * (PARTICLE_MAX_POINT - PARTICLE_MIN_POINT) / PARTICLE_SIZE_BINS;
+}
+
+void particleSystemFree(ParticleSystem* ps) {
+    float* fields[] = { ps->x, ps->y, ps->prevX, ps->prevY, ps->vx, ps->vy, ps->age, ps->lifespan, ps->size, ps->alpha,
+        ps->r, ps->g, ps->b };
+    for (int f = 0; f < (int)(sizeof(fields) / sizeof(fields[0])); f++) free(fields[f]);
+    free(ps->dead); free(ps->chunkDead); free(ps->bin); free(ps->chunkBins); free(ps->vertices);
+    memset(ps, 0, sizeof(*ps));
+}
+
+void particleSystemResize(ParticleSystem* ps, float width, float height) {
+    ps->width = width; ps->height = height;
+}
+
+typedef struct { ParticleSystem* ps; float time, blend; } ParticlePass;
+
+// First and one-past-last particle slot of a chunk
+static inline int chunkBegin(int chunk) { return chunk * PARTICLE_CHUNK; }
+static inline int chunkEnd(const ParticleSystem* ps, int chunk) {
+    int end = (chunk + 1) * PARTICLE_CHUNK;
+    return end < ps->capacity ? end : ps->capacity;
+}
+
+// Ages, moves along the wave field and notes the dead; padding lanes never die
+static void integrateChunks(void* data, int firstChunk, int lastChunk) {
+    ParticleSystem* ps = ((ParticlePass*)data)->ps;
+    float time = ((ParticlePass*)data)->time;
+    float* x = ps->x;
+    float* y = ps->y;
+    float* prevX = ps->prevX;
+    float* prevY = ps->prevY;
+    float* age = ps->age;
+    const float* vx = ps->vx;
+    const float* vy = ps->vy;
+    const float* lifespan = ps->lifespan;
+    for (int chunk = firstChunk; chunk < lastChunk; chunk++) {
+        int begin = chunkBegin(chunk), end = chunkEnd(ps, chunk);
+        int* dead = ps->dead + begin;
+        int deadCount = 0;
+#ifdef PARTICLES_SSE2
+        const __m128 step = _mm_set1_ps(0.5f), wave = _mm_set1_ps(0.2f), scale = _mm_set1_ps(0.01f);
+        const __m128 phase = _mm_set1_ps(time), cosPhase = _mm_set1_ps(time + TRIG_HALF_PI);
+        for (int i = begin; i < end; i += 4) {
+            __m128 a = _mm_add_ps(_mm_loadu_ps(&age[i]), step);
+            _mm_storeu_ps(&age[i], a);
+            __m128 px = _mm_loadu_ps(&x[i]), py = _mm_loadu_ps(&y[i]);
+            _mm_storeu_ps(&prevX[i], px);
+            _mm_storeu_ps(&prevY[i], py);
+            px = _mm_add_ps(px, _mm_add_ps(_mm_loadu_ps(&vx[i]), _mm_mul_ps(fastSin4(_mm_add_ps(phase, _mm_mul_ps(py, scale))), wave)));
+            py = _mm_add_ps(py, _mm_add_ps(_mm_loadu_ps(&vy[i]), _mm_mul_ps(fastSin4(_mm_add_ps(cosPhase, _mm_mul_ps(px, scale))), wave)));
+            _mm_storeu_ps(&x[i], px);
+            _mm_storeu_ps(&y[i], py);
+            int died = _mm_movemask_ps(_mm_cmpge_ps(a, _mm_loadu_ps(&lifespan[i])));
+            if (died) {
+                for (int l = 0; l < 4; l++)
+                    if (died & (1 << l)) dead[deadCount++] = i + l;
+            }
+        }
+#else
+        for (int i = begin; i < end; i++) {
+            age[i] += 0.5f;
+            prevX[i] = x[i]; prevY[i] = y[i];
+            x[i] += vx[i] + fastSin(time + y[i] * 0.01f) * 0.2f;
+            y[i] += vy[i] + fastCos(time + x[i] * 0.01f) * 0.2f;
+            dead[deadCount] = i;
+            deadCount += age[i] >= lifespan[i];
+        }
+#endif
+        ps->chunkDead[chunk] = deadCount;
+    }
+}
+
+void particleSystemUpdate(ParticleSystem* ps, float time, JobSystem* jobs) {
+    ParticlePass pass = { ps, time, 1.0f };
+    jobParallelFor(jobs, "particles.update", ps->chunkCount, 1, integrateChunks, &pass);
+
+    // Respawn in chunk order, off the hot loop, so the stream is drawn the same way every run
+    ps->deadCount = 0;
+    for (int chunk = 0; chunk < ps->chunkCount; chunk++) {
+        const int* dead = ps->dead + chunkBegin(chunk);
+        for (int d = 0; d < ps->chunkDead[chunk]; d++) spawnAtEdge(ps, dead[d]);
+        ps->deadCount += ps->chunkDead[chunk];
+    }
+}
+
+// Pulsing point size snapped to a bin, and a histogram of bins per chunk
+static void binChunks(void* data, int firstChunk, int lastChunk) {
+    ParticleSystem* ps = ((ParticlePass*)data)->ps;
+    float time = ((ParticlePass*)data)->time;
+    const float* size = ps->size;
+    unsigned char* bin = ps->bin;
+    const float binScale = PARTICLE_SIZE_BINS / (PARTICLE_MAX_POINT - PARTICLE_MIN_POINT);
+    for (int chunk = firstChunk; chunk < lastChunk; chunk++) {
+        int begin = chunkBegin(chunk), end = chunkEnd(ps, chunk);
+#ifdef PARTICLES_SSE2
+        const __m128 lanes = _mm_set_ps(0.3f, 0.2f, 0.1f, 0.0f);
+        for (int i = begin; i < end; i += 4) {
+            __m128 phase = _mm_add_ps(_mm_set1_ps(time * 2.0f + (float)i * 0.1f), lanes);
+            __m128 pulse = _mm_add_ps(_mm_set1_ps(0.8f), _mm_mul_ps(_mm_set1_ps(0.2f), fastSin4(phase)));
+            __m128 point = _mm_mul_ps(_mm_loadu_ps(&size[i]), pulse);
+            __m128 scaled = _mm_mul_ps(_mm_sub_ps(point, _mm_set1_ps(PARTICLE_MIN_POINT)), _mm_set1_ps(binScale));
+            scaled = _mm_min_ps(_mm_max_ps(scaled, _mm_setzero_ps()), _mm_set1_ps(PARTICLE_SIZE_BINS - 1));
+            __m128i b = _mm_cvttps_epi32(scaled);
+            b = _mm_packs_epi32(b, b);
+            b = _mm_packus_epi16(b, b);
+            int packed = _mm_cvtsi128_si32(b);
+            memcpy(&bin[i], &packed, 4);
+        }
+#else
+        for (int i = begin; i < end; i++) {
+            float point = size[i] * (0.8f + 0.2f * fastSin(time * 2.0f + (float)i * 0.1f));
+            int b = (int)((point - PARTICLE_MIN_POINT) * binScale);
+            b = b < 0 ? 0 : b;
+            bin[i] = (unsigned char)(b < PARTICLE_SIZE_BINS - 1 ? b : PARTICLE_SIZE_BINS - 1);
+        }
+#endif
+        // Padding lanes are not drawn
+        int* counts = ps->chunkBins + chunk * PARTICLE_SIZE_BINS;
+        for (int b = 0; b < PARTICLE_SIZE_BINS; b++) counts[b] = 0;
+        if (end > ps->count) end = ps->count;
+        for (int i = begin; i < end; i++) counts[bin[i]]++;
+    }
+}
+
+// Fade in over the first ten ticks of life and out over the last ten; drawn
+// blend of the way from the previous tick's position to the current one
+static void writeChunks(void* data, int firstChunk, int lastChunk) {
+    ParticleSystem* ps = ((ParticlePass*)data)->ps;
+    float blend = ((ParticlePass*)data)->blend;
+    const float* age = ps->age;
+    const float* lifespan = ps->lifespan;
+    ParticleVertex* glow = ps->vertices;
+    ParticleVertex* core = ps->vertices + ps->count;
+    for (int chunk = firstChunk; chunk < lastChunk; chunk++) {
+        int begin = chunkBegin(chunk), end = chunkEnd(ps, chunk);
+        if (end > ps->count) end = ps->count;
+        int* next = ps->chunkBins + chunk * PARTICLE_SIZE_BINS;
+        for (int i = begin; i < end; i++) {
+            float fadeIn = age[i] / 10.0f, fadeOut = (lifespan[i] - age[i]) / 10.0f;
+            float fade = fadeIn < fadeOut ? fadeIn : fadeOut;
+            fade = fade < 1.0f ? fade : 1.0f;
+            int slot = next[ps->bin[i]]++;
+            float px = ps->prevX[i] + (ps->x[i] - ps->prevX[i]) * blend;
+            float py = ps->prevY[i] + (ps->y[i] - ps->prevY[i]) * blend;
+            ParticleVertex* g = &glow[slot];
+            g->x = px; g->y = py;
+            g->r = ps->r[i]; g->g = ps->g[i]; g->b = ps->b[i];
+            g->a = ps->alpha[i] * 0.2f * fade;
+            ParticleVertex* c = &core[slot];
+            c->x = px; c->y = py;
+            c->r = ps->r[i] + 0.2f; c->g = ps->g[i] + 0.2f; c->b = ps->b[i] + 0.2f;
+            c->a = ps->alpha[i] * fade;
+        }
+    }
+}
+
+void particleSystemEmit(ParticleSystem* ps, float time, float blend, JobSystem* jobs) {
+    ParticlePass pass = { ps, time, blend };
+    jobParallelFor(jobs, "particles.bin", ps->chunkCount, 1, binChunks, &pass);
+
+    // Counting sort: each chunk gets its own run inside every bin, in chunk order
+    int slot = 0;
+    for (int b = 0; b < PARTICLE_SIZE_BINS; b++) {
+        ps->binStart[b] = slot;
+        for (int chunk = 0; chunk < ps->chunkCount; chunk++) {
+            int* cell = &ps->chunkBins[chunk * PARTICLE_SIZE_BINS + b];
+            int count = *cell;
+            *cell = slot;
+            slot += count;
+        }
+    }
+    ps->binStart[PARTICLE_SIZE_BINS] = slot;
+
+    jobParallelFor(jobs, "particles.write", ps->chunkCount, 1, writeChunks, &pass);
+}
@@ -0,0 +1,66 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+#include "rng.h"
+#include "job_system.h"
+
+// Ambient particles drifting across the window. Storage is one array per
+// field so the per-tick integration runs over plain float streams,
+// PARTICLE_LANES at a time with SSE2 where available; the wave motion uses a
+// polynomial sine instead of libm. Particles that die in a tick are
+// collected first and respawned together. Nothing here touches OpenGL: the
+// renderer draws the contiguous vertices that particleSystemEmit writes.
+//
+// Both passes work in chunks of PARTICLE_CHUNK particles that can run on any
+// thread of a JobSystem. Respawns and the vertex order only depend on chunk
+// order, so the result is the same whatever the thread count.
+
+#define PARTICLE_LANES 4        // Block width of the update loops
+#define PARTICLE_SIZE_BINS 8    // Point sizes a frame is drawn with
+#define PARTICLE_MIN_POINT 0.5f
+#define PARTICLE_MAX_POINT 4.0f
+#define PARTICLE_CHUNK 2048     // Particles per job; a multiple of PARTICLE_LANES
+
+typedef struct { float x, y, r, g, b, a; } ParticleVertex;
+
+typedef struct {
+    int count;              // Live particles
+    int capacity;           // count rounded up to PARTICLE_LANES; the padding never dies
+    float width, height;    // Spawn area
+    float *x, *y, *vx, *vy;
+    float *prevX, *prevY;   // Position before the last tick, for drawing between ticks
+    float *age, *lifespan;
+    float *size, *alpha, *r, *g, *b;
+    int chunkCount;
+    int* dead;              // Particles to respawn this tick, listed from each chunk's first slot
+    int* chunkDead;         // Dead per chunk
+    int deadCount;
+    RngStream rng;
+
+    // Written by particleSystemEmit: glow points in [0, count), core points in
+    // [count, 2 * count), both grouped by size bin. Bin i covers
+    // [binStart[i], binStart[i + 1]) of each half and is drawn at binPoint[i]
+    // (the glow at three times that).
+    ParticleVertex* vertices;
+    int binStart[PARTICLE_SIZE_BINS + 1];
+    float binPoint[PARTICLE_SIZE_BINS];
+    unsigned char* bin;     // Scratch: bin of each particle
+    int* chunkBins;         // Scratch: per chunk and bin, count then first vertex
+} ParticleSystem;
+
+void particleSystemInit(ParticleSystem* ps, int count, float width, float height, uint64_t seed);
+void particleSystemFree(ParticleSystem* ps);
+
+// New spawn area, e.g. after the window was resized
+void particleSystemResize(ParticleSystem* ps, float width, float height);
+
+// One tick: ages every particle, moves it along the wave field at time
+// (seconds) and respawns the ones that died at a window edge. jobs may be NULL.
+void particleSystemUpdate(ParticleSystem* ps, float time, JobSystem* jobs);
+
+// Fills ps->vertices and the bins for drawing at time (seconds), blend (0 to 1)
+// of the way from the previous tick's positions to the current ones. jobs may
+// be NULL.
+void particleSystemEmit(ParticleSystem* ps, float time, float blend, JobSystem* jobs);
+
+#endif
@@ -0,0 +1,348 @@
+#include "pathfinding.h"
+#include <stdlib.h>
+#include <string.h>
+#include "bit_ops.h"
+
+#define DIAGONAL_COST 1.414f
+
+// Direction vectors (cardinals first, then diagonals)
+static const int dxDir[8] = { 0, 1, 0, -1, 1, 1, -1, -1 }, dyDir[8] = { -1, 0, 1, 0, -1, 1, 1, -1 };
+
+float octileHeuristic(int x1, int y1, int x2, int y2) {
+    int ax = abs(x1 - x2), ay = abs(y1 - y2);
+    int lo = ax < ay ? ax : ay, hi = ax < ay ? ay : ax;
+    return (float)(hi - lo) + DIAGONAL_COST * lo;
+}
+
+void pathSearchInit(PathSearchContext* ctx, int width, int height) {
+    int cells = width * height;
+    ctx->width = width; ctx->height = height;
+    ctx->g = (float*)malloc(cells * sizeof(float));
+    ctx->f = (float*)malloc(cells * sizeof(float));
+    ctx->parent = (int*)malloc(cells * sizeof(int));
+    ctx->heapPos = (int*)malloc(cells * sizeof(int));
+    ctx->state = (unsigned char*)malloc(cells);
+    ctx->stamp = (unsigned int*)calloc(cells, sizeof(unsigned int));
+    ctx->heap = (int*)malloc(cells * sizeof(int));
+    ctx->currentStamp = 0;
+    ctx->heapSize = 0;
+    ctx->nodesExpanded = 0;
+    ctx->pathCost = 0.0f;
+}
+
+void pathSearchFree(PathSearchContext* ctx) {
+    free(ctx->g); free(ctx->f); free(ctx->parent); free(ctx->heapPos);
+    free(ctx->state); free(ctx->stamp); free(ctx->heap);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+// Heap helpers; lower f wins, ties go to the deeper node
+static bool heapLess(const PathSearchContext* ctx, int a, int b) {
+    if (ctx->f[a] != ctx->f[b]) return ctx->f[a] < ctx->f[b];
+    return ctx->g[a] > ctx->g[b];
+}
+
+static void heapSiftUp(PathSearchContext* ctx, int pos) {
+    int cell = ctx->heap[pos];
+    while (pos > 0) {
+        int parentPos = (pos - 1) / 2;
+        if (!heapLess(ctx, cell, ctx->heap[parentPos])) break;
+        ctx->heap[pos] = ctx->heap[parentPos];
+        ctx->heapPos[ctx->heap[pos]] = pos;
+        pos = parentPos;
+    }
+    ctx->heap[pos] = cell;
+    ctx->heapPos[cell] = pos;
+}
+
+static void heapSiftDown(PathSearchContext* ctx, int pos) {
+    int cell = ctx->heap[pos];
+    for (;;) {
+        int child = pos * 2 + 1;
+        if (child >= ctx->heapSize) break;
+        if (child + 1 < ctx->heapSize && heapLess(ctx, ctx->heap[child + 1], ctx->heap[child])) child++;
+        if (!heapLess(ctx, ctx->heap[child], cell)) break;
+        ctx->heap[pos] = ctx->heap[child];
+        ctx->heapPos[ctx->heap[pos]] = pos;
+        pos = child;
+    }
+    ctx->heap[pos] = cell;
+    ctx->heapPos[cell] = pos;
+}
+
+static int heapPop(PathSearchContext* ctx) {
+    int top = ctx->heap[0];
+    ctx->heapSize--;
+    if (ctx->heapSize > 0) {
+        ctx->heap[0] = ctx->heap[ctx->heapSize];
+        heapSiftDown(ctx, 0);
+    }
+    return top;
+}
+
+void pathSearchBegin(PathSearchContext* ctx) {
+    // Bump the stamp instead of clearing every node
+    if (++ctx->currentStamp == 0) {
+        memset(ctx->stamp, 0, ctx->width * ctx->height * sizeof(unsigned int));
+        ctx->currentStamp = 1;
+    }
+    ctx->heapSize = 0;
+    ctx->nodesExpanded = 0;
+}
+
+void pathSearchRelax(PathSearchContext* ctx, int node, int parent, float g, float h) {
+    const unsigned int stamp = ctx->currentStamp;
+    bool seen = ctx->stamp[node] == stamp;
+    if (seen && ctx->state[node] == 2) return;
+    if (!seen) {
+        ctx->stamp[node] = stamp;
+        ctx->state[node] = 1;
+        ctx->g[node] = g;
+        ctx->f[node] = g + h;
+        ctx->parent[node] = parent;
+        ctx->heap[ctx->heapSize] = node;
+        heapSiftUp(ctx, ctx->heapSize++);
+    }
+    else if (g < ctx->g[node]) {
+        // Decrease-key through the handle index
+        ctx->f[node] -= ctx->g[node] - g;
+        ctx->g[node] = g;
+        ctx->parent[node] = parent;
+        heapSiftUp(ctx, ctx->heapPos[node]);
+    }
+}
+
+int pathSearchPop(PathSearchContext* ctx) {
+    if (ctx->heapSize == 0) return -1;
+    int node = heapPop(ctx);
+    ctx->state[node] = 2;
+    ctx->nodesExpanded++;
+    return node;
+}
+
+// Moves open from (x, y) as bits in direction order. Each neighbour is read once;
+// a diagonal also needs both cardinal cells beside it free (the corner rule).
+static inline unsigned int freeMoves(const SpaceGrid* grid, int x, int y) {
+    unsigned int moves = 0;
+    for (int i = 0; i < 8; i++) moves |= (unsigned int)!spaceGridBlocked(grid, x + dxDir[i], y + dyDir[i]) << i;
+    unsigned int cardinals = moves & 0xF;
+    unsigned int corners = ((cardinals & 1) && (cardinals & 2)) << 4 | ((cardinals & 4) && (cardinals & 2)) << 5 |
+        ((cardinals & 4) && (cardinals & 8)) << 6 | ((cardinals & 1) && (cardinals & 8)) << 7;
+    return cardinals | (moves & corners);
+}
+
+int pathSearchFind(PathSearchContext* ctx, const SpaceGrid* grid, int startX, int startY,
+    int goalX, int goalY, Point* path, int maxPath) {
+    int width = grid->width, height = grid->height;
+    ctx->nodesExpanded = 0;
+    ctx->pathCost = 0.0f;
+
+    // Validate inputs
+    if (width != ctx->width || height != ctx->height ||
+        startX < 0 || startX >= width || startY < 0 || startY >= height ||
+        goalX < 0 || goalX >= width || goalY < 0 || goalY >= height ||
+        spaceGridBlocked(grid, startX, startY) || spaceGridBlocked(grid, goalX, goalY))
+        return -1;
+
+    pathSearchBegin(ctx);
+    int start = startY * width + startX, goal = goalY * width + goalX;
+    pathSearchRelax(ctx, start, -1, 0.0f, octileHeuristic(startX, startY, goalX, goalY));
+
+    for (int current; (current = pathSearchPop(ctx)) >= 0;) {
+        if (current == goal) {
+            ctx->pathCost = ctx->g[goal];
+            // Count and write the path from the goal back to the start
+            int length = 0;
+            for (int c = goal; c != -1; c = ctx->parent[c]) length++;
+            if (path) {
+                int i = length - 1;
+                for (int c = goal; c != -1; c = ctx->parent[c], i--) {
+                    if (i < maxPath) { path[i].x = c % width; path[i].y = c / width; }
+                }
+            }
+            return length;
+        }
+
+        int cy = current / width, cx = current - cy * width;
+        float g = ctx->g[current];
+        unsigned int moves = freeMoves(grid, cx, cy);
+        for (int i = 0; i < 8; i++) {
+            if (!((moves >> i) & 1)) continue;
+            int nx = cx + dxDir[i], ny = cy + dyDir[i];
+            int neighbor = ny * width + nx;
+            if (ctx->stamp[neighbor] == ctx->currentStamp && ctx->state[neighbor] == 2) continue;
+            pathSearchRelax(ctx, neighbor, current, g + (i < 4 ? 1.0f : DIAGONAL_COST),
+                octileHeuristic(nx, ny, goalX, goalY));
+        }
+    }
+    return -1;
+}
+
+// Jump Point Search under the corner rule. Jumps scan straight or diagonal
+// lines and stop only where the optimal path may turn, so the open set holds
+// a handful of jump points instead of every cell on the frontier.
+
+static inline bool cellFree(const SpaceGrid* grid, int x, int y) {
+    return !spaceGridBlocked(grid, x, y);
+}
+
+// Free cells x .. x + 7 of row y as bits 0 .. 7; cells off the map read as blocked
+static inline unsigned int freeBits8(const SpaceGrid* grid, int x, int y) {
+    if (y < 0 || y >= grid->height) return 0;
+    int base = x & ~GRID_TILE_MASK;
+    unsigned int window = 0;
+    for (int part = 0; part < 2; part++) {
+        int column = base + part * GRID_TILE_SIZE;
+        if (column < 0 || column >= grid->width) continue;
+        unsigned int bits = (uint8_t)~spaceGridRowByte(grid, column, y);
+        if (grid->width - column < GRID_TILE_SIZE) bits &= (1u << (grid->width - column)) - 1;
+        window |= bits << (part * GRID_TILE_SIZE);
+    }
+    return (window >> (x - base)) & 0xFF;
+}
+
+// Horizontal jumps test eight cells per step using the tile row bytes
+static bool jumpHorizontal(const SpaceGrid* grid, int x, int y, int dx, int goalX, int goalY, int* outX) {
+    for (int c = x + dx;; c += dx * 8) {
+        // Window of eight cells starting at the next cell in the direction of travel
+        int low = dx > 0 ? c : c - 7;
+        unsigned int here = freeBits8(grid, low, y);
+        unsigned int forced =
+            (freeBits8(grid, low, y - 1) & ~freeBits8(grid, low - dx, y - 1)) |
+            (freeBits8(grid, low, y + 1) & ~freeBits8(grid, low - dx, y + 1));
+        unsigned int stop = (~here | forced) & 0xFF;
+        if (y == goalY && goalX >= low && goalX < low + 8) stop |= 1u << (goalX - low);
+        if (!stop) continue;
+
+        int bit = dx > 0 ? lowestBit32(stop) : highestBit32(stop);
+        if (!((here >> bit) & 1)) return false;
+        *outX = low + bit;
+        return true;
+    }
+}
+
+// Straight jump from (x, y); a side cell that opens up behind a blocked one is a forced turn
+static bool jumpStraight(const SpaceGrid* grid, int x, int y, int dx, int dy, int goalX, int goalY, int* outX, int* outY) {
+    if (dx != 0) {
+        *outY = y;
+        return jumpHorizontal(grid, x, y, dx, goalX, goalY, outX);
+    }
+    for (;;) {
+        y += dy;
+        if (!cellFree(grid, x, y)) return false;
+        if (x == goalX && y == goalY) break;
+        if ((cellFree(grid, x - 1, y) && !cellFree(grid, x - 1, y - dy)) ||
+            (cellFree(grid, x + 1, y) && !cellFree(grid, x + 1, y - dy))) break;
+    }
+    *outX = x; *outY = y;
+    return true;
+}
+
+// Diagonal jump from (x, y); stops where either straight component finds a jump point
+static bool jumpDiagonal(const SpaceGrid* grid, int x, int y, int dx, int dy, int goalX, int goalY, int* outX, int* outY) {
+    int jx, jy;
+    for (;;) {
+        if (!cellFree(grid, x + dx, y) || !cellFree(grid, x, y + dy) || !cellFree(grid, x + dx, y + dy)) return false;
+        x += dx; y += dy;
+        if ((x == goalX && y == goalY) ||
+            jumpStraight(grid, x, y, dx, 0, goalX, goalY, &jx, &jy) ||
+            jumpStraight(grid, x, y, 0, dy, goalX, goalY, &jx, &jy)) break;
+    }
+    *outX = x; *outY = y;
+    return true;
+}
+
+static void pushOrRelax(PathSearchContext* ctx, int current, int nx, int ny, int goalX, int goalY) {
+    const int width = ctx->width;
+    int cx = current % width, cy = current / width;
+    pathSearchRelax(ctx, ny * width + nx, current, ctx->g[current] + octileHeuristic(cx, cy, nx, ny),
+        octileHeuristic(nx, ny, goalX, goalY));
+}
+
+static inline int signOf(int v) { return (v > 0) - (v < 0); }
+
+int pathSearchFindJPS(PathSearchContext* ctx, const SpaceGrid* grid, int startX, int startY,
+    int goalX, int goalY, Point* path, int maxPath) {
+    int width = grid->width, height = grid->height;
+    ctx->nodesExpanded = 0;
+    ctx->pathCost = 0.0f;
+
+    // Validate inputs
+    if (width != ctx->width || height != ctx->height ||
+        startX < 0 || startX >= width || startY < 0 || startY >= height ||
+        goalX < 0 || goalX >= width || goalY < 0 || goalY >= height ||
+        spaceGridBlocked(grid, startX, startY) || spaceGridBlocked(grid, goalX, goalY))
+        return -1;
+
+    pathSearchBegin(ctx);
+    int start = startY * width + startX, goal = goalY * width + goalX;
+    pathSearchRelax(ctx, start, -1, 0.0f, octileHeuristic(startX, startY, goalX, goalY));
+
+    for (int current; (current = pathSearchPop(ctx)) >= 0;) {
+
+        if (current == goal) {
+            ctx->pathCost = ctx->g[goal];
+            // Jump points are joined by straight or diagonal runs; count the cells between them
+            int length = 1;
+            for (int c = goal; ctx->parent[c] != -1; c = ctx->parent[c]) {
+                int p = ctx->parent[c];
+                int ax = abs(c % width - p % width), ay = abs(c / width - p / width);
+                length += ax > ay ? ax : ay;
+            }
+            if (path) {
+                int i = length - 1;
+                for (int c = goal; c != -1; c = ctx->parent[c]) {
+                    int x = c % width, y = c / width, p = ctx->parent[c];
+                    int px = p < 0 ? x : p % width, py = p < 0 ? y : p / width;
+                    int dx = signOf(px - x), dy = signOf(py - y);
+                    // Write from this jump point back to, but not including, its parent
+                    do {
+                        if (i < maxPath) { path[i].x = x; path[i].y = y; }
+                        i--; x += dx; y += dy;
+                    } while (p >= 0 && (x != px || y != py));
+                }
+            }
+            return length;
+        }
+
+        int cx = current % width, cy = current / width, parent = ctx->parent[current];
+        int dirX[8], dirY[8], dirCount = 0;
+        if (parent < 0) {
+            for (int i = 0; i < 8; i++) { dirX[dirCount] = dxDir[i]; dirY[dirCount++] = dyDir[i]; }
+        }
+        else {
+            // Natural and forced directions given the direction we arrived from
+            int dx = signOf(cx - parent % width), dy = signOf(cy - parent / width);
+            if (dx != 0 && dy != 0) {
+                dirX[dirCount] = 0; dirY[dirCount++] = dy;
+                dirX[dirCount] = dx; dirY[dirCount++] = 0;
+                dirX[dirCount] = dx; dirY[dirCount++] = dy;
+            }
+            else if (dx != 0) {
+                dirX[dirCount] = dx; dirY[dirCount++] = 0;
+                for (int side = -1; side <= 1; side += 2) {
+                    if (!cellFree(grid, cx, cy + side)) continue;
+                    dirX[dirCount] = 0; dirY[dirCount++] = side;
+                    dirX[dirCount] = dx; dirY[dirCount++] = side;
+                }
+            }
+            else {
+                dirX[dirCount] = 0; dirY[dirCount++] = dy;
+                for (int side = -1; side <= 1; side += 2) {
+                    if (!cellFree(grid, cx + side, cy)) continue;
+                    dirX[dirCount] = side; dirY[dirCount++] = 0;
+                    dirX[dirCount] = side; dirY[dirCount++] = dy;
+                }
+            }
+        }
+
+        for (int i = 0; i < dirCount; i++) {
+            int jx, jy;
+            bool found = dirX[i] != 0 && dirY[i] != 0 ?
+                jumpDiagonal(grid, cx, cy, dirX[i], dirY[i], goalX, goalY, &jx, &jy) :
+                jumpStraight(grid, cx, cy, dirX[i], dirY[i], goalX, goalY, &jx, &jy);
+            if (found) pushOrRelax(ctx, current, jx, jy, goalX, goalY);
+        }
+    }
+    return -1;
+}
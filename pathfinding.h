@@ -0,0 +1,52 @@
+#ifndef PATHFINDING_H
+#define PATHFINDING_H
+
+#include <stdbool.h>
+#include "game_world.h"
+#include "space_grid.h"
+
+// Reusable A* state for one grid size. Per-cell arrays are reset lazily with a
+// search stamp, so back-to-back searches cost only the cells they touch.
+typedef struct {
+    int width, height;
+    float* g;               // Cost from start
+    float* f;               // g + heuristic
+    int* parent;            // Parent cell index
+    int* heapPos;           // Handle: position of the cell in the open heap
+    unsigned char* state;   // 0 = unseen, 1 = open, 2 = closed
+    unsigned int* stamp;    // Search that last touched the cell
+    unsigned int currentStamp;
+    int* heap;              // Binary min-heap of cell indices ordered by f
+    int heapSize;
+    int nodesExpanded;      // Stats for the last search
+    float pathCost;
+} PathSearchContext;
+
+void pathSearchInit(PathSearchContext* ctx, int width, int height);
+void pathSearchFree(PathSearchContext* ctx);
+
+// 8-direction A* with the game's corner rule (a diagonal step needs both
+// adjacent cardinal cells free). Returns the number of cells on the path,
+// start and goal included, or -1 if the goal is unreachable. Up to maxPath
+// points are written to path, which may be NULL.
+int pathSearchFind(PathSearchContext* ctx, const SpaceGrid* grid, int startX, int startY,
+    int goalX, int goalY, Point* path, int maxPath);
+
+// Jump Point Search with the same moves, corner rule and costs as
+// pathSearchFind; returns a path of the same cost with the same conventions.
+// Expands only jump points, so it pays off on larger, more open maps.
+int pathSearchFindJPS(PathSearchContext* ctx, const SpaceGrid* grid, int startX, int startY,
+    int goalX, int goalY, Point* path, int maxPath);
+
+// Building blocks for searches over other graphs: node ids index the context's
+// arrays (size it width * 1 for a graph of width nodes). Begin starts a search;
+// Relax opens a node or lowers its g, with h as its heuristic, and ignores
+// closed nodes; Pop closes and returns the open node with the lowest f, or -1.
+void pathSearchBegin(PathSearchContext* ctx);
+void pathSearchRelax(PathSearchContext* ctx, int node, int parent, float g, float h);
+int pathSearchPop(PathSearchContext* ctx);
+
+// Octile distance matching the 1 / 1.414 step costs
+float octileHeuristic(int x1, int y1, int x2, int y2);
+
+#endif
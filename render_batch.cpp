@@ -0,0 +1,129 @@
+#include "render_batch.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+void batchInit(RenderBatch* batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->r = batch->g = batch->b = batch->a = 1.0f;
+    batch->pointSize = batch->lineWidth = 1.0f;
+    batch->cosAngle = 1.0f;
+}
+
+void batchFree(RenderBatch* batch) {
+    for (int i = 0; i < batch->bucketCount; i++) free(batch->buckets[i].vertices);
+    memset(batch, 0, sizeof(*batch));
+}
+
+void batchClear(RenderBatch* batch) {
+    for (int i = 0; i < batch->bucketCount; i++) batch->buckets[i].count = 0;
+    batch->primitives = batch->vertices = 0;
+}
+
+void batchTransform(RenderBatch* batch, float x, float y, float radians) {
+    batch->transformed = true;
+    batch->tx = x; batch->ty = y;
+    batch->cosAngle = cosf(radians); batch->sinAngle = sinf(radians);
+}
+
+void batchIdentity(RenderBatch* batch) {
+    batch->transformed = false;
+    batch->tx = batch->ty = batch->sinAngle = 0.0f;
+    batch->cosAngle = 1.0f;
+}
+
+// Bucket for a primitive and size. When all buckets are taken the shape joins
+// the one of its primitive with the nearest size, or is dropped if there is none.
+static BatchBucket* findBucket(RenderBatch* batch, BatchShape primitive, float size) {
+    if (primitive == BATCH_TRIANGLES) size = 0.0f;
+    else size = fmaxf(BATCH_SIZE_STEP, roundf(size / BATCH_SIZE_STEP) * BATCH_SIZE_STEP);
+    BatchBucket* nearest = NULL;
+    for (int i = 0; i < batch->bucketCount; i++) {
+        BatchBucket* bucket = &batch->buckets[i];
+        if (bucket->primitive != primitive) continue;
+        if (bucket->size == size) return bucket;
+        if (!nearest || fabsf(bucket->size - size) < fabsf(nearest->size - size)) nearest = bucket;
+    }
+    if (batch->bucketCount == BATCH_MAX_BUCKETS) return nearest;
+    BatchBucket* bucket = &batch->buckets[batch->bucketCount++];
+    bucket->primitive = primitive;
+    bucket->size = size;
+    bucket->vertices = (BatchVertex*)malloc(BATCH_INITIAL_VERTICES * sizeof(BatchVertex));
+    bucket->count = 0;
+    bucket->capacity = BATCH_INITIAL_VERTICES;
+    return bucket;
+}
+
+void batchBegin(RenderBatch* batch, BatchShape shape) {
+    BatchShape primitive = BATCH_TRIANGLES;
+    float size = 0.0f;
+    if (shape == BATCH_POINTS) { primitive = BATCH_POINTS; size = batch->pointSize; }
+    else if (shape == BATCH_LINES || shape == BATCH_LINE_STRIP || shape == BATCH_LINE_LOOP) {
+        primitive = BATCH_LINES; size = batch->lineWidth;
+    }
+    batch->shape = shape;
+    batch->target = findBucket(batch, primitive, size);
+    batch->shapeVertices = 0;
+    batch->primitives++;
+}
+
+static inline void emit(RenderBatch* batch, const BatchVertex* vertices, int count) {
+    BatchBucket* bucket = batch->target;
+    if (bucket->count + count > bucket->capacity) {
+        bucket->capacity *= 2;
+        bucket->vertices = (BatchVertex*)realloc(bucket->vertices, bucket->capacity * sizeof(BatchVertex));
+    }
+    BatchVertex* out = bucket->vertices + bucket->count;
+    for (int i = 0; i < count; i++) out[i] = vertices[i];
+    bucket->count += count;
+    batch->vertices += count;
+}
+
+void batchVertex(RenderBatch* batch, float x, float y) {
+    if (!batch->target) return;
+    BatchVertex v = { x, y, batch->r, batch->g, batch->b, batch->a };
+    if (batch->transformed) {
+        v.x = batch->tx + batch->cosAngle * x - batch->sinAngle * y;
+        v.y = batch->ty + batch->sinAngle * x + batch->cosAngle * y;
+    }
+    int n = batch->shapeVertices++;
+    BatchVertex* held = batch->held;
+    switch (batch->shape) {
+    case BATCH_POINTS: emit(batch, &v, 1); break;
+    case BATCH_LINES:
+        if (n % 2 == 0) held[0] = v;
+        else { held[1] = v; emit(batch, held, 2); }
+        break;
+    case BATCH_LINE_STRIP: case BATCH_LINE_LOOP:
+        if (n == 0) batch->first = v;
+        else { held[1] = v; emit(batch, held, 2); }
+        held[0] = v;
+        break;
+    case BATCH_TRIANGLES:
+        held[n % 3] = v;
+        if (n % 3 == 2) emit(batch, held, 3);
+        break;
+    case BATCH_TRIANGLE_STRIP:
+        // Winding alternates; nothing is culled, so it is kept as it comes
+        if (n >= 2) { held[2] = v; emit(batch, held, 3); held[0] = held[1]; held[1] = v; }
+        else held[n] = v;
+        break;
+    case BATCH_TRIANGLE_FAN:
+        if (n == 0) batch->first = v;
+        else if (n >= 2) { BatchVertex triangle[3] = { batch->first, held[0], v }; emit(batch, triangle, 3); }
+        held[0] = v;
+        break;
+    case BATCH_QUADS:
+        if (n % 4 < 3) held[n % 4] = v;
+        else { BatchVertex quad[6] = { held[0], held[1], held[2], held[0], held[2], v }; emit(batch, quad, 6); }
+        break;
+    }
+}
+
+void batchEnd(RenderBatch* batch) {
+    if (batch->target && batch->shape == BATCH_LINE_LOOP && batch->shapeVertices >= 2) {
+        BatchVertex closing[2] = { batch->held[0], batch->first };
+        emit(batch, closing, 2);
+    }
+    batch->target = NULL;
+}
@@ -0,0 +1,78 @@
+#ifndef RENDER_BATCH_H
+#define RENDER_BATCH_H
+
+#include <stdbool.h>
+
+// Collects a frame's geometry into a few vertex arrays. Callers describe
+// shapes the way immediate mode does (begin, color, vertices, end), and each
+// shape is taken apart into independent triangles, lines or points as the
+// vertices arrive, then appended to the bucket for its primitive and point
+// size or line width. A flush draws every bucket with one call, so a frame
+// costs a draw per bucket instead of one per shape.
+//
+// Buckets are drawn triangles first, then lines, then points: shapes of
+// different primitives that overlap between two flushes are layered by
+// primitive, not by the order they were described in. Callers flush where
+// order matters, e.g. before text or a change of projection.
+//
+// Nothing here touches OpenGL; the renderer draws the buckets.
+
+#define BATCH_MAX_BUCKETS 16        // Primitive and size pairs held between flushes
+#define BATCH_SIZE_STEP 0.5f        // Point sizes and line widths are rounded to this
+#define BATCH_INITIAL_VERTICES 1024 // Per bucket; grows as needed
+
+typedef enum {
+    BATCH_TRIANGLES, BATCH_LINES, BATCH_POINTS,     // What buckets hold
+    BATCH_TRIANGLE_STRIP, BATCH_TRIANGLE_FAN, BATCH_QUADS, BATCH_LINE_STRIP, BATCH_LINE_LOOP,
+} BatchShape;
+
+typedef struct { float x, y, r, g, b, a; } BatchVertex;
+
+typedef struct {
+    BatchShape primitive;   // BATCH_TRIANGLES, BATCH_LINES or BATCH_POINTS
+    float size;             // Line width or point size; 0 for triangles
+    BatchVertex* vertices;
+    int count, capacity;
+} BatchBucket;
+
+typedef struct {
+    BatchBucket buckets[BATCH_MAX_BUCKETS];
+    int bucketCount;
+    int primitives;         // Shapes described since the last clear
+    int vertices;           // Vertices held in all buckets
+
+    // Current state, applied to the shapes that follow
+    float r, g, b, a;
+    float pointSize, lineWidth;
+    bool transformed;       // Vertices are rotated, then moved by (tx, ty)
+    float tx, ty, cosAngle, sinAngle;
+
+    // Shape being described
+    BatchShape shape;
+    BatchBucket* target;
+    int shapeVertices;
+    BatchVertex first, held[3];
+} RenderBatch;
+
+void batchInit(RenderBatch* batch);
+void batchFree(RenderBatch* batch);
+
+// Empties the buckets once they are drawn; state and capacity are kept
+void batchClear(RenderBatch* batch);
+
+static inline void batchColor(RenderBatch* batch, float r, float g, float b, float a) {
+    batch->r = r; batch->g = g; batch->b = b; batch->a = a;
+}
+static inline void batchPointSize(RenderBatch* batch, float size) { batch->pointSize = size; }
+static inline void batchLineWidth(RenderBatch* batch, float width) { batch->lineWidth = width; }
+
+// Rotates the following vertices by radians about the origin, then moves them to (x, y)
+void batchTransform(RenderBatch* batch, float x, float y, float radians);
+void batchIdentity(RenderBatch* batch);
+
+// A shape as in glBegin/glVertex/glEnd; incomplete primitives are dropped
+void batchBegin(RenderBatch* batch, BatchShape shape);
+void batchVertex(RenderBatch* batch, float x, float y);
+void batchEnd(RenderBatch* batch);
+
+#endif
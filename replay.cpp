@@ -0,0 +1,213 @@
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define DELTA_ESCAPE 63         // Delta field value meaning "varint follows"
+
+static void put16(uint8_t* p, unsigned int v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); }
+static void put32(uint8_t* p, uint32_t v) { put16(p, v & 0xFFFF); put16(p + 2, v >> 16); }
+static void put64(uint8_t* p, uint64_t v) { put32(p, (uint32_t)v); put32(p + 4, (uint32_t)(v >> 32)); }
+static unsigned int get16(const uint8_t* p) { return p[0] | (unsigned int)p[1] << 8; }
+static uint32_t get32(const uint8_t* p) { return get16(p) | (uint32_t)get16(p + 2) << 16; }
+static uint64_t get64(const uint8_t* p) { return get32(p) | (uint64_t)get32(p + 4) << 32; }
+
+void replayInit(Replay* replay) {
+    memset(replay, 0, sizeof(*replay));
+    replay->result = GAME_PLAYING;
+}
+
+void replayFree(Replay* replay) {
+    free(replay->inputs);
+    replayInit(replay);
+}
+
+static void appendInput(Replay* replay, int tick, MoveDirection move) {
+    if (replay->inputCount == replay->inputCapacity) {
+        replay->inputCapacity = replay->inputCapacity ? replay->inputCapacity * 2 : 64;
+        replay->inputs = (ReplayInput*)realloc(replay->inputs, replay->inputCapacity * sizeof(ReplayInput));
+    }
+    replay->inputs[replay->inputCount].tick = tick;
+    replay->inputs[replay->inputCount].move = move;
+    replay->inputCount++;
+}
+
+void replayBegin(Replay* replay, const GameWorld* world) {
+    replay->mapSeed = world->map.seed;
+    replay->difficulty = world->difficulty;
+    replay->width = world->map.grid.width;
+    replay->height = world->map.grid.height;
+    replay->inputCount = 0;
+    replay->result = GAME_PLAYING;
+    replay->gameTime = replay->coinsCollected = replay->ticks = 0;
+}
+
+void replayRecordInput(Replay* replay, const GameWorld* world, MoveDirection move) {
+    if (world->state != GAME_PLAYING || move == MOVE_NONE) return;
+    appendInput(replay, world->tickCount, move);
+}
+
+void replayFinish(Replay* replay, const GameWorld* world) {
+    replay->result = world->state;
+    replay->gameTime = world->gameTime;
+    replay->coinsCollected = world->player.coinsCollected;
+    replay->ticks = world->tickCount;
+}
+
+static size_t varintSize(uint32_t v) {
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+size_t replayEncodedSize(const Replay* replay) {
+    size_t size = REPLAY_HEADER_BYTES;
+    int lastTick = 0;
+    for (int i = 0; i < replay->inputCount; i++) {
+        uint32_t delta = (uint32_t)(replay->inputs[i].tick - lastTick);
+        size += 1 + (delta >= DELTA_ESCAPE ? varintSize(delta - DELTA_ESCAPE) : 0);
+        lastTick = replay->inputs[i].tick;
+    }
+    return size;
+}
+
+size_t replayEncode(const Replay* replay, uint8_t* out) {
+    // Header: magic, map seed, ticks, width, height, game time, difficulty, result, coins, 3 spare
+    memset(out, 0, REPLAY_HEADER_BYTES);
+    memcpy(out, REPLAY_MAGIC, 8);
+    put64(out + 8, replay->mapSeed);
+    put32(out + 16, (uint32_t)replay->ticks);
+    put16(out + 20, replay->width);
+    put16(out + 22, replay->height);
+    put32(out + 24, (uint32_t)replay->gameTime);
+    out[28] = (uint8_t)replay->difficulty;
+    out[29] = (uint8_t)replay->result;
+    out[30] = (uint8_t)replay->coinsCollected;
+
+    size_t at = REPLAY_HEADER_BYTES;
+    int lastTick = 0;
+    for (int i = 0; i < replay->inputCount; i++) {
+        uint32_t delta = (uint32_t)(replay->inputs[i].tick - lastTick);
+        lastTick = replay->inputs[i].tick;
+        int direction = replay->inputs[i].move - MOVE_UP;
+        if (delta < DELTA_ESCAPE) {
+            out[at++] = (uint8_t)(delta << 2 | direction);
+            continue;
+        }
+        out[at++] = (uint8_t)(DELTA_ESCAPE << 2 | direction);
+        for (delta -= DELTA_ESCAPE; delta >= 0x80; delta >>= 7) out[at++] = (uint8_t)(delta | 0x80);
+        out[at++] = (uint8_t)delta;
+    }
+    return at;
+}
+
+bool replayDecode(Replay* replay, const uint8_t* data, size_t size) {
+    if (size < REPLAY_HEADER_BYTES || memcmp(data, REPLAY_MAGIC, 8) != 0) return false;
+    replay->mapSeed = get64(data + 8);
+    replay->ticks = (int)get32(data + 16);
+    replay->width = (int)get16(data + 20);
+    replay->height = (int)get16(data + 22);
+    replay->gameTime = (int)get32(data + 24);
+    replay->difficulty = (DifficultyLevel)data[28];
+    replay->result = (GameState)data[29];
+    replay->coinsCollected = data[30];
+    if (replay->difficulty > DIFFICULTY_HARD || replay->result > GAME_LOSE) return false;
+    if (replay->width < MIN_GRID_SIZE || replay->height < MIN_GRID_SIZE) return false;
+
+    replay->inputCount = 0;
+    size_t at = REPLAY_HEADER_BYTES;
+    uint32_t tick = 0;
+    while (at < size) {
+        uint8_t byte = data[at++];
+        uint32_t delta = byte >> 2;
+        if (delta == DELTA_ESCAPE) {
+            uint32_t extra = 0;
+            int shift = 0;
+            for (;;) {
+                if (at == size || shift > 28) return false;
+                uint8_t part = data[at++];
+                extra |= (uint32_t)(part & 0x7F) << shift;
+                shift += 7;
+                if (!(part & 0x80)) break;
+            }
+            delta += extra;
+        }
+        tick += delta;
+        if (tick > (uint32_t)replay->ticks) return false;
+        appendInput(replay, (int)tick, (MoveDirection)(MOVE_UP + (byte & 3)));
+    }
+    return true;
+}
+
+bool replaySave(const Replay* replay, const char* path) {
+    size_t size = replayEncodedSize(replay);
+    uint8_t* data = (uint8_t*)malloc(size);
+    replayEncode(replay, data);
+    FILE* file = fopen(path, "wb");
+    bool ok = file && fwrite(data, 1, size, file) == size;
+    if (file && fclose(file) != 0) ok = false;
+    free(data);
+    return ok;
+}
+
+bool replayLoad(Replay* replay, const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) return false;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    bool ok = size > 0;
+    uint8_t* data = (uint8_t*)malloc(ok ? size : 1);
+    if (ok) ok = fread(data, 1, size, file) == (size_t)size;
+    fclose(file);
+    if (ok) ok = replayDecode(replay, data, size);
+    free(data);
+    return ok;
+}
+
+ReplayCheck replaySimulate(GameWorld* world, const Replay* replay) {
+    if (world->map.grid.width != replay->width || world->map.grid.height != replay->height) {
+        gameWorldFree(world);
+        gameWorldInit(world, replay->difficulty, replay->width, replay->height, replay->mapSeed);
+    }
+    generateEnvironment(&world->map, replay->difficulty, false, replay->mapSeed);
+    gameWorldStartGame(world, replay->difficulty);
+
+    // Moves land before the tick they were recorded on; the time limit ends
+    // every game, so the loop always terminates
+    int next = 0;
+    while (world->state == GAME_PLAYING) {
+        while (next < replay->inputCount && replay->inputs[next].tick <= world->tickCount && world->state == GAME_PLAYING) {
+            GameInput input = { replay->inputs[next++].move };
+            gameWorldStep(world, &input, 0.0f);
+        }
+        if (world->state == GAME_PLAYING) gameWorldStep(world, NULL, SIM_TICK_SECONDS);
+    }
+
+    ReplayCheck check;
+    check.result = world->state;
+    check.gameTime = world->gameTime;
+    check.coinsCollected = world->player.coinsCollected;
+    check.ticks = world->tickCount;
+    check.matches = check.result == replay->result && check.gameTime == replay->gameTime &&
+        check.coinsCollected == replay->coinsCollected && check.ticks == replay->ticks && next == replay->inputCount;
+    return check;
+}
+
+typedef struct { const Replay* replays; ReplayCheck* out; } VerifyBatch;
+
+static void verifyRange(void* data, int begin, int end) {
+    VerifyBatch* batch = (VerifyBatch*)data;
+    // One world per range, reused while the grid size stays the same
+    GameWorld* world = (GameWorld*)malloc(sizeof(GameWorld));
+    const Replay* first = &batch->replays[begin];
+    gameWorldInit(world, first->difficulty, first->width, first->height, first->mapSeed);
+    for (int i = begin; i < end; i++) batch->out[i] = replaySimulate(world, &batch->replays[i]);
+    gameWorldFree(world);
+    free(world);
+}
+
+void replayVerifyBatch(JobSystem* jobs, const Replay* replays, int count, ReplayCheck* out) {
+    VerifyBatch batch = { replays, out };
+    jobParallelFor(jobs, "replay.verify", count, 64, verifyRange, &batch);
+}
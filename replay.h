@@ -0,0 +1,66 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "game_world.h"
+#include "job_system.h"
+
+// Input replays. A replay holds what it takes to rebuild a game (map seed,
+// difficulty, grid size) and every move with the simulation tick it was made
+// on, plus the outcome as it was played. The simulation only advances in
+// whole ticks and moves land between ticks, so re-simulating a replay without
+// a window reproduces the game exactly, at thousands of games per second.
+//
+// On disk: a 32-byte little-endian header, then one byte per move holding the
+// move and the ticks since the previous one; longer gaps spill into a varint.
+
+#define REPLAY_MAGIC "CLWRPL01"
+#define REPLAY_HEADER_BYTES 32
+
+typedef struct { int tick; MoveDirection move; } ReplayInput;
+
+typedef struct {
+    uint64_t mapSeed;
+    DifficultyLevel difficulty;
+    int width, height;
+    ReplayInput* inputs;
+    int inputCount, inputCapacity;
+
+    // Outcome as recorded; result stays GAME_PLAYING until replayFinish
+    GameState result;
+    int gameTime, coinsCollected, ticks;
+} Replay;
+
+typedef struct {
+    GameState result;       // Outcome of the re-simulation
+    int gameTime, coinsCollected, ticks;
+    bool matches;           // Everything above equals the recording
+} ReplayCheck;
+
+void replayInit(Replay* replay);
+void replayFree(Replay* replay);
+
+// Recording: replayBegin right after the game started, replayRecordInput
+// before each move is applied, replayFinish once it is won or lost
+void replayBegin(Replay* replay, const GameWorld* world);
+void replayRecordInput(Replay* replay, const GameWorld* world, MoveDirection move);
+void replayFinish(Replay* replay, const GameWorld* world);
+
+// Encoded size, and encoding into a buffer of at least that many bytes
+size_t replayEncodedSize(const Replay* replay);
+size_t replayEncode(const Replay* replay, uint8_t* out);
+// Returns false on a malformed or truncated buffer
+bool replayDecode(Replay* replay, const uint8_t* data, size_t size);
+
+bool replaySave(const Replay* replay, const char* path);
+bool replayLoad(Replay* replay, const char* path);
+
+// Plays the replay on world, which must come from gameWorldInit; it is
+// resized to the replay's grid when needed
+ReplayCheck replaySimulate(GameWorld* world, const Replay* replay);
+
+// Checks every replay, spread over the job system (which may be NULL)
+void replayVerifyBatch(JobSystem* jobs, const Replay* replays, int count, ReplayCheck* out);
+
+#endif
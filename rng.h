@@ -0,0 +1,56 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Small deterministic random streams (xoshiro256**). Every subsystem owns its
+// own stream derived from one master seed, so map generation never depends on
+// how many frames were drawn, and streams can be used from different threads
+// without sharing state.
+
+typedef struct { uint64_t s[4]; } RngStream;
+
+// Subsystem stream ids for rngDeriveSeed
+typedef enum { RNG_STREAM_MAPGEN, RNG_STREAM_VISUALS, RNG_STREAM_RENDER } RngStreamId;
+
+// SplitMix64 step; spreads nearby seeds over the whole state space
+static inline uint64_t rngSplitMix(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Independent child seed, e.g. one per subsystem or per generation attempt
+static inline uint64_t rngDeriveSeed(uint64_t seed, uint64_t stream) {
+    uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ull);
+    rngSplitMix(&x);
+    return rngSplitMix(&x);
+}
+
+static inline void rngSeed(RngStream* rng, uint64_t seed) {
+    for (int i = 0; i < 4; i++) rng->s[i] = rngSplitMix(&seed);
+}
+
+static inline uint64_t rngNext(RngStream* rng) {
+    uint64_t* s = rng->s;
+    uint64_t x = s[1] * 5;
+    uint64_t result = ((x << 7) | (x >> 57)) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return result;
+}
+
+// Uniform in [0, n) for n > 0, by multiply-shift instead of modulo
+static inline int rngRange(RngStream* rng, int n) {
+    return (int)(((rngNext(rng) >> 32) * (uint64_t)n) >> 32);
+}
+
+// Uniform in [0, 1)
+static inline float rngFloat(RngStream* rng) {
+    return (float)(rngNext(rng) >> 40) * (1.0f / 16777216.0f);
+}
+
+#endif
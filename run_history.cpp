@@ -0,0 +1,490 @@
+#include "run_history.h"
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <io.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define LOG_HEADER_BYTES 16     // Magic, record size, 4 spare
+#define RECORD_BYTES 32
+#define INDEX_HEADER_BYTES 32   // Magic, records covered, their last CRC, win counts, header CRC
+#define INDEX_ENTRY_BYTES 8
+#define SCAN_RECORDS 4096       // Records read per block when rebuilding on open
+
+// Platform file calls: durable flush, truncate, atomic replace, read-only map
+#ifdef _WIN32
+static bool syncFile(FILE* file) { return _commit(_fileno(file)) == 0; }
+static bool truncateFile(FILE* file, long size) { return _chsize(_fileno(file), size) == 0; }
+static bool replaceFile(const char* from, const char* to) {
+    return MoveFileExA(from, to, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+}
+static void* mapFile(const char* path, size_t* size) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return NULL;
+    void* view = NULL;
+    LARGE_INTEGER length;
+    if (GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+        *size = (size_t)length.QuadPart;
+    }
+    CloseHandle(file);
+    return view;
+}
+static void unmapFile(void* view, size_t size) { (void)size; UnmapViewOfFile(view); }
+#else
+static bool syncFile(FILE* file) { return fsync(fileno(file)) == 0; }
+static bool truncateFile(FILE* file, long size) { return ftruncate(fileno(file), size) == 0; }
+static bool replaceFile(const char* from, const char* to) { return rename(from, to) == 0; }
+static void* mapFile(const char* path, size_t* size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    void* view = NULL;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (view == MAP_FAILED) view = NULL;
+        *size = (size_t)info.st_size;
+    }
+    close(fd);
+    return view;
+}
+static void unmapFile(void* view, size_t size) { munmap(view, size); }
+#endif
+
+static double secondsSince(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - since).count();
+}
+
+static void put32(uint8_t* p, uint32_t v) { p[0] = (uint8_t)v; p[1] = (uint8_t)(v >> 8); p[2] = (uint8_t)(v >> 16); p[3] = (uint8_t)(v >> 24); }
+static void put64(uint8_t* p, uint64_t v) { put32(p, (uint32_t)v); put32(p + 4, (uint32_t)(v >> 32)); }
+static uint32_t get32(const uint8_t* p) { return p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24; }
+static uint64_t get64(const uint8_t* p) { return get32(p) | (uint64_t)get32(p + 4) << 32; }
+
+// CRC-32 (IEEE)
+typedef struct { uint32_t entries[256]; } CrcTable;
+
+static CrcTable makeCrcTable(void) {
+    CrcTable table;
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; k++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+        table.entries[i] = c;
+    }
+    return table;
+}
+
+static const CrcTable crcTable = makeCrcTable();
+
+static uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t c = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) c = crcTable.entries[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Record: sequence, finishedAt, seed, game time, ticks, difficulty, result,
+// coins, total coins, then the CRC of those 28 bytes
+static void encodeRecord(const RunRecord* record, uint8_t* out) {
+    put32(out, record->sequence);
+    put32(out + 4, record->finishedAt);
+    put64(out + 8, record->mapSeed);
+    put32(out + 16, (uint32_t)record->gameTime);
+    put32(out + 20, (uint32_t)record->ticks);
+    out[24] = (uint8_t)record->difficulty;
+    out[25] = (uint8_t)record->result;
+    out[26] = (uint8_t)record->coinsCollected;
+    out[27] = (uint8_t)record->totalCoins;
+    put32(out + 28, crc32(out, RECORD_BYTES - 4));
+}
+
+// False when the record fails its CRC, sits at the wrong position or holds
+// values no game produces
+static bool decodeRecord(const uint8_t* data, uint32_t sequence, RunRecord* record) {
+    if (get32(data + 28) != crc32(data, RECORD_BYTES - 4) || get32(data) != sequence) return false;
+    record->sequence = sequence;
+    record->finishedAt = get32(data + 4);
+    record->mapSeed = get64(data + 8);
+    record->gameTime = (int)get32(data + 16);
+    record->ticks = (int)get32(data + 20);
+    record->difficulty = (DifficultyLevel)data[24];
+    record->result = (GameState)data[25];
+    record->coinsCollected = data[26];
+    record->totalCoins = data[27];
+    return record->difficulty <= DIFFICULTY_HARD && (record->result == GAME_WIN || record->result == GAME_LOSE);
+}
+
+static inline bool ranksBefore(const RunIndexEntry* a, const RunIndexEntry* b) {
+    return a->gameTime != b->gameTime ? a->gameTime < b->gameTime : a->sequence < b->sequence;
+}
+
+static int recentTotal(const RunHistory* history) {
+    int total = 0;
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) total += history->recentCount[d];
+    return total;
+}
+
+static void pushRecent(RunHistory* history, int difficulty, RunIndexEntry entry) {
+    if (history->recentCount[difficulty] == history->recentCapacity[difficulty]) {
+        int capacity = history->recentCapacity[difficulty] ? history->recentCapacity[difficulty] * 2 : 64;
+        history->recent[difficulty] = (RunIndexEntry*)realloc(history->recent[difficulty], capacity * sizeof(RunIndexEntry));
+        history->recentCapacity[difficulty] = capacity;
+    }
+    history->recent[difficulty][history->recentCount[difficulty]++] = entry;
+}
+
+// Sorted insert; a new entry has the highest sequence, so it goes after every equal time
+static void insertRecent(RunHistory* history, int difficulty, RunIndexEntry entry) {
+    pushRecent(history, difficulty, entry);
+    RunIndexEntry* list = history->recent[difficulty];
+    int last = history->recentCount[difficulty] - 1;
+    int at = (int)(std::upper_bound(list, list + last, entry, [](const RunIndexEntry& a, const RunIndexEntry& b) { return ranksBefore(&a, &b); }) - list);
+    memmove(list + at + 1, list + at, (last - at) * sizeof(RunIndexEntry));
+    list[at] = entry;
+}
+
+static void dropIndex(RunHistory* history) {
+    if (history->indexMap) unmapFile(history->indexMap, history->indexMapSize);
+    history->indexMap = NULL;
+    history->indexMapSize = 0;
+    history->indexCovers = 0;
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        history->indexed[d] = NULL;
+        history->indexedCount[d] = 0;
+    }
+}
+
+// Maps the index file and checks it is whole and covers at most logRecords
+// records. When lastCrc is given it must name the last covered record.
+// Entries are stored little-endian and read in place, like every target we build for.
+static bool mapIndex(RunHistory* history, uint32_t logRecords, FILE* log) {
+    dropIndex(history);
+    size_t size = 0;
+    uint8_t* map = (uint8_t*)mapFile(history->indexPath, &size);
+    if (!map) return false;
+    bool ok = size >= INDEX_HEADER_BYTES && memcmp(map, RUN_HISTORY_INDEX_MAGIC, 8) == 0 &&
+        get32(map + 28) == crc32(map, INDEX_HEADER_BYTES - 4);
+    uint32_t covers = ok ? get32(map + 8) : 0;
+    size_t entries = 0;
+    for (int d = 0; ok && d < RUN_HISTORY_DIFFICULTIES; d++) entries += get32(map + 16 + 4 * d);
+    ok = ok && covers <= logRecords && entries <= covers && size == INDEX_HEADER_BYTES + entries * INDEX_ENTRY_BYTES;
+    if (ok && log && covers > 0) {
+        uint8_t stored[4];
+        ok = fseek(log, LOG_HEADER_BYTES + (long)(covers - 1) * RECORD_BYTES + 28, SEEK_SET) == 0 &&
+            fread(stored, 1, 4, log) == 4 && get32(stored) == get32(map + 12);
+    }
+    if (!ok) {
+        unmapFile(map, size);
+        return false;
+    }
+    history->indexMap = map;
+    history->indexMapSize = size;
+    history->indexCovers = covers;
+    const RunIndexEntry* entry = (const RunIndexEntry*)(map + INDEX_HEADER_BYTES);
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        history->indexed[d] = entry;
+        history->indexedCount[d] = (int)get32(map + 16 + 4 * d);
+        entry += history->indexedCount[d];
+    }
+    return true;
+}
+
+// Merges the mapped entries with the committed recent ones into a new index
+// file and swaps it in. Runs on the writer, or in runHistoryOpen before the
+// writer starts; only those ever change the mapping, so it is read unlocked.
+static bool writeIndex(RunHistory* history) {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> guard(history->lock);
+    uint32_t covers = history->durable, lastCrc = history->durableCrc;
+    RunIndexEntry* fresh[RUN_HISTORY_DIFFICULTIES];
+    int freshCount[RUN_HISTORY_DIFFICULTIES];
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        fresh[d] = (RunIndexEntry*)malloc((history->recentCount[d] + 1) * sizeof(RunIndexEntry));
+        freshCount[d] = 0;
+        for (int i = 0; i < history->recentCount[d]; i++)
+            if (history->recent[d][i].sequence < covers) fresh[d][freshCount[d]++] = history->recent[d][i];
+    }
+    guard.unlock();
+
+    char tempPath[RUN_HISTORY_PATH_MAX + 4];
+    snprintf(tempPath, sizeof(tempPath), "%s.tmp", history->indexPath);
+    FILE* file = fopen(tempPath, "wb");
+    bool ok = file != NULL;
+    if (ok) {
+        uint8_t header[INDEX_HEADER_BYTES];
+        memcpy(header, RUN_HISTORY_INDEX_MAGIC, 8);
+        put32(header + 8, covers);
+        put32(header + 12, lastCrc);
+        for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) put32(header + 16 + 4 * d, history->indexedCount[d] + freshCount[d]);
+        put32(header + 28, crc32(header, INDEX_HEADER_BYTES - 4));
+        ok = fwrite(header, 1, INDEX_HEADER_BYTES, file) == INDEX_HEADER_BYTES;
+
+        uint8_t buffer[SCAN_RECORDS * INDEX_ENTRY_BYTES];
+        for (int d = 0; ok && d < RUN_HISTORY_DIFFICULTIES; d++) {
+            const RunIndexEntry* old = history->indexed[d];
+            int i = 0, j = 0, n = 0;
+            while (ok && (i < history->indexedCount[d] || j < freshCount[d])) {
+                bool takeOld = j == freshCount[d] || (i < history->indexedCount[d] && ranksBefore(&old[i], &fresh[d][j]));
+                const RunIndexEntry* entry = takeOld ? &old[i++] : &fresh[d][j++];
+                put32(buffer + n * INDEX_ENTRY_BYTES, (uint32_t)entry->gameTime);
+                put32(buffer + n * INDEX_ENTRY_BYTES + 4, entry->sequence);
+                if (++n == SCAN_RECORDS) {
+                    ok = fwrite(buffer, INDEX_ENTRY_BYTES, n, file) == (size_t)n;
+                    n = 0;
+                }
+            }
+            if (ok && n > 0) ok = fwrite(buffer, INDEX_ENTRY_BYTES, n, file) == (size_t)n;
+        }
+        ok = ok && fflush(file) == 0 && syncFile(file);
+        if (fclose(file) != 0) ok = false;
+    }
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) free(fresh[d]);
+
+    // The old mapping goes before the rename; Windows will not replace a mapped file
+    guard.lock();
+    if (ok) {
+        uint32_t oldCovers = history->indexCovers;
+        dropIndex(history);
+        ok = replaceFile(tempPath, history->indexPath) && mapIndex(history, covers, NULL);
+        if (!ok && oldCovers > 0) mapIndex(history, oldCovers, NULL);
+    }
+    if (ok) {
+        for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+            int kept = 0;
+            for (int i = 0; i < history->recentCount[d]; i++)
+                if (history->recent[d][i].sequence >= covers) history->recent[d][kept++] = history->recent[d][i];
+            history->recentCount[d] = kept;
+        }
+        history->stats.indexWrites++;
+    }
+    else {
+        remove(tempPath);
+        history->indexFailed = true;
+    }
+    history->stats.indexSeconds += secondsSince(start);
+    return ok;
+}
+
+// Appends a batch after the last committed record and syncs it
+static bool commitBatch(RunHistory* history, const RunRecord* batch, int count, uint32_t* lastCrc) {
+    uint8_t data[RUN_HISTORY_QUEUE * RECORD_BYTES];
+    for (int i = 0; i < count; i++) encodeRecord(&batch[i], data + i * RECORD_BYTES);
+    *lastCrc = get32(data + (count - 1) * RECORD_BYTES + 28);
+    FILE* log = history->log;
+    return fseek(log, LOG_HEADER_BYTES + (long)batch[0].sequence * RECORD_BYTES, SEEK_SET) == 0 &&
+        fwrite(data, RECORD_BYTES, count, log) == (size_t)count && fflush(log) == 0 && syncFile(log);
+}
+
+static bool mergeDue(const RunHistory* history) {
+    if (history->indexFailed || history->durable <= history->indexCovers) return false;
+    int waiting = recentTotal(history);
+    return waiting >= RUN_HISTORY_MERGE_AT || (history->stopping && waiting > 0);
+}
+
+static void writerLoop(RunHistory* history) {
+    RunRecord batch[RUN_HISTORY_QUEUE];
+    std::unique_lock<std::mutex> guard(history->lock);
+    for (;;) {
+        history->wake.wait(guard, [&] { return history->stopping || history->queueCount > 0 || mergeDue(history); });
+
+        // Commit everything queued before anything else
+        if (history->queueCount > 0) {
+            int count = history->queueCount;
+            for (int i = 0; i < count; i++) batch[i] = history->queue[(history->queueHead + i) % RUN_HISTORY_QUEUE];
+            history->queueHead = (history->queueHead + count) % RUN_HISTORY_QUEUE;
+            history->queueCount = 0;
+            history->writing = true;
+            bool skip = history->logFailed;
+            history->wake.notify_all(); // Room for appenders
+            guard.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            uint32_t lastCrc = 0;
+            bool ok = !skip && commitBatch(history, batch, count, &lastCrc);
+            double seconds = secondsSince(start);
+
+            guard.lock();
+            history->writing = false;
+            if (ok) {
+                history->durable = batch[count - 1].sequence + 1;
+                history->durableCrc = lastCrc;
+                history->stats.commits++;
+                history->stats.committed += count;
+                history->stats.commitSeconds += seconds;
+            }
+            else {
+                // Later records would land at the wrong offsets; keep them in memory only
+                history->logFailed = true;
+            }
+            history->wake.notify_all(); // Flushers
+            continue;
+        }
+        if (mergeDue(history)) {
+            guard.unlock();
+            writeIndex(history);
+            guard.lock();
+            continue;
+        }
+        if (history->stopping) break;
+    }
+}
+
+bool runHistoryOpen(RunHistory* history, const char* logPath, const char* indexPath) {
+    snprintf(history->logPath, sizeof(history->logPath), "%s", logPath);
+    snprintf(history->indexPath, sizeof(history->indexPath), "%s", indexPath);
+    history->records = history->durable = history->durableCrc = 0;
+    history->logFailed = history->indexFailed = false;
+    history->indexMap = NULL;
+    dropIndex(history);
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        history->recent[d] = NULL;
+        history->recentCount[d] = history->recentCapacity[d] = 0;
+    }
+    history->queueHead = history->queueCount = 0;
+    history->writing = history->stopping = false;
+    history->stats = RunHistoryStats();
+
+    FILE* log = fopen(logPath, "r+b");
+    if (!log) log = fopen(logPath, "w+b");
+    if (!log) return false;
+    fseek(log, 0, SEEK_END);
+    long size = ftell(log);
+    uint8_t header[LOG_HEADER_BYTES];
+    if (size < LOG_HEADER_BYTES) {
+        // New, or a crash before the header was complete
+        memset(header, 0, sizeof(header));
+        memcpy(header, RUN_HISTORY_LOG_MAGIC, 8);
+        put32(header + 8, RECORD_BYTES);
+        bool ok = fseek(log, 0, SEEK_SET) == 0 && fwrite(header, 1, LOG_HEADER_BYTES, log) == LOG_HEADER_BYTES &&
+            fflush(log) == 0 && truncateFile(log, LOG_HEADER_BYTES) && syncFile(log);
+        if (!ok) { fclose(log); return false; }
+        size = LOG_HEADER_BYTES;
+    }
+    else if (fseek(log, 0, SEEK_SET) != 0 || fread(header, 1, LOG_HEADER_BYTES, log) != LOG_HEADER_BYTES ||
+        memcmp(header, RUN_HISTORY_LOG_MAGIC, 8) != 0 || get32(header + 8) != RECORD_BYTES) {
+        fclose(log);
+        return false;
+    }
+    history->log = log;
+    uint32_t total = (uint32_t)((size - LOG_HEADER_BYTES) / RECORD_BYTES);
+
+    // Trust the index for what it covers, read the rest of the log
+    mapIndex(history, total, log);
+    uint32_t valid = history->indexCovers, skipped = 0, lastCrc = 0;
+    if (valid > 0) {
+        uint8_t stored[4];
+        fseek(log, LOG_HEADER_BYTES + (long)(valid - 1) * RECORD_BYTES + 28, SEEK_SET);
+        lastCrc = fread(stored, 1, 4, log) == 4 ? get32(stored) : 0;
+    }
+    uint8_t* block = (uint8_t*)malloc(SCAN_RECORDS * RECORD_BYTES);
+    fseek(log, LOG_HEADER_BYTES + (long)valid * RECORD_BYTES, SEEK_SET);
+    for (uint32_t at = valid; at < total;) {
+        uint32_t count = std::min<uint32_t>(SCAN_RECORDS, total - at);
+        if (fread(block, RECORD_BYTES, count, log) != count) break;
+        for (uint32_t i = 0; i < count; i++, at++) {
+            RunRecord record;
+            if (!decodeRecord(block + i * RECORD_BYTES, at, &record)) continue;
+            if (record.result == GAME_WIN) pushRecent(history, record.difficulty, { record.gameTime, at });
+            history->stats.rebuiltRecords++;
+            skipped += at - valid;
+            valid = at + 1;
+            lastCrc = get32(block + i * RECORD_BYTES + 28);
+        }
+    }
+    free(block);
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++)
+        std::sort(history->recent[d], history->recent[d] + history->recentCount[d],
+            [](const RunIndexEntry& a, const RunIndexEntry& b) { return ranksBefore(&a, &b); });
+
+    // Whatever follows the last good record is a write that never finished
+    long end = LOG_HEADER_BYTES + (long)valid * RECORD_BYTES;
+    if (size > end) {
+        history->stats.truncatedBytes = (int)(size - end);
+        if (!truncateFile(log, end) || !syncFile(log)) history->logFailed = true;
+    }
+    history->records = history->durable = valid;
+    history->durableCrc = lastCrc;
+    history->stats.runs = (int)valid;
+    history->stats.skipped = (int)skipped;
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++)
+        history->stats.wins[d] = history->indexedCount[d] + history->recentCount[d];
+
+    // A long unindexed stretch is merged now so the next open is quick
+    if (recentTotal(history) >= RUN_HISTORY_MERGE_AT) writeIndex(history);
+    history->writer = std::thread(writerLoop, history);
+    return true;
+}
+
+void runHistoryClose(RunHistory* history) {
+    {
+        std::lock_guard<std::mutex> guard(history->lock);
+        history->stopping = true;
+    }
+    history->wake.notify_all();
+    if (history->writer.joinable()) history->writer.join();
+    if (history->log) fclose(history->log);
+    history->log = NULL;
+    dropIndex(history);
+    for (int d = 0; d < RUN_HISTORY_DIFFICULTIES; d++) {
+        free(history->recent[d]);
+        history->recent[d] = NULL;
+        history->recentCount[d] = history->recentCapacity[d] = 0;
+    }
+}
+
+uint32_t runHistoryAppend(RunHistory* history, const RunRecord* record) {
+    std::unique_lock<std::mutex> guard(history->lock);
+    history->wake.wait(guard, [&] { return history->queueCount < RUN_HISTORY_QUEUE; });
+    RunRecord* slot = &history->queue[(history->queueHead + history->queueCount) % RUN_HISTORY_QUEUE];
+    *slot = *record;
+    slot->sequence = history->records++;
+    history->queueCount++;
+    history->stats.runs++;
+    if (record->result == GAME_WIN) {
+        insertRecent(history, record->difficulty, { (int32_t)record->gameTime, slot->sequence });
+        history->stats.wins[record->difficulty]++;
+    }
+    history->wake.notify_all();
+    return slot->sequence;
+}
+
+void runHistoryFlush(RunHistory* history) {
+    std::unique_lock<std::mutex> guard(history->lock);
+    history->wake.wait(guard, [&] { return history->queueCount == 0 && !history->writing; });
+}
+
+int runHistoryBest(RunHistory* history, DifficultyLevel difficulty) {
+    RunIndexEntry best;
+    return runHistoryTop(history, difficulty, &best, 1) > 0 ? best.gameTime : -1;
+}
+
+int runHistoryTop(RunHistory* history, DifficultyLevel difficulty, RunIndexEntry* out, int maxOut) {
+    std::lock_guard<std::mutex> guard(history->lock);
+    const RunIndexEntry* indexed = history->indexed[difficulty];
+    const RunIndexEntry* recent = history->recent[difficulty];
+    int indexedCount = history->indexedCount[difficulty], recentCount = history->recentCount[difficulty];
+    int i = 0, j = 0, n = 0;
+    while (n < maxOut && (i < indexedCount || j < recentCount)) {
+        bool takeIndexed = j == recentCount || (i < indexedCount && ranksBefore(&indexed[i], &recent[j]));
+        out[n++] = takeIndexed ? indexed[i++] : recent[j++];
+    }
+    return n;
+}
+
+RunHistoryStats runHistoryGetStats(RunHistory* history) {
+    std::lock_guard<std::mutex> guard(history->lock);
+    return history->stats;
+}
@@ -0,0 +1,107 @@
+#ifndef RUN_HISTORY_H
+#define RUN_HISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "game_world.h"
+
+// Every finished game, kept in an append-only log next to a sorted index of
+// the wins. The log is a header and fixed-size records, each carrying its own
+// position and a CRC, so a write cut short by a crash only ever loses the
+// record being written: opening the store drops a torn tail and skips any
+// record that fails its check.
+//
+// Appends return right away; a writer thread commits them in batches (write,
+// flush, fsync) off the game thread. The index holds the wins of every
+// difficulty sorted by time and is memory-mapped, so best-time and top-N
+// queries cost the same over a million runs as over ten. Wins the index file
+// does not cover yet sit in small sorted arrays in memory; once enough pile
+// up the writer merges them into a new index file and renames it over the
+// old one, so the index on disk is always either the old or the new one.
+
+#define RUN_HISTORY_LOG_MAGIC "CLWRUN01"
+#define RUN_HISTORY_INDEX_MAGIC "CLWIDX01"
+#define RUN_HISTORY_DIFFICULTIES 3
+#define RUN_HISTORY_PATH_MAX 260
+#define RUN_HISTORY_QUEUE 256       // Appends waiting for the writer before appending blocks
+#define RUN_HISTORY_MERGE_AT 4096   // Unindexed wins that make the writer rewrite the index
+
+typedef struct {
+    uint32_t sequence;      // Position in the log, assigned by runHistoryAppend
+    uint32_t finishedAt;    // Unix seconds
+    uint64_t mapSeed;
+    int gameTime, ticks;
+    DifficultyLevel difficulty;
+    GameState result;       // GAME_WIN or GAME_LOSE
+    int coinsCollected, totalCoins;
+} RunRecord;
+
+// Index entry, sorted by game time and then by sequence, so the earlier of
+// two equal times ranks first
+typedef struct { int32_t gameTime; uint32_t sequence; } RunIndexEntry;
+
+typedef struct {
+    int runs;               // Records in the log, committed or queued
+    int wins[RUN_HISTORY_DIFFICULTIES];
+    int skipped;            // Records that failed their check on open
+    int truncatedBytes;     // Torn tail cut off on open
+    int rebuiltRecords;     // Records read on open because the index did not cover them
+    int commits;            // Writer batches
+    int committed;          // Records durably on disk
+    int indexWrites;
+    double commitSeconds;   // Writer time in write + fsync
+    double indexSeconds;    // Writer time rewriting the index
+} RunHistoryStats;
+
+typedef struct {
+    char logPath[RUN_HISTORY_PATH_MAX], indexPath[RUN_HISTORY_PATH_MAX];
+    FILE* log;              // Owned by the writer once started
+    uint32_t records;       // Next sequence
+    uint32_t durable;       // Records committed to disk
+    uint32_t durableCrc;    // Stored CRC of the last of those, which the index file names
+    bool logFailed;         // A commit failed; later records stay in memory only
+    bool indexFailed;       // An index rewrite failed; the next open rebuilds from the log
+
+    // Mapped index file: the first indexCovers records, sorted per difficulty
+    void* indexMap;
+    size_t indexMapSize;
+    const RunIndexEntry* indexed[RUN_HISTORY_DIFFICULTIES];
+    int indexedCount[RUN_HISTORY_DIFFICULTIES];
+    uint32_t indexCovers;
+    // Wins after that, sorted the same way
+    RunIndexEntry* recent[RUN_HISTORY_DIFFICULTIES];
+    int recentCount[RUN_HISTORY_DIFFICULTIES], recentCapacity[RUN_HISTORY_DIFFICULTIES];
+
+    RunRecord queue[RUN_HISTORY_QUEUE];     // FIFO ring for the writer
+    int queueHead, queueCount;
+    bool writing;           // Writer holds a batch it has taken off the queue
+    RunHistoryStats stats;
+    bool stopping;
+    std::mutex lock;
+    std::condition_variable wake;
+    std::thread writer;
+} RunHistory;
+
+// Opens or creates the log and index and starts the writer. Returns false if
+// logPath exists but is not a run log, or cannot be opened.
+bool runHistoryOpen(RunHistory* history, const char* logPath, const char* indexPath);
+// Commits everything queued, brings the index up to date and stops the writer
+void runHistoryClose(RunHistory* history);
+
+// Queues a finished game and returns its sequence; record->sequence is ignored
+uint32_t runHistoryAppend(RunHistory* history, const RunRecord* record);
+// Waits until every queued record is on disk
+void runHistoryFlush(RunHistory* history);
+
+// Fastest win for the difficulty, or -1 when there is none
+int runHistoryBest(RunHistory* history, DifficultyLevel difficulty);
+// Copies up to maxOut of the fastest wins, fastest first, and returns how many
+int runHistoryTop(RunHistory* history, DifficultyLevel difficulty, RunIndexEntry* out, int maxOut);
+
+RunHistoryStats runHistoryGetStats(RunHistory* history);
+
+#endif
@@ -0,0 +1,59 @@
+#include "space_grid.h"
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+static std::atomic<unsigned int> nextGridId(1);
+
+void spaceGridInit(SpaceGrid* grid, int width, int height) {
+    grid->width = width; grid->height = height;
+    grid->tilesX = (width + GRID_TILE_MASK) >> GRID_TILE_SHIFT;
+    grid->tilesY = (height + GRID_TILE_MASK) >> GRID_TILE_SHIFT;
+
+    // Morton order needs power-of-two squares of tiles; the shorter side sets
+    // their size and the longer side takes as many as it needs
+    int shorter = grid->tilesX < grid->tilesY ? grid->tilesX : grid->tilesY;
+    int span = 1;
+    while (span < shorter) span <<= 1;
+    grid->tileSpan = span;
+    grid->blocksX = (grid->tilesX + span - 1) / span;
+    grid->blocksY = (grid->tilesY + span - 1) / span;
+    size_t blockTiles = (size_t)span * span;
+    grid->tileCount = blockTiles * grid->blocksX * grid->blocksY;
+    grid->tiles = (uint64_t*)calloc(grid->tileCount, sizeof(uint64_t));
+    grid->id = nextGridId++;
+    grid->version = 1;
+
+    // Offsets for every tile column and row, so lookups skip the bit twiddling
+    grid->mortonX = (uint32_t*)malloc(grid->tilesX * sizeof(uint32_t));
+    grid->mortonY = (uint32_t*)malloc(grid->tilesY * sizeof(uint32_t));
+    for (int i = 0; i < grid->tilesX; i++)
+        grid->mortonX[i] = (uint32_t)((i / span) * blockTiles) + spaceGridSpreadBits((uint32_t)(i % span));
+    for (int i = 0; i < grid->tilesY; i++)
+        grid->mortonY[i] = (uint32_t)((i / span) * grid->blocksX * blockTiles) + (spaceGridSpreadBits((uint32_t)(i % span)) << 1);
+}
+
+void spaceGridFree(SpaceGrid* grid) {
+    free(grid->tiles); free(grid->mortonX); free(grid->mortonY);
+    memset(grid, 0, sizeof(*grid));
+}
+
+void spaceGridCopy(SpaceGrid* dst, const SpaceGrid* src) {
+    unsigned int version = dst->version;
+    if (dst->width != src->width || dst->height != src->height) {
+        spaceGridFree(dst);
+        spaceGridInit(dst, src->width, src->height);
+    }
+    memcpy(dst->tiles, src->tiles, src->tileCount * sizeof(uint64_t));
+    // Never reuse a version the destination has already handed out
+    dst->version = (version > src->version ? version : src->version) + 1;
+}
+
+void spaceGridClear(SpaceGrid* grid) {
+    memset(grid->tiles, 0, grid->tileCount * sizeof(uint64_t));
+    grid->version++;
+}
+
+size_t spaceGridMemoryBytes(const SpaceGrid* grid) {
+    return grid->tileCount * sizeof(uint64_t) + (grid->tilesX + grid->tilesY) * sizeof(uint32_t);
+}
@@ -0,0 +1,82 @@
+#ifndef SPACE_GRID_H
+#define SPACE_GRID_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Runtime-sized asteroid occupancy grid, one bit per cell. Cells are packed
+// into 8x8 tiles (one 64-bit word, one byte per tile row). Tiles are laid out
+// in Morton (Z-order) within square blocks as wide as the map's shorter side,
+// rounded up to a power of two, and the blocks follow each other row by row.
+// Nearby cells share cache lines in both directions, and a long thin map pays
+// for its own area rather than a square of its longest side. A 4096x4096 map
+// takes 2 MB of tiles, a 4096x16 map 8 KB.
+
+#define GRID_TILE_SHIFT 3
+#define GRID_TILE_SIZE (1 << GRID_TILE_SHIFT)
+#define GRID_TILE_MASK (GRID_TILE_SIZE - 1)
+
+typedef struct {
+    int width, height;
+    int tilesX, tilesY;     // Tiles covering the map
+    int tileSpan;           // Power-of-two side of a Morton block, in tiles
+    int blocksX, blocksY;   // Morton blocks covering the map
+    uint64_t* tiles;
+    size_t tileCount;
+    uint32_t* mortonX;      // Per tile column: block offset plus spread Morton bits
+    uint32_t* mortonY;      // Per tile row: block row offset plus spread Morton bits, pre-shifted
+    unsigned int id;        // Unique per spaceGridInit, so caches never confuse two grids
+    unsigned int version;   // Bumped on every change, for caches keyed on the map
+} SpaceGrid;
+
+void spaceGridInit(SpaceGrid* grid, int width, int height);
+void spaceGridFree(SpaceGrid* grid);
+void spaceGridCopy(SpaceGrid* dst, const SpaceGrid* src);
+void spaceGridClear(SpaceGrid* grid);
+size_t spaceGridMemoryBytes(const SpaceGrid* grid);  // Every allocation the grid holds
+
+// Spreads the low 16 bits of v to the even bit positions
+static inline uint32_t spaceGridSpreadBits(uint32_t v) {
+    v &= 0xFFFF;
+    v = (v | (v << 8)) & 0x00FF00FF;
+    v = (v | (v << 4)) & 0x0F0F0F0F;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+}
+
+static inline size_t spaceGridTileIndex(const SpaceGrid* grid, int tileX, int tileY) {
+    return grid->mortonX[tileX] + grid->mortonY[tileY];
+}
+
+static inline int spaceGridBitIndex(int x, int y) {
+    return ((y & GRID_TILE_MASK) << GRID_TILE_SHIFT) | (x & GRID_TILE_MASK);
+}
+
+static inline bool spaceGridInBounds(const SpaceGrid* grid, int x, int y) {
+    return x >= 0 && x < grid->width && y >= 0 && y < grid->height;
+}
+
+// Asteroid test; cells outside the map count as blocked
+static inline bool spaceGridBlocked(const SpaceGrid* grid, int x, int y) {
+    if (!spaceGridInBounds(grid, x, y)) return true;
+    uint64_t tile = grid->tiles[spaceGridTileIndex(grid, x >> GRID_TILE_SHIFT, y >> GRID_TILE_SHIFT)];
+    return (tile >> spaceGridBitIndex(x, y)) & 1;
+}
+
+static inline void spaceGridSet(SpaceGrid* grid, int x, int y, bool blocked) {
+    if (!spaceGridInBounds(grid, x, y)) return;
+    uint64_t* tile = &grid->tiles[spaceGridTileIndex(grid, x >> GRID_TILE_SHIFT, y >> GRID_TILE_SHIFT)];
+    uint64_t bit = (uint64_t)1 << spaceGridBitIndex(x, y);
+    uint64_t updated = blocked ? (*tile | bit) : (*tile & ~bit);
+    if (updated != *tile) { *tile = updated; grid->version++; }
+}
+
+// Eight cells of row y starting at the tile-aligned column x, bit i = column x + i
+static inline uint8_t spaceGridRowByte(const SpaceGrid* grid, int x, int y) {
+    uint64_t tile = grid->tiles[spaceGridTileIndex(grid, x >> GRID_TILE_SHIFT, y >> GRID_TILE_SHIFT)];
+    return (uint8_t)(tile >> ((y & GRID_TILE_MASK) << GRID_TILE_SHIFT));
+}
+
+#endif
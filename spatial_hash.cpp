@@ -0,0 +1,159 @@
+#include "spatial_hash.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline int hashCell(const SpatialHash* hash, int cellX, int cellY) {
+    unsigned int h = (unsigned int)cellX * 73856093u ^ (unsigned int)cellY * 19349663u;
+    return (int)(h & (unsigned int)hash->bucketMask);
+}
+
+// Floor without the libm call; truncation rounds negatives the wrong way
+static inline int cellCoord(const SpatialHash* hash, float v) {
+    float scaled = v * hash->invCellSize;
+    int cell = (int)scaled;
+    return cell - (scaled < (float)cell);
+}
+
+static void linkEntity(SpatialHash* hash, int handle) {
+    SpatialEntity* e = &hash->entities[handle];
+    e->cellX = cellCoord(hash, e->x);
+    e->cellY = cellCoord(hash, e->y);
+    e->bucket = hashCell(hash, e->cellX, e->cellY);
+    e->prev = -1;
+    e->next = hash->buckets[e->bucket];
+    if (e->next >= 0) hash->entities[e->next].prev = handle;
+    hash->buckets[e->bucket] = handle;
+}
+
+static void unlinkEntity(SpatialHash* hash, int handle) {
+    SpatialEntity* e = &hash->entities[handle];
+    if (e->prev >= 0) hash->entities[e->prev].next = e->next;
+    else hash->buckets[e->bucket] = e->next;
+    if (e->next >= 0) hash->entities[e->next].prev = e->prev;
+}
+
+// Grows the entity slots to capacity, keeping about two buckets per slot
+static void reserve(SpatialHash* hash, int capacity) {
+    int old = hash->capacity;
+    hash->entities = (SpatialEntity*)realloc(hash->entities, capacity * sizeof(SpatialEntity));
+    // New slots join the free list lowest first
+    for (int i = capacity - 1; i >= old; i--) {
+        hash->entities[i].bucket = -1;
+        hash->entities[i].next = hash->freeList;
+        hash->freeList = i;
+    }
+    hash->capacity = capacity;
+
+    int buckets = 16;
+    while (buckets < capacity * 2) buckets <<= 1;
+    if (buckets <= hash->bucketMask + 1) return;
+    free(hash->buckets);
+    hash->buckets = (int*)malloc(buckets * sizeof(int));
+    hash->bucketMask = buckets - 1;
+    for (int b = 0; b < buckets; b++) hash->buckets[b] = -1;
+    for (int i = 0; i < old; i++)
+        if (hash->entities[i].bucket >= 0) linkEntity(hash, i);
+}
+
+void spatialHashInit(SpatialHash* hash, int capacity, float cellSize) {
+    memset(hash, 0, sizeof(*hash));
+    hash->cellSize = cellSize;
+    hash->invCellSize = 1.0f / cellSize;
+    hash->bucketMask = -1;
+    hash->freeList = -1;
+    reserve(hash, capacity > 16 ? capacity : 16);
+}
+
+void spatialHashFree(SpatialHash* hash) {
+    free(hash->entities);
+    free(hash->buckets);
+    memset(hash, 0, sizeof(*hash));
+}
+
+void spatialHashClear(SpatialHash* hash) {
+    for (int b = 0; b <= hash->bucketMask; b++) hash->buckets[b] = -1;
+    hash->freeList = -1;
+    for (int i = hash->capacity - 1; i >= 0; i--) {
+        hash->entities[i].bucket = -1;
+        hash->entities[i].next = hash->freeList;
+        hash->freeList = i;
+    }
+    hash->count = 0;
+    hash->maxRadius = 0.0f;
+}
+
+int spatialHashInsert(SpatialHash* hash, int kind, int index, float x, float y, float radius) {
+    if (hash->freeList < 0) reserve(hash, hash->capacity * 2);
+    int handle = hash->freeList;
+    SpatialEntity* e = &hash->entities[handle];
+    hash->freeList = e->next;
+    e->x = x; e->y = y; e->radius = radius;
+    e->kind = kind; e->index = index;
+    linkEntity(hash, handle);
+    hash->count++;
+    if (radius > hash->maxRadius) hash->maxRadius = radius;
+    return handle;
+}
+
+void spatialHashRemove(SpatialHash* hash, int handle) {
+    SpatialEntity* e = &hash->entities[handle];
+    if (e->bucket < 0) return;
+    unlinkEntity(hash, handle);
+    e->bucket = -1;
+    e->next = hash->freeList;
+    hash->freeList = handle;
+    hash->count--;
+}
+
+void spatialHashMove(SpatialHash* hash, int handle, float x, float y) {
+    SpatialEntity* e = &hash->entities[handle];
+    if (e->bucket < 0) return;
+    e->x = x; e->y = y;
+    // Most moves stay inside the cell and need no refiling
+    if (cellCoord(hash, x) == e->cellX && cellCoord(hash, y) == e->cellY) return;
+    unlinkEntity(hash, handle);
+    linkEntity(hash, handle);
+}
+
+// Up to this many slots a straight scan beats hashing the cells a query covers
+#define SCAN_SLOTS 32
+
+int spatialHashQuery(const SpatialHash* hash, float x, float y, float radius, int* out, int maxOut) {
+    if (hash->count == 0) return 0;
+    if (hash->capacity <= SCAN_SLOTS) {
+        int found = 0;
+        for (int h = 0; h < hash->capacity; h++) {
+            const SpatialEntity* e = &hash->entities[h];
+            if (e->bucket < 0) continue;
+            float dx = e->x - x, dy = e->y - y, r = radius + e->radius;
+            if (dx * dx + dy * dy >= r * r) continue;
+            if (found < maxOut) out[found] = h;
+            found++;
+        }
+        return found;
+    }
+    float reach = radius + hash->maxRadius;
+    int x0 = cellCoord(hash, x - reach), x1 = cellCoord(hash, x + reach);
+    int y0 = cellCoord(hash, y - reach), y1 = cellCoord(hash, y + reach);
+    // Locals so writes to out don't force reloads of the table
+    const int* buckets = hash->buckets;
+    const SpatialEntity* entities = hash->entities;
+    unsigned int mask = (unsigned int)hash->bucketMask;
+    int found = 0;
+    for (int cy = y0; cy <= y1; cy++) {
+        unsigned int rowHash = (unsigned int)cy * 19349663u;
+        for (int cx = x0; cx <= x1; cx++) {
+            for (int h = buckets[((unsigned int)cx * 73856093u ^ rowHash) & mask]; h >= 0; h = entities[h].next) {
+                const SpatialEntity* e = &entities[h];
+                // Other cells can share the bucket; each entity is reported from its own cell only
+                if (e->cellX != cx || e->cellY != cy) continue;
+                float dx = e->x - x, dy = e->y - y, r = radius + e->radius;
+                if (dx * dx + dy * dy >= r * r) continue;
+                if (found < maxOut) out[found] = h;
+                found++;
+            }
+        }
+    }
+    return found;
+}
@@ -0,0 +1,47 @@
+#ifndef SPATIAL_HASH_H
+#define SPATIAL_HASH_H
+
+#include <stdbool.h>
+
+// Broadphase for collidable entities (coins, the exit, orbs, ships, ...).
+// Entities are filed by the grid cell under their centre in a hash of
+// buckets, so a query only visits the cells its circle can reach instead of
+// every entity on the map. Narrowphase tests use squared distances.
+
+typedef struct {
+    float x, y, radius;
+    int kind, index;        // Caller's tags: what the entity is and where it lives
+    int cellX, cellY;       // Hashed cell under the centre
+    int bucket;             // Bucket it is filed under, -1 when the slot is free
+    int next, prev;         // Bucket list, or next free slot
+} SpatialEntity;
+
+typedef struct {
+    float cellSize;         // World units per hashed cell
+    float invCellSize;
+    int* buckets;           // First entity per bucket, -1 if empty
+    int bucketMask;         // Bucket count - 1; the count is a power of two
+    SpatialEntity* entities;
+    int capacity, count;
+    int freeList;
+    float maxRadius;        // Largest radius filed, widens every query
+} SpatialHash;
+
+void spatialHashInit(SpatialHash* hash, int capacity, float cellSize);
+void spatialHashFree(SpatialHash* hash);
+void spatialHashClear(SpatialHash* hash);
+
+// Files an entity and returns its handle; grows the hash as needed
+int spatialHashInsert(SpatialHash* hash, int kind, int index, float x, float y, float radius);
+void spatialHashRemove(SpatialHash* hash, int handle);
+void spatialHashMove(SpatialHash* hash, int handle, float x, float y);
+
+// Handles of entities whose circles overlap the query circle. Returns the
+// number found; up to maxOut are written to out.
+int spatialHashQuery(const SpatialHash* hash, float x, float y, float radius, int* out, int maxOut);
+
+static inline const SpatialEntity* spatialHashEntity(const SpatialHash* hash, int handle) {
+    return &hash->entities[handle];
+}
+
+#endif
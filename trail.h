@@ -0,0 +1,57 @@
+#ifndef TRAIL_H
+#define TRAIL_H
+
+// Light trail behind the player, kept in a fixed-capacity ring. Every point
+// fades at the same rate, so intensity is derived from the tick it was laid
+// down and points always die oldest first: expiring is a head advance and a
+// full ring overwrites its oldest point, both without moving any memory.
+
+#define TRAIL_CAPACITY 1000
+#define TRAIL_INTENSITY 5.0f        // Intensity of a fresh point
+#define TRAIL_FADE_PER_TICK 0.2f
+#define TRAIL_LIFETIME_TICKS 25     // TRAIL_INTENSITY / TRAIL_FADE_PER_TICK
+
+typedef struct { float x, y; int birthTick; } TrailPoint;
+
+typedef struct {
+    TrailPoint points[TRAIL_CAPACITY];
+    int head;               // Slot of the oldest point
+    int length;
+} Trail;
+
+static inline void trailClear(Trail* trail) {
+    trail->head = 0;
+    trail->length = 0;
+}
+
+// i = 0 is the oldest point, length - 1 the newest
+static inline const TrailPoint* trailAt(const Trail* trail, int i) {
+    int slot = trail->head + i;
+    if (slot >= TRAIL_CAPACITY) slot -= TRAIL_CAPACITY;
+    return &trail->points[slot];
+}
+
+static inline float trailIntensity(const TrailPoint* point, int tick) {
+    return TRAIL_INTENSITY - TRAIL_FADE_PER_TICK * (tick - point->birthTick);
+}
+
+static inline void trailPush(Trail* trail, float x, float y, int tick) {
+    if (trail->length == TRAIL_CAPACITY) {
+        if (++trail->head == TRAIL_CAPACITY) trail->head = 0;
+        trail->length--;
+    }
+    int slot = trail->head + trail->length;
+    if (slot >= TRAIL_CAPACITY) slot -= TRAIL_CAPACITY;
+    trail->points[slot].x = x; trail->points[slot].y = y; trail->points[slot].birthTick = tick;
+    trail->length++;
+}
+
+// Drops points that have faded out by tick
+static inline void trailExpire(Trail* trail, int tick) {
+    while (trail->length > 0 && tick - trail->points[trail->head].birthTick >= TRAIL_LIFETIME_TICKS) {
+        if (++trail->head == TRAIL_CAPACITY) trail->head = 0;
+        trail->length--;
+    }
+}
+
+#endif